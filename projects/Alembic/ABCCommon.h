@@ -38,7 +38,7 @@ extern void traverseABC(
     bool outOfRangeAsEmpty
 );
 
-extern Alembic::AbcGeom::IArchive readABC(std::string const &path);
+extern Alembic::AbcGeom::IArchive readABC(std::string const &path, int numStreams = 1);
 
 extern std::shared_ptr<zeno::ListObject> get_xformed_prims(std::shared_ptr<zeno::ABCTree> abctree);
 
@@ -53,7 +53,7 @@ void writeObjFile(
 
 bool SaveEXR(const float* rgb, int width, int height, const char* outfilename);
 
-std::shared_ptr<ListObject> abc_split_by_name(std::shared_ptr<PrimitiveObject> prim, bool add_when_none = false);
+std::shared_ptr<ListObject> abc_split_by_name(std::shared_ptr<PrimitiveObject> prim, bool add_when_none = false, bool kill_dead_verts = false);
 }
 
 #endif //ZENO_ABCCOMMON_H
@@ -235,7 +235,7 @@ struct AlembicPrimList : INode {
         auto new_prims = std::make_shared<zeno::ListObject>();
         if (get_input2<bool>("splitByFaceset")) {
             for (auto &prim: prims->arr) {
-                auto list = abc_split_by_name(std::dynamic_pointer_cast<PrimitiveObject>(prim), false);
+                auto list = abc_split_by_name(std::dynamic_pointer_cast<PrimitiveObject>(prim), false, get_input2<bool>("killDeadVerts"));
                 new_prims->arr.insert(new_prims->arr.end(), list->arr.begin(), list->arr.end());
             }
         }
@@ -299,9 +299,6 @@ struct AlembicPrimList : INode {
             if (get_input2<bool>("flipFrontBack")) {
                 primFlipFaces(_prim.get());
             }
-            if (get_input2<bool>("splitByFaceset") && get_input2<bool>("killDeadVerts")) {
-                primKillDeadVerts(_prim.get());
-            }
             if (get_input2<bool>("triangulate")) {
                 zeno::primTriangulate(_prim.get());
             }
@@ -22,6 +22,13 @@
 #include <zeno/utils/string.h>
 #include <zeno/utils/scope_exit.h>
 #include <numeric>
+#include <algorithm>
+#include <functional>
+#include <exception>
+#include <future>
+#include <thread>
+#include <mutex>
+#include <map>
 
 #ifdef ZENO_WITH_PYTHON3
     #include <Python.h>
@@ -997,7 +1004,19 @@ static std::shared_ptr<PrimitiveObject> foundABCCurves(Alembic::AbcGeom::ICurves
     return prim;
 }
 
-void traverseABC(
+static void finishABCPrim(ABCTree &tree) {
+    tree.prim->userData().set2("vis", tree.visible);
+    if (tree.visible == 0) {
+        for (auto i = 0; i < tree.prim->verts.size(); i++) {
+            tree.prim->verts[i] = {};
+        }
+    }
+}
+
+// geometry samples are the expensive part of a frame, so they are collected
+// into `pending` while the tree itself is walked, and decoded in parallel
+// afterwards; xforms and cameras are cheap and stay inline.
+static void traverseABCTree(
     Alembic::AbcGeom::IObject &obj,
     ABCTree &tree,
     int frameid,
@@ -1006,7 +1025,8 @@ void traverseABC(
     std::string path,
     const TimeAndSamplesMap & iTimeMap,
     ObjectVisibility parent_visible,
-    bool outOfRangeAsEmpty
+    bool outOfRangeAsEmpty,
+    std::vector<std::function<void()>> &pending
 ) {
     {
         auto const &md = obj.getMetaData();
@@ -1043,11 +1063,14 @@ void traverseABC(
                 log_debug("[alembic] found a mesh [{}]", obj.getName());
             }
 
-            Alembic::AbcGeom::IPolyMesh meshy(obj);
-            auto &mesh = meshy.getSchema();
-            tree.prim = foundABCMesh(mesh, frameid, read_done, read_face_set, outOfRangeAsEmpty, obj.getName());
-            tree.prim->userData().set2("_abc_name", obj.getName());
-            prim_set_abcpath(tree.prim.get(), path);
+            pending.push_back([&tree, obj, frameid, read_done, read_face_set, outOfRangeAsEmpty, path] {
+                Alembic::AbcGeom::IPolyMesh meshy(obj);
+                auto &mesh = meshy.getSchema();
+                tree.prim = foundABCMesh(mesh, frameid, read_done, read_face_set, outOfRangeAsEmpty, obj.getName());
+                tree.prim->userData().set2("_abc_name", obj.getName());
+                prim_set_abcpath(tree.prim.get(), path);
+                finishABCPrim(tree);
+            });
         } else if (Alembic::AbcGeom::IXformSchema::matches(md)) {
             if (!read_done) {
                 log_debug("[alembic] found a Xform [{}]", obj.getName());
@@ -1066,39 +1089,40 @@ void traverseABC(
             if (!read_done) {
                 log_debug("[alembic] found points [{}]", obj.getName());
             }
-            Alembic::AbcGeom::IPoints points(obj);
-            auto &points_sch = points.getSchema();
-            tree.prim = foundABCPoints(points_sch, frameid, read_done, outOfRangeAsEmpty);
-            tree.prim->userData().set2("_abc_name", obj.getName());
-            prim_set_abcpath(tree.prim.get(), path);
-            tree.prim->userData().set2("faceset_count", 0);
+            pending.push_back([&tree, obj, frameid, read_done, outOfRangeAsEmpty, path] {
+                Alembic::AbcGeom::IPoints points(obj);
+                auto &points_sch = points.getSchema();
+                tree.prim = foundABCPoints(points_sch, frameid, read_done, outOfRangeAsEmpty);
+                tree.prim->userData().set2("_abc_name", obj.getName());
+                prim_set_abcpath(tree.prim.get(), path);
+                tree.prim->userData().set2("faceset_count", 0);
+                finishABCPrim(tree);
+            });
         } else if(Alembic::AbcGeom::ICurvesSchema::matches(md)) {
             if (!read_done) {
                 log_debug("[alembic] found curves [{}]", obj.getName());
             }
-            Alembic::AbcGeom::ICurves curves(obj);
-            auto &curves_sch = curves.getSchema();
-            tree.prim = foundABCCurves(curves_sch, frameid, read_done, outOfRangeAsEmpty);
-            tree.prim->userData().set2("_abc_name", obj.getName());
-            prim_set_abcpath(tree.prim.get(), path);
-            tree.prim->userData().set2("faceset_count", 0);
+            pending.push_back([&tree, obj, frameid, read_done, outOfRangeAsEmpty, path] {
+                Alembic::AbcGeom::ICurves curves(obj);
+                auto &curves_sch = curves.getSchema();
+                tree.prim = foundABCCurves(curves_sch, frameid, read_done, outOfRangeAsEmpty);
+                tree.prim->userData().set2("_abc_name", obj.getName());
+                prim_set_abcpath(tree.prim.get(), path);
+                tree.prim->userData().set2("faceset_count", 0);
+                finishABCPrim(tree);
+            });
         } else if (Alembic::AbcGeom::ISubDSchema::matches(md)) {
             if (!read_done) {
                 log_debug("[alembic] found SubD [{}]", obj.getName());
             }
-            Alembic::AbcGeom::ISubD subd(obj);
-            auto &subd_sch = subd.getSchema();
-            tree.prim = foundABCSubd(subd_sch, frameid, read_done, read_face_set, outOfRangeAsEmpty);
-            tree.prim->userData().set2("_abc_name", obj.getName());
-            prim_set_abcpath(tree.prim.get(), path);
-        }
-        if (tree.prim) {
-            tree.prim->userData().set2("vis", tree.visible);
-            if (tree.visible == 0) {
-                for (auto i = 0; i < tree.prim->verts.size(); i++) {
-                    tree.prim->verts[i] = {};
-                }
-            }
+            pending.push_back([&tree, obj, frameid, read_done, read_face_set, outOfRangeAsEmpty, path] {
+                Alembic::AbcGeom::ISubD subd(obj);
+                auto &subd_sch = subd.getSchema();
+                tree.prim = foundABCSubd(subd_sch, frameid, read_done, read_face_set, outOfRangeAsEmpty);
+                tree.prim->userData().set2("_abc_name", obj.getName());
+                prim_set_abcpath(tree.prim.get(), path);
+                finishABCPrim(tree);
+            });
         }
     }
 
@@ -1116,12 +1140,43 @@ void traverseABC(
         Alembic::AbcGeom::IObject child(obj, name);
 
         auto childTree = std::make_shared<ABCTree>();
-        traverseABC(child, *childTree, frameid, read_done, read_face_set, path, iTimeMap, tree.visible, outOfRangeAsEmpty);
+        traverseABCTree(child, *childTree, frameid, read_done, read_face_set, path, iTimeMap, tree.visible, outOfRangeAsEmpty, pending);
         tree.children.push_back(std::move(childTree));
     }
 }
 
-Alembic::AbcGeom::IArchive readABC(std::string const &path) {
+void traverseABC(
+    Alembic::AbcGeom::IObject &obj,
+    ABCTree &tree,
+    int frameid,
+    bool read_done,
+    bool read_face_set,
+    std::string path,
+    const TimeAndSamplesMap & iTimeMap,
+    ObjectVisibility parent_visible,
+    bool outOfRangeAsEmpty
+) {
+    std::vector<std::function<void()>> pending;
+    traverseABCTree(obj, tree, frameid, read_done, read_face_set, std::move(path), iTimeMap, parent_visible, outOfRangeAsEmpty, pending);
+
+    // each task only touches its own ABCTree node, Ogawa archives opened
+    // with several streams serve concurrent reads of different objects
+    std::vector<std::exception_ptr> errors(pending.size());
+#pragma omp parallel for schedule(dynamic)
+    for (intptr_t i = 0; i < (intptr_t)pending.size(); i++) {
+        try {
+            pending[i]();
+        } catch (...) {
+            errors[i] = std::current_exception();
+        }
+    }
+    for (auto const &e: errors) {
+        if (e)
+            std::rethrow_exception(e);
+    }
+}
+
+Alembic::AbcGeom::IArchive readABC(std::string const &path, int numStreams) {
     std::string native_path = std::filesystem::u8path(path).string();
     std::string hdr;
     {
@@ -1138,17 +1193,43 @@ Alembic::AbcGeom::IArchive readABC(std::string const &path) {
         log_info("[alembic] opening as HDF5 format");
         return {Alembic::AbcCoreHDF5::ReadArchive(), native_path};
     } else if (hdr == "Ogaw") {
-        log_info("[alembic] opening as Ogawa format");
-        return {Alembic::AbcCoreOgawa::ReadArchive(), native_path};
+        if (numStreams <= 0) {
+            numStreams = std::max(1, (int)std::thread::hardware_concurrency());
+        }
+        log_info("[alembic] opening as Ogawa format with {} streams", numStreams);
+        return {Alembic::AbcCoreOgawa::ReadArchive(numStreams), native_path};
     } else {
         throw Exception("[alembic] unrecognized ABC header: [" + hdr + "]");
     }
 }
 
 struct ReadAlembic : INode {
+    // the open file for this node's inputs, reopened whenever they change; not a
+    // shared cache since only Ogawa archives are made for concurrent readers
     Alembic::Abc::v12::IArchive archive;
     std::string usedPath;
+    int usedNumStreams = -1;
+    bool usedReadFaceSet = false;
+    bool usedOutOfRangeAsEmpty = false;
     bool read_done = false;
+    TimeAndSamplesMap timeMap;
+    // background reads go through a handle of their own, one frame at a
+    // time, so they never share an archive with the main thread
+    Alembic::Abc::v12::IArchive prefetchArchive;
+    std::mutex prefetchMtx;
+    // frames read ahead in background, each one is handed out only once
+    // since downstream nodes are free to modify the prims they receive, so
+    // unlike a ConcurrentCache entry no value is ever shared between callers;
+    // declared last so in-flight reads are joined before archives are closed
+    std::map<int, std::future<std::shared_ptr<ABCTree>>> prefetched;
+
+    std::shared_ptr<ABCTree> readFrame(Alembic::Abc::v12::IArchive &arc, int frameid, bool quiet) {
+        auto abctree = std::make_shared<ABCTree>();
+        auto obj = arc.getTop();
+        traverseABC(obj, *abctree, frameid, quiet, usedReadFaceSet, "", timeMap, ObjectVisibility::kVisibilityDeferred, usedOutOfRangeAsEmpty);
+        return abctree;
+    }
+
     virtual void apply() override {
         int frameid;
         if (has_input("frameid")) {
@@ -1156,32 +1237,67 @@ struct ReadAlembic : INode {
         } else {
             frameid = getGlobalState()->frameid;
         }
-        auto abctree = std::make_shared<ABCTree>();
+        std::shared_ptr<ABCTree> abctree;
         {
             auto path = get_input<StringObject>("path")->get();
-            if (usedPath != path) {
+            bool read_face_set = get_input2<bool>("read_face_set");
+            bool outOfRangeAsEmpty = get_input2<bool>("outOfRangeAsEmpty");
+            int numStreams = get_input2<int>("numStreams");
+            if (usedPath != path || usedNumStreams != numStreams
+                || usedReadFaceSet != read_face_set || usedOutOfRangeAsEmpty != outOfRangeAsEmpty) {
                 read_done = false;
             }
             if (read_done == false) {
-                archive = readABC(path);
-            }
-            double start, _end;
-            GetArchiveStartAndEndTime(archive, start, _end);
-            // fmt::print("GetArchiveStartAndEndTime: {}\n", start);
-            // fmt::print("archive.getNumTimeSamplings: {}\n", archive.getNumTimeSamplings());
-            auto obj = archive.getTop();
-            bool read_face_set = get_input2<bool>("read_face_set");
-            bool outOfRangeAsEmpty = get_input2<bool>("outOfRangeAsEmpty");
-            Alembic::Util::uint32_t numSamplings = archive.getNumTimeSamplings();
-            TimeAndSamplesMap timeMap;
-            for (Alembic::Util::uint32_t s = 0; s < numSamplings; ++s)             {
-                timeMap.add(archive.getTimeSampling(s),
-                            archive.getMaxNumSamplesForTimeSamplingIndex(s));
+                prefetched.clear();
+                prefetchArchive.reset();
+                archive = readABC(path, numStreams);
+                usedPath = path;
+                usedNumStreams = numStreams;
+                usedReadFaceSet = read_face_set;
+                usedOutOfRangeAsEmpty = outOfRangeAsEmpty;
+                double start, _end;
+                GetArchiveStartAndEndTime(archive, start, _end);
+                // fmt::print("GetArchiveStartAndEndTime: {}\n", start);
+                // fmt::print("archive.getNumTimeSamplings: {}\n", archive.getNumTimeSamplings());
+                Alembic::Util::uint32_t numSamplings = archive.getNumTimeSamplings();
+                timeMap = TimeAndSamplesMap();
+                for (Alembic::Util::uint32_t s = 0; s < numSamplings; ++s)             {
+                    timeMap.add(archive.getTimeSampling(s),
+                                archive.getMaxNumSamplesForTimeSamplingIndex(s));
+                }
             }
 
-            traverseABC(obj, *abctree, frameid, read_done, read_face_set, "", timeMap, ObjectVisibility::kVisibilityDeferred, outOfRangeAsEmpty);
+            if (auto it = prefetched.find(frameid); it != prefetched.end()) {
+                abctree = it->second.get();
+                prefetched.erase(it);
+            } else {
+                abctree = readFrame(archive, frameid, read_done);
+            }
             read_done = true;
-            usedPath = path;
+
+            int cacheSize = get_input2<int>("cacheSize");
+            if (get_input2<bool>("prefetchNextFrame") && cacheSize > 0) {
+                // keep the cacheSize frames after this one, drop those we jumped away from
+                for (auto it = prefetched.begin(); it != prefetched.end();) {
+                    if (it->first <= frameid || it->first > frameid + cacheSize)
+                        it = prefetched.erase(it);
+                    else
+                        ++it;
+                }
+                if (!prefetchArchive.valid())
+                    prefetchArchive = readABC(usedPath, usedNumStreams);
+                for (int next = frameid + 1; next <= frameid + cacheSize; next++) {
+                    if (prefetched.count(next))
+                        continue;
+                    prefetched.emplace(next, std::async(std::launch::async, [this, next] {
+                        std::lock_guard lck(prefetchMtx);
+                        return readFrame(prefetchArchive, next, true);
+                    }));
+                }
+            } else {
+                prefetched.clear();
+                prefetchArchive.reset();
+            }
         }
         {
             auto namelist = std::make_shared<zeno::ListObject>();
@@ -1208,6 +1324,9 @@ ZENDEFNODE(ReadAlembic, {
         {"bool", "read_face_set", "1"},
         {"bool", "outOfRangeAsEmpty", "0"},
         {"frameid"},
+        {"int", "numStreams", "0"},
+        {"bool", "prefetchNextFrame", "0"},
+        {"int", "cacheSize", "2"},
     },
     {
         {"ABCTree", "abctree"},
@@ -1217,70 +1336,156 @@ ZENDEFNODE(ReadAlembic, {
     {"alembic"},
 });
 
-std::shared_ptr<ListObject> abc_split_by_name(std::shared_ptr<PrimitiveObject> prim, bool add_when_none) {
+template <class T>
+static void gather_attr_vector(AttrVector<T> &dst, AttrVector<T> const &src, std::vector<int> const &revamp) {
+    dst.values.resize(revamp.size());
+    for (size_t i = 0; i < revamp.size(); i++) {
+        dst.values[i] = src.values[revamp[i]];
+    }
+    src.template foreach_attr<AttrAcceptAll>([&] (auto const &key, auto const &arr) {
+        using A = std::decay_t<decltype(arr[0])>;
+        auto &out = dst.template add_attr<A>(key);
+        for (size_t i = 0; i < revamp.size(); i++) {
+            out[i] = arr[revamp[i]];
+        }
+    });
+}
+
+// builds one output per faceset straight from the faces it owns, instead of
+// cloning the whole prim and shrinking it: faces are bucketed by faceset in
+// one pass, and each bucket only gathers the loops, uvs and (if kill_dead_verts)
+// the verts that it references, so memory stays near one copy of the input.
+std::shared_ptr<ListObject> abc_split_by_name(std::shared_ptr<PrimitiveObject> prim, bool add_when_none, bool kill_dead_verts) {
     int faceset_count = prim->userData().get2<int>("faceset_count");
     if (add_when_none && faceset_count == 0) {
         auto name = prim->userData().get2<std::string>("_abc_name");
         prim_set_faceset(prim.get(), name);
         faceset_count = 1;
     }
-    std::map<int, std::vector<int>> faceset_map;
-    for (auto f = 0; f < faceset_count; f++) {
-        faceset_map[f] = {};
-    }
     auto list = std::make_shared<ListObject>();
-    if (prim->polys.size()) {
-        auto &faceset = prim->polys.add_attr<int>("faceset");
-        for (auto j = 0; j < faceset.size(); j++) {
-            auto f = faceset[j];
-            faceset_map[f].push_back(j);
-        }
-        for (auto f = 0; f < faceset_count; f++) {
-            auto name = prim->userData().get2<std::string>(zeno::format("faceset_{}", f));
-            auto new_prim = std::dynamic_pointer_cast<PrimitiveObject>(prim->clone());
-            new_prim->polys.resize(faceset_map[f].size());
-            for (auto i = 0; i < faceset_map[f].size(); i++) {
-                new_prim->polys[i] = prim->polys[faceset_map[f][i]];
-            }
-            new_prim->polys.foreach_attr<AttrAcceptAll>([&](auto const &key, auto &arr) {
-                using T = std::decay_t<decltype(arr[0])>;
-                auto &attr = prim->polys.attr<T>(key);
-                for (auto i = 0; i < arr.size(); i++) {
-                    arr[i] = attr[faceset_map[f][i]];
-                }
-            });
-            for (auto j = 0; j < faceset_count; j++) {
-                new_prim->userData().del(zeno::format("faceset_{}", j));
-            }
-            prim_set_faceset(new_prim.get(), name);
-            list->arr.push_back(new_prim);
-        }
+    bool use_polys = prim->polys.size() > 0;
+    if (!use_polys && prim->tris.size() == 0) {
+        return list;
+    }
+    size_t num_faces = use_polys ? prim->polys.size() : prim->tris.size();
+    auto const &faceset = use_polys ? prim->polys.add_attr<int>("faceset") : prim->tris.add_attr<int>("faceset");
+
+    // counting sort of face indices by faceset id
+    std::vector<int> faceset_offset(faceset_count + 1, 0);
+    for (size_t j = 0; j < num_faces; j++) {
+        if (faceset[j] >= 0 && faceset[j] < faceset_count)
+            faceset_offset[faceset[j] + 1]++;
     }
-    else if (prim->tris.size()) {
-        auto &faceset = prim->tris.add_attr<int>("faceset");
-        for (auto j = 0; j < faceset.size(); j++) {
-            auto f = faceset[j];
-            faceset_map[f].push_back(j);
+    for (int f = 0; f < faceset_count; f++) {
+        faceset_offset[f + 1] += faceset_offset[f];
+    }
+    std::vector<int> faceset_faces(faceset_offset.back());
+    {
+        std::vector<int> cursor(faceset_offset.begin(), faceset_offset.end() - 1);
+        for (size_t j = 0; j < num_faces; j++) {
+            if (faceset[j] >= 0 && faceset[j] < faceset_count)
+                faceset_faces[cursor[faceset[j]]++] = j;
         }
-        for (auto f = 0; f < faceset_count; f++) {
-            auto name = prim->userData().get2<std::string>(zeno::format("faceset_{}", f));
-            auto new_prim = std::dynamic_pointer_cast<PrimitiveObject>(prim->clone());
-            new_prim->tris.resize(faceset_map[f].size());
-            for (auto i = 0; i < faceset_map[f].size(); i++) {
-                new_prim->tris[i] = prim->tris[faceset_map[f][i]];
-            }
-            new_prim->tris.foreach_attr<AttrAcceptAll>([&](auto const &key, auto &arr) {
-                using T = std::decay_t<decltype(arr[0])>;
-                auto &attr = prim->tris.attr<T>(key);
-                for (auto i = 0; i < arr.size(); i++) {
-                    arr[i] = attr[faceset_map[f][i]];
+    }
+
+    std::vector<std::string> names(faceset_count);
+    for (int f = 0; f < faceset_count; f++) {
+        names[f] = prim->userData().get2<std::string>(zeno::format("faceset_{}", f));
+    }
+    bool has_uv_index = use_polys && prim->loops.attr_is<int>("uvs");
+    list->arr.resize(faceset_count);
+
+#pragma omp parallel
+    {
+        // verts and uvs remaps are reset per faceset by walking the touched
+        // entries only, so each thread pays O(V) once rather than per faceset
+        std::vector<int> vert_remap(kill_dead_verts ? prim->verts.size() : 0, -1);
+        std::vector<int> uv_remap(has_uv_index ? prim->uvs.size() : 0, -1);
+
+#pragma omp for schedule(dynamic)
+        for (int f = 0; f < faceset_count; f++) {
+            auto new_prim = std::make_shared<PrimitiveObject>();
+            new_prim->userData() = prim->userData();
+            new_prim->mtl = prim->mtl;
+            new_prim->inst = prim->inst;
+            auto faces_begin = faceset_faces.begin() + faceset_offset[f];
+            auto faces_end = faceset_faces.begin() + faceset_offset[f + 1];
+            std::vector<int> faces(faces_begin, faces_end);
+
+            if (use_polys) {
+                gather_attr_vector(new_prim->polys, prim->polys, faces);
+                std::vector<int> loop_revamp;
+                int base = 0;
+                for (auto &[start, len]: new_prim->polys) {
+                    for (int l = start; l < start + len; l++) {
+                        loop_revamp.push_back(l);
+                    }
+                    start = base;
+                    base += len;
                 }
-            });
-            for (auto j = 0; j < faceset_count; j++) {
-                new_prim->userData().del(zeno::format("faceset_{}", j));
+                gather_attr_vector(new_prim->loops, prim->loops, loop_revamp);
+                if (has_uv_index) {
+                    auto &uv_index = new_prim->loops.attr<int>("uvs");
+                    std::vector<int> uv_revamp;
+                    for (auto &ind: uv_index) {
+                        if (uv_remap[ind] == -1) {
+                            uv_remap[ind] = uv_revamp.size();
+                            uv_revamp.push_back(ind);
+                        }
+                        ind = uv_remap[ind];
+                    }
+                    gather_attr_vector(new_prim->uvs, prim->uvs, uv_revamp);
+                    for (auto ind: uv_revamp) {
+                        uv_remap[ind] = -1;
+                    }
+                } else {
+                    new_prim->uvs = prim->uvs;
+                }
+                new_prim->tris = prim->tris;
+            } else {
+                gather_attr_vector(new_prim->tris, prim->tris, faces);
+                new_prim->uvs = prim->uvs;
+            }
+            new_prim->points = prim->points;
+            new_prim->lines = prim->lines;
+            new_prim->quads = prim->quads;
+            new_prim->edges = prim->edges;
+
+            if (kill_dead_verts) {
+                std::vector<int> vert_revamp;
+                auto reach = [&] (int ind) {
+                    if (vert_remap[ind] == -1) {
+                        vert_remap[ind] = 0;
+                        vert_revamp.push_back(ind);
+                    }
+                };
+                for (auto ind: new_prim->points) reach(ind);
+                for (auto const &ind: new_prim->lines) { reach(ind[0]); reach(ind[1]); }
+                for (auto const &ind: new_prim->edges) { reach(ind[0]); reach(ind[1]); }
+                for (auto const &ind: new_prim->tris) { reach(ind[0]); reach(ind[1]); reach(ind[2]); }
+                for (auto const &ind: new_prim->quads) { reach(ind[0]); reach(ind[1]); reach(ind[2]); reach(ind[3]); }
+                for (auto ind: new_prim->loops) reach(ind);
+                // keep the original vertex order, as primKillDeadVerts does
+                std::sort(vert_revamp.begin(), vert_revamp.end());
+                for (size_t i = 0; i < vert_revamp.size(); i++) {
+                    vert_remap[vert_revamp[i]] = i;
+                }
+                gather_attr_vector(new_prim->verts, prim->verts, vert_revamp);
+                for (auto &ind: new_prim->points) ind = vert_remap[ind];
+                for (auto &ind: new_prim->lines) { for (int k = 0; k < 2; k++) ind[k] = vert_remap[ind[k]]; }
+                for (auto &ind: new_prim->edges) { for (int k = 0; k < 2; k++) ind[k] = vert_remap[ind[k]]; }
+                for (auto &ind: new_prim->tris) { for (int k = 0; k < 3; k++) ind[k] = vert_remap[ind[k]]; }
+                for (auto &ind: new_prim->quads) { for (int k = 0; k < 4; k++) ind[k] = vert_remap[ind[k]]; }
+                for (auto &ind: new_prim->loops) ind = vert_remap[ind];
+                for (auto ind: vert_revamp) {
+                    vert_remap[ind] = -1;
+                }
+            } else {
+                new_prim->verts = prim->verts;
             }
-            prim_set_faceset(new_prim.get(), name);
-            list->arr.push_back(new_prim);
+
+            prim_set_faceset(new_prim.get(), names[f]);
+            list->arr[f] = std::move(new_prim);
         }
     }
     return list;
@@ -1299,12 +1504,9 @@ struct AlembicSplitByName: INode {
         }
 
         auto dict = std::make_shared<zeno::DictObject>();
-        auto list = abc_split_by_name(prim, false);
+        auto list = abc_split_by_name(prim, false, get_input2<bool>("killDeadVerts"));
         for (auto& prim: list->get<PrimitiveObject>()) {
             auto name = prim->userData().get2<std::string>("faceset_0");
-            if (get_input2<bool>("killDeadVerts")) {
-                primKillDeadVerts(prim.get());
-            }
             dict->lut[name] = std::move(prim);
         }
         set_output("dict", dict);
@@ -4,17 +4,15 @@
 #include <zeno/utils/vec.h>
 #include <zeno/zeno.h>
 #include "zeno/utils/logger.h"
+#include "zeno/utils/concurrent_cache.h"
 #include "zeno/types/UserData.h"
 #include "zeno/types/NumericObject.h"
 #include "aquila/aquila/aquila.h"
 #include <deque>
 #include <zeno/types/ListObject.h>
-#include "AudioFile.h"
+#include "AudioSource.h"
 #include <algorithm>
-
-#define MINIMP3_IMPLEMENTATION
-#define MINIMP3_FLOAT_OUTPUT
-#include "minimp3.h"
+#include <cstring>
 
 namespace zaudio {
 static float lerp(float start, float end, float value) {
@@ -22,70 +20,132 @@ static float lerp(float start, float end, float value) {
 }
 }
 namespace zeno {
-static std::shared_ptr<PrimitiveObject> readWav(std::string path){
-    AudioFile<float> wav;
-    wav.load (path);
-    wav.printSummary();
+// decodes channel 0 straight into the wave, without an intermediate copy of the file
+static std::shared_ptr<PrimitiveObject> readAudio(std::string path) {
+    auto source = openAudioSource(path);
 
     auto result = std::make_shared<PrimitiveObject>(); // std::shared_ptr<PrimitiveObject>
-    result->resize(wav.getNumSamplesPerChannel());
+    result->resize(source->numSamples);
     auto &value = result->add_attr<float>("value"); //std::vector<float>
     auto &t = result->add_attr<float>("t");
-
+    source->read(0, source->numSamples, 0, value.data());
     for (std::size_t i = 0; i < result->verts.size(); ++i) {
-        value[i] = wav.samples[0][i];
         t[i] = float(i);
     }
 
-    result->userData().set("SampleRate", std::make_shared<zeno::NumericObject>((int)wav.getSampleRate()));
-    result->userData().set("BitDepth", std::make_shared<zeno::NumericObject>((int)wav.getBitDepth()));
-    result->userData().set("NumSamplesPerChannel", std::make_shared<zeno::NumericObject>((int)wav.getNumSamplesPerChannel()));
-    result->userData().set("LengthInSeconds", std::make_shared<zeno::NumericObject>((float)wav.getLengthInSeconds()));
+    result->userData().set("SampleRate", std::make_shared<zeno::NumericObject>(source->sampleRate));
+    if (source->bitDepth) {
+        result->userData().set("BitDepth", std::make_shared<zeno::NumericObject>(source->bitDepth));
+    }
+    result->userData().set("NumSamplesPerChannel", std::make_shared<zeno::NumericObject>((int)source->numSamples));
+    result->userData().set("LengthInSeconds", std::make_shared<zeno::NumericObject>(source->lengthInSeconds()));
 
-    return std::move(result);
+    return result;
+}
+
+static std::shared_ptr<PrimitiveObject> readWav(std::string path) {
+    return readAudio(std::move(path));
 }
 
 static std::shared_ptr<PrimitiveObject> readMp3(std::string path) {
+    return readAudio(std::move(path));
+}
 
-    // open the file:
-    std::ifstream file(path, std::ios::binary);
-    // read the data:
-    auto data = std::vector<uint8_t>((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-
-    static mp3dec_t mp3d;
-    mp3dec_init(&mp3d);
-
-    mp3dec_frame_info_t info;
-    float pcm[MINIMP3_MAX_SAMPLES_PER_FRAME];
-    int mp3len = 0;
-    int sample_len = 0;
-
-    std::vector<float> decoded_data;
-    decoded_data.reserve(44100 * 30);
-    while (true) {
-        int samples = mp3dec_decode_frame(&mp3d, data.data() + mp3len, data.size() - mp3len, pcm, &info);
-        if (samples == 0) {
-            break;
-        }
-        sample_len += samples;
-        mp3len += info.frame_bytes;
-        for (auto i = 0; i < samples * info.channels; i += info.channels) {
-            decoded_data.push_back(pcm[i]);
+// power spectra of consecutive windows of a clip, every node asking for the same clip
+// and window size shares one instance instead of redoing the ffts
+struct SpectrogramObject : IObjectClone<SpectrogramObject> {
+    int windowSize = 0;
+    int numBins = 0;                    // windowSize / 2 + 1
+    float sampleRate = 0;
+    std::vector<float> power;           // numWindows * numBins, |X|^2 / windowSize
+    std::vector<double> energy;         // per window, |X|^2 summed over the full spectrum / windowSize
+    double minE = std::numeric_limits<double>::max();
+    double maxE = std::numeric_limits<double>::min();
+
+    std::size_t numWindows() const {
+        return energy.size();
+    }
+
+    float const *spectrum(std::size_t window) const {
+        return power.data() + window * numBins;
+    }
+};
+
+static std::shared_ptr<SpectrogramObject> computeSpectrogram(std::vector<float> const &value, int windowSize, float sampleRate) {
+    auto spec = std::make_shared<SpectrogramObject>();
+    spec->windowSize = windowSize;
+    spec->numBins = windowSize / 2 + 1;
+    spec->sampleRate = sampleRate;
+    int clip_count = value.size() / windowSize;
+    spec->power.resize((std::size_t)clip_count * spec->numBins);
+    spec->energy.resize(clip_count);
+
+#pragma omp parallel
+    {
+        // ooura keeps its work tables in the fft object, so each thread needs its own
+        auto fft = Aquila::FftFactory::getFft(windowSize);
+        std::vector<double> samples(windowSize);
+#pragma omp for schedule(dynamic, 16)
+        for (int i = 0; i < clip_count; i++) {
+            std::copy_n(value.data() + (std::size_t)windowSize * i, windowSize, samples.data());
+            Aquila::SpectrumType spectrums = fft->fft(samples.data());
+            double E = 0;
+            for (const auto& spectrum: spectrums) {
+                E += spectrum.real() * spectrum.real() + spectrum.imag() * spectrum.imag();
+            }
+            spec->energy[i] = E / windowSize;
+            float *power = spec->power.data() + (std::size_t)i * spec->numBins;
+            for (int k = 0; k < spec->numBins; k++) {
+                power[k] = std::norm(spectrums[k]) / windowSize;
+            }
         }
     }
-    auto result = std::make_shared<PrimitiveObject>(); // std::shared_ptr<PrimitiveObject>
-    result->resize(sample_len);
-    auto &value = result->add_attr<float>("value"); //std::vector<float>
-    auto &t = result->add_attr<float>("t");
-    for (std::size_t i = 0; i < result->verts.size(); ++i) {
-        value[i] = decoded_data[i];
-        t[i] = float(i);
+    for (double E: spec->energy) {
+        spec->minE = std::min(spec->minE, E);
+        spec->maxE = std::max(spec->maxE, E);
     }
-    result->userData().set("SampleRate",std::make_shared<zeno::NumericObject>((int)info.hz));
-    result->userData().set("NumSamplesPerChannel", std::make_shared<zeno::NumericObject>((int)sample_len));
-    result->userData().set("LengthInSeconds", std::make_shared<zeno::NumericObject>((float)sample_len/(float)info.hz));
+    return spec;
+}
 
-    return std::move(result);
+// fnv-1a over the sample bits of fixed-size chunks hashed in parallel, then folded in
+// order, so the result does not depend on the number of threads
+static std::uint64_t hashSamples(std::vector<float> const &value) {
+    constexpr std::size_t chunk = std::size_t(1) << 16;
+    std::size_t nchunks = (value.size() + chunk - 1) / chunk;
+    std::vector<std::uint64_t> hashes(nchunks);
+#pragma omp parallel for
+    for (intptr_t c = 0; c < (intptr_t)nchunks; c++) {
+        std::uint64_t h = 1469598103934665603ull;
+        std::size_t e = std::min(value.size(), (c + 1) * chunk);
+        for (std::size_t i = c * chunk; i < e; i++) {
+            std::uint32_t bits;
+            std::memcpy(&bits, &value[i], sizeof(bits));
+            h = (h ^ bits) * 1099511628211ull;
+        }
+        hashes[c] = h;
+    }
+    std::uint64_t h = 1469598103934665603ull;
+    for (auto ch: hashes)
+        h = (h ^ ch) * 1099511628211ull;
+    return h;
+}
+
+// keyed by the samples themselves, any node may have rewritten "value" since the wave
+// was read, hashing them is still far cheaper than the spectrogram
+static std::shared_ptr<SpectrogramObject const> getSpectrogram(PrimitiveObject *wave, int windowSize) {
+    auto &value = wave->attr<float>("value");
+    float sampleRate = wave->userData().get<zeno::NumericObject>("SampleRate")->get<float>();
+
+    std::string key = std::to_string(windowSize) + ':' + std::to_string(sampleRate) + ':'
+        + std::to_string(value.size()) + ':' + std::to_string(hashSamples(value));
+
+    // bounded by the bytes of the spectrograms kept, long recordings evict sooner
+    static ConcurrentCache<std::string, SpectrogramObject const> cache(std::size_t(256) << 20, [] (SpectrogramObject const &spec) {
+        return spec.power.size() * sizeof(float) + spec.energy.size() * sizeof(double);
+    });
+    return cache.get_or_compute(key, [&] {
+        return std::shared_ptr<SpectrogramObject const>(computeSpectrogram(value, windowSize, sampleRate));
+    });
 }
 
     struct ReadWavFile : zeno::INode {
@@ -175,13 +235,14 @@ static std::shared_ptr<PrimitiveObject> readMp3(std::string path) {
             int start_index = int(sampleFrequency * start_time);
             int duration_count = 1024;
             auto fft = Aquila::FftFactory::getFft(duration_count);
+            auto &value = wave->attr<float>("value");
             std::vector<double> samples;
             samples.resize(duration_count);
             for (auto i = 0; i < duration_count; i++) {
 //                if (start_index + i >= wave->size()) {
 //                    break;
 //                }
-                samples[i] = wave->attr<float>("value")[min((start_index + i), wave->size()-1)];
+                samples[i] = value[min((start_index + i), wave->size()-1)];
                 
                 //if (start_index + i >= wave->size()) {
                 //    break;
@@ -255,38 +316,13 @@ static std::shared_ptr<PrimitiveObject> readMp3(std::string path) {
     });
 
     struct AudioEnergy : zeno::INode {
-        double minE = std::numeric_limits<double>::max();
-        double maxE = std::numeric_limits<double>::min();
-        std::vector<double> init;
         virtual void apply() override {
             auto wave = get_input<PrimitiveObject>("wave");
             int duration_count = 1024;
-            if (init.empty()) {
-                auto fft = Aquila::FftFactory::getFft(duration_count);
-                int clip_count = wave->size() / duration_count;
-                init.reserve(clip_count);
-                for (auto i = 0; i < clip_count; i++) {
-                    std::vector<double> samples;
-                    samples.resize(duration_count);
-                    for (auto j = 0; j < duration_count; j++) {
-                        samples[j] = wave->attr<float>("value")[min(duration_count * i + j, wave->size()-1)];
-                    }
-                    Aquila::SpectrumType spectrums = fft->fft(samples.data());
-                    {
-                        double E = 0;
-                        for (const auto& spectrum: spectrums) {
-                            E += spectrum.real() * spectrum.real() + spectrum.imag() * spectrum.imag();
-                        }
-                        E /= duration_count;
-                        minE = min(minE, E);
-                        maxE = max(maxE, E);
-                        init.push_back(E);
-                    }
-                }
-    //            for (auto i = 0; i < clip_count; i++) {
-    //                init[i] = init[i] / maxE;
-    //            }
-            }
+            auto spec = getSpectrogram(wave.get(), duration_count);
+            auto const &init = spec->energy;
+            double minE = spec->minE;
+            double maxE = spec->maxE;
 
     //        auto vis = std::make_shared<PrimitiveObject>();
     //        vis->resize(init.size());
@@ -305,10 +341,11 @@ static std::shared_ptr<PrimitiveObject> readMp3(std::string path) {
             float sampleFrequency = wave->userData().get<zeno::NumericObject>("SampleRate")->get<float>();
             int start_index = int(sampleFrequency * start_time);
             auto fft = Aquila::FftFactory::getFft(duration_count);
+            auto &value = wave->attr<float>("value");
             std::vector<double> samples;
             samples.resize(duration_count);
             for (auto i = 0; i < duration_count; i++) {
-                samples[i] = wave->attr<float>("value")[min((start_index + i), wave->size()-1)];
+                samples[i] = value[min((start_index + i), wave->size()-1)];
             }
             Aquila::SpectrumType spectrums = fft->fft(samples.data());
             double E = 0;
@@ -367,6 +404,50 @@ static std::shared_ptr<PrimitiveObject> readMp3(std::string path) {
         },
     });
 
+    struct AudioBandEnergy : zeno::INode {
+        virtual void apply() override {
+            auto wave = get_input<PrimitiveObject>("wave");
+            int windowSize = std::max(get_input2<int>("windowSize"), 2);
+            auto spec = getSpectrogram(wave.get(), windowSize);
+            auto time = get_input2<float>("time");
+            auto lowFreq = get_input2<float>("lowFreq");
+            auto highFreq = get_input2<float>("highFreq");
+
+            float E = 0, flux = 0;
+            if (spec->numWindows() > 0) {
+                int window = std::clamp<int>(time * spec->sampleRate / windowSize, 0, spec->numWindows() - 1);
+                int lowBin = std::clamp<int>(std::ceil(lowFreq * windowSize / spec->sampleRate), 0, spec->numBins - 1);
+                int highBin = std::clamp<int>(std::floor(highFreq * windowSize / spec->sampleRate), 0, spec->numBins - 1);
+                float const *cur = spec->spectrum(window);
+                float const *prev = window > 0 ? spec->spectrum(window - 1) : nullptr;
+                for (int k = lowBin; k <= highBin; k++) {
+                    E += cur[k];
+                    if (prev)
+                        flux += std::max(0.0f, cur[k] - prev[k]);
+                }
+            }
+            set_output("E", std::make_shared<NumericObject>(E));
+            set_output("flux", std::make_shared<NumericObject>(flux));
+        }
+    };
+    ZENDEFNODE(AudioBandEnergy, {
+        {
+            "wave",
+            {"float", "time", "0"},
+            {"float", "lowFreq", "0"},
+            {"float", "highFreq", "22050"},
+            {"int", "windowSize", "1024"},
+        },
+        {
+            "E",
+            "flux",
+        },
+        {},
+        {
+            "audio"
+        },
+    });
+
     struct AudioFFT : zeno::INode {
         virtual void apply() override {
             auto wave = get_input<PrimitiveObject>("wave");
@@ -374,10 +455,11 @@ static std::shared_ptr<PrimitiveObject> readMp3(std::string path) {
             auto start_time = get_input2<float>("time");
             float sampleFrequency = wave->userData().get<zeno::NumericObject>("SampleRate")->get<float>();
             int start_index = int(sampleFrequency * start_time);
+            auto &value = wave->attr<float>("value");
             std::vector<double> samples;
             samples.resize(duration_count+1);
             for (auto i = 0; i < duration_count+1; i++) {
-                samples[i] = wave->attr<float>("value")[min((start_index + i), wave->size()-1)];
+                samples[i] = value[min((start_index + i), wave->size()-1)];
             }
             auto pre_emphasis = get_input2<int>("preEmphasis");
             if (pre_emphasis) {
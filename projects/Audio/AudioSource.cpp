@@ -0,0 +1,384 @@
+#include "AudioSource.h"
+#include <zeno/zeno.h>
+#include <zeno/types/PrimitiveObject.h>
+#include <zeno/types/NumericObject.h>
+#include <zeno/types/StringObject.h>
+#include <zeno/types/UserData.h>
+#include <zeno/utils/Error.h>
+#include <zeno/utils/log.h>
+#include <zeno/utils/mapped_file.h>
+#include <zeno/utils/concurrent_cache.h>
+#include <zeno/utils/tuple_hash.h>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#define MINIMP3_IMPLEMENTATION
+#define MINIMP3_FLOAT_OUTPUT
+#include "minimp3.h"
+
+namespace zeno {
+
+namespace {
+
+// mp3 frames borrow up to 511 bytes of the previous frames' data, so a seek starts
+// decoding this many frames early and drops their output
+constexpr std::size_t kMp3Preroll = 10;
+
+// samples decoded per step while streaming over a whole file
+constexpr std::size_t kStreamChunk = std::size_t(1) << 18;
+
+// sources kept open by openAudioSource, least recently used ones are closed first
+constexpr std::size_t kMaxOpenSources = 32;
+
+struct WavFormat {
+    int format = 0;                 // 1 pcm, 3 ieee float
+    int blockAlign = 0;
+    int bytesPerSample = 0;
+    std::size_t dataOffset = 0;
+};
+
+struct Mp3Frame {
+    std::size_t offset;
+    std::size_t sampleStart;
+};
+
+std::uint32_t readLE(unsigned char const *p, int bytes) {
+    std::uint32_t v = 0;
+    for (int i = 0; i < bytes; i++)
+        v |= std::uint32_t(p[i]) << (8 * i);
+    return v;
+}
+
+float decodeWavSample(unsigned char const *p, WavFormat const &fmt) {
+    if (fmt.format == 3) {
+        if (fmt.bytesPerSample == 8) {
+            double d;
+            std::memcpy(&d, p, 8);
+            return (float)d;
+        }
+        float f;
+        std::memcpy(&f, p, 4);
+        return f;
+    }
+    switch (fmt.bytesPerSample) {
+    case 1: return (int(p[0]) - 128) / 128.0f;
+    case 2: return std::int16_t(readLE(p, 2)) / 32768.0f;
+    case 3: return (std::int32_t(readLE(p, 3) << 8) >> 8) / 8388608.0f;
+    default: return std::int32_t(readLE(p, 4)) / 2147483648.0f;
+    }
+}
+
+}
+
+struct AudioSourceObject::Impl {
+    bool isMp3 = false;
+    WavFormat wav;
+    mapped_file mp3;
+    std::vector<Mp3Frame> frames;
+
+    ConcurrentCache<std::pair<int, int>, Envelope const, tuple_hash> envelopes;
+
+    bool openWav(AudioSourceObject &src);
+    bool openMp3(AudioSourceObject &src);
+    void readWav(AudioSourceObject const &src, std::size_t start, std::size_t count, int channel, float *out) const;
+    void readMp3(std::size_t start, std::size_t count, int channel, float *out) const;
+};
+
+bool AudioSourceObject::Impl::openWav(AudioSourceObject &src) {
+    std::ifstream file(std::filesystem::u8path(src.path), std::ios::binary);
+    unsigned char riff[12];
+    if (!file.read((char *)riff, 12) || std::memcmp(riff, "RIFF", 4) || std::memcmp(riff + 8, "WAVE", 4))
+        return false;
+
+    bool hasFmt = false;
+    unsigned char chunk[8];
+    while (file.read((char *)chunk, 8)) {
+        std::uint32_t size = readLE(chunk + 4, 4);
+        std::size_t body = (std::size_t)file.tellg();
+        if (!std::memcmp(chunk, "fmt ", 4)) {
+            unsigned char fmt[40] = {};
+            file.read((char *)fmt, std::min<std::uint32_t>(size, 40));
+            wav.format = readLE(fmt, 2);
+            src.channels = readLE(fmt + 2, 2);
+            src.sampleRate = readLE(fmt + 4, 4);
+            wav.blockAlign = readLE(fmt + 12, 2);
+            src.bitDepth = readLE(fmt + 14, 2);
+            if (wav.format == 0xFFFE && size >= 26)  // WAVE_FORMAT_EXTENSIBLE, subformat guid
+                wav.format = readLE(fmt + 24, 2);
+            wav.bytesPerSample = src.bitDepth / 8;
+            hasFmt = true;
+        } else if (!std::memcmp(chunk, "data", 4)) {
+            if (!hasFmt || wav.blockAlign <= 0)
+                return false;
+            // streamed writers may leave the size unset, trust the file length instead
+            std::error_code ec;
+            std::size_t fileSize = std::filesystem::file_size(std::filesystem::u8path(src.path), ec);
+            std::size_t dataSize = ec ? size : std::min<std::size_t>(size, fileSize - body);
+            wav.dataOffset = body;
+            src.numSamples = dataSize / wav.blockAlign;
+            break;
+        }
+        file.clear();
+        file.seekg(body + size + (size & 1));
+    }
+    if (!hasFmt || !wav.dataOffset || src.channels <= 0)
+        return false;
+    if (wav.format == 1 ? !(wav.bytesPerSample >= 1 && wav.bytesPerSample <= 4)
+                        : !(wav.format == 3 && (wav.bytesPerSample == 4 || wav.bytesPerSample == 8)))
+        return false;
+    return true;
+}
+
+bool AudioSourceObject::Impl::openMp3(AudioSourceObject &src) {
+    if (!mp3.open(src.path) || mp3.empty())
+        return false;
+    isMp3 = true;
+
+    // header-only pass: passing no pcm buffer makes minimp3 skip the decoding, except
+    // up to the first frame with output, since a stream cut mid-way starts with frames
+    // whose main data lies before the cut and a full decode drops them; they are kept
+    // with no samples as a seek still feeds them to the bit reservoir
+    auto data = (std::uint8_t const *)mp3.data();
+    mp3dec_t dec;
+    mp3dec_init(&dec);
+    mp3dec_frame_info_t info;
+    std::vector<float> pcm(MINIMP3_MAX_SAMPLES_PER_FRAME);
+    std::size_t pos = 0;
+    while (pos < mp3.size()) {
+        int bytes = (int)std::min<std::size_t>(mp3.size() - pos, INT_MAX);
+        bool leading = !src.numSamples;
+        int samples = mp3dec_decode_frame(&dec, data + pos, bytes, leading ? pcm.data() : nullptr, &info);
+        if (!info.frame_bytes)
+            break;
+        if (samples && leading) {
+            src.sampleRate = info.hz;
+            src.channels = info.channels;
+        }
+        if (samples || leading)
+            frames.push_back({pos + info.frame_offset, src.numSamples});
+        src.numSamples += samples;
+        pos += info.frame_bytes;
+    }
+    return src.numSamples > 0;
+}
+
+void AudioSourceObject::Impl::readWav(AudioSourceObject const &src, std::size_t start, std::size_t count, int channel, float *out) const {
+    std::ifstream file(std::filesystem::u8path(src.path), std::ios::binary);
+    file.seekg(wav.dataOffset + start * wav.blockAlign);
+    std::size_t chunkFrames = std::max<std::size_t>(1, (std::size_t(1) << 20) / wav.blockAlign);
+    std::vector<unsigned char> buf(std::min(count, chunkFrames) * wav.blockAlign);
+    std::size_t channelOffset = (std::size_t)channel * wav.bytesPerSample;
+    for (std::size_t done = 0; done < count;) {
+        std::size_t n = std::min(count - done, chunkFrames);
+        if (!file.read((char *)buf.data(), n * wav.blockAlign))
+            break;
+        for (std::size_t i = 0; i < n; i++)
+            out[done + i] = decodeWavSample(buf.data() + i * wav.blockAlign + channelOffset, wav);
+        done += n;
+    }
+}
+
+void AudioSourceObject::Impl::readMp3(std::size_t start, std::size_t count, int channel, float *out) const {
+    std::size_t end = start + count;
+    auto it = std::upper_bound(frames.begin(), frames.end(), start,
+                               [](std::size_t s, Mp3Frame const &f) { return s < f.sampleStart; });
+    std::size_t target = (it - frames.begin()) - 1;
+    std::size_t first = target > kMp3Preroll ? target - kMp3Preroll : 0;
+
+    auto data = (std::uint8_t const *)mp3.data();
+    mp3dec_t dec;
+    mp3dec_init(&dec);
+    mp3dec_frame_info_t info;
+    std::vector<float> pcm(MINIMP3_MAX_SAMPLES_PER_FRAME);
+    for (std::size_t f = first; f < frames.size() && frames[f].sampleStart < end; f++) {
+        std::size_t pos = frames[f].offset;
+        int bytes = (int)std::min<std::size_t>(mp3.size() - pos, INT_MAX);
+        int samples = mp3dec_decode_frame(&dec, data + pos, bytes, pcm.data(), &info);
+        if (f < target || !samples)
+            continue;
+        int ch = std::min(channel, info.channels - 1);
+        std::size_t s0 = frames[f].sampleStart;
+        std::size_t b = std::max(s0, start), e = std::min(s0 + samples, end);
+        for (std::size_t s = b; s < e; s++)
+            out[s - start] = pcm[(s - s0) * info.channels + ch];
+    }
+}
+
+void AudioSourceObject::read(std::size_t start, std::size_t count, int channel, float *out) const {
+    std::fill_n(out, count, 0.0f);
+    if (start >= numSamples || channels <= 0)
+        return;
+    count = std::min(count, numSamples - start);
+    channel = std::clamp(channel, 0, channels - 1);
+    if (impl->isMp3)
+        impl->readMp3(start, count, channel, out);
+    else
+        impl->readWav(*this, start, count, channel, out);
+}
+
+std::shared_ptr<AudioSourceObject::Envelope const> AudioSourceObject::envelope(int channel, int blockSize) const {
+    blockSize = std::max(blockSize, 1);
+    // read() clamps the channel too, out of range ones share the entry of the channel they read
+    channel = std::clamp(channel, 0, std::max(channels - 1, 0));
+    // other channels and block sizes are computed concurrently, the same one only once
+    return impl->envelopes.get_or_compute({channel, blockSize}, [&] {
+        auto env = std::make_shared<Envelope>();
+        env->blockSize = blockSize;
+        std::size_t numBlocks = (numSamples + blockSize - 1) / blockSize;
+        env->peak.resize(numBlocks);
+        env->rms.resize(numBlocks);
+        std::size_t chunk = std::max<std::size_t>(kStreamChunk / blockSize, 1) * blockSize;
+        std::vector<float> buf(std::min(chunk, numSamples));
+        for (std::size_t start = 0; start < numSamples; start += chunk) {
+            std::size_t n = std::min(chunk, numSamples - start);
+            read(start, n, channel, buf.data());
+            for (std::size_t b = 0; b < n; b += blockSize) {
+                std::size_t e = std::min<std::size_t>(b + blockSize, n);
+                float peak = 0;
+                double sum = 0;
+                for (std::size_t i = b; i < e; i++) {
+                    peak = std::max(peak, std::abs(buf[i]));
+                    sum += double(buf[i]) * buf[i];
+                }
+                std::size_t block = (start + b) / blockSize;
+                env->peak[block] = peak;
+                env->rms[block] = (float)std::sqrt(sum / (e - b));
+            }
+        }
+        return std::shared_ptr<Envelope const>(std::move(env));
+    });
+}
+
+std::shared_ptr<AudioSourceObject> openAudioSource(std::string const &path) {
+    std::error_code ec;
+    auto mtime = std::filesystem::last_write_time(std::filesystem::u8path(path), ec);
+    std::string key = path + '@' + std::to_string(ec ? 0 : mtime.time_since_epoch().count());
+
+    // a rewritten file gets a new key, its stale source is never used again and ages out
+    static ConcurrentCache<std::string, AudioSourceObject> cache(kMaxOpenSources);
+    return cache.get_or_compute(key, [&] {
+        auto src = std::make_shared<AudioSourceObject>();
+        src->path = path;
+        src->impl = std::make_shared<AudioSourceObject::Impl>();
+        auto ext = std::filesystem::u8path(path).extension().string();
+        std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+        bool ok = ext == ".mp3" ? src->impl->openMp3(*src) : src->impl->openWav(*src);
+        if (!ok)
+            throw makeError("cannot open audio file: " + path);
+        return src;
+    });
+}
+
+// sample index at time seconds, rounded to the nearest one
+static std::size_t sampleAtTime(AudioSourceObject const &source, float time) {
+    return (std::size_t)std::llround(std::max(0.0, (double)time) * source.sampleRate);
+}
+
+struct OpenAudioSource : INode {
+    virtual void apply() override {
+        auto path = get_input2<std::string>("path");
+        auto source = openAudioSource(path);
+        set_output("source", source);
+        set_output("SampleRate", std::make_shared<NumericObject>(source->sampleRate));
+        set_output("LengthInSeconds", std::make_shared<NumericObject>(source->lengthInSeconds()));
+    }
+};
+
+ZENDEFNODE(OpenAudioSource, {
+    {
+        {"readpath", "path"},
+    },
+    {
+        "source",
+        "SampleRate",
+        "LengthInSeconds",
+    },
+    {},
+    {
+        "audio"
+    },
+});
+
+// decodes just the samples a frame needs, as a wave the other audio nodes accept
+struct AudioSourceWindow : INode {
+    virtual void apply() override {
+        auto source = get_input<AudioSourceObject>("source");
+        auto time = get_input2<float>("time");
+        auto count = std::max(get_input2<int>("count"), 0);
+        auto channel = get_input2<int>("channel");
+        std::size_t start = sampleAtTime(*source, time);
+
+        auto wave = std::make_shared<PrimitiveObject>();
+        wave->resize(count);
+        auto &value = wave->add_attr<float>("value");
+        auto &t = wave->add_attr<float>("t");
+        source->read(start, count, channel, value.data());
+        for (int i = 0; i < count; i++) {
+            t[i] = float(start + i);
+        }
+        wave->userData().set("SampleRate", std::make_shared<NumericObject>(source->sampleRate));
+        wave->userData().set("NumSamplesPerChannel", std::make_shared<NumericObject>(count));
+        wave->userData().set("LengthInSeconds", std::make_shared<NumericObject>((float)count / std::max(source->sampleRate, 1)));
+        wave->userData().set("StartSample", std::make_shared<NumericObject>((int)start));
+        set_output("wave", wave);
+    }
+};
+
+ZENDEFNODE(AudioSourceWindow, {
+    {
+        "source",
+        {"float", "time", "0"},
+        {"int", "count", "1024"},
+        {"int", "channel", "0"},
+    },
+    {
+        "wave",
+    },
+    {},
+    {
+        "audio"
+    },
+});
+
+struct AudioSourceEnvelope : INode {
+    virtual void apply() override {
+        auto source = get_input<AudioSourceObject>("source");
+        auto time = get_input2<float>("time");
+        auto blockSize = get_input2<int>("blockSize");
+        auto channel = get_input2<int>("channel");
+        auto env = source->envelope(channel, blockSize);
+
+        float peak = 0, rms = 0;
+        if (!env->peak.empty()) {
+            std::size_t block = sampleAtTime(*source, time) / env->blockSize;
+            block = std::min(block, env->peak.size() - 1);
+            peak = env->peak[block];
+            rms = env->rms[block];
+        }
+        set_output("peak", std::make_shared<NumericObject>(peak));
+        set_output("rms", std::make_shared<NumericObject>(rms));
+    }
+};
+
+ZENDEFNODE(AudioSourceEnvelope, {
+    {
+        "source",
+        {"float", "time", "0"},
+        {"int", "blockSize", "1024"},
+        {"int", "channel", "0"},
+    },
+    {
+        "peak",
+        "rms",
+    },
+    {},
+    {
+        "audio"
+    },
+});
+
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <zeno/core/IObject.h>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace zeno {
+
+// an audio file decoded on demand: opening reads only the header (and an index of the
+// mp3 frames), samples are decoded per window, so long recordings never have to sit
+// in memory as a whole; read() is const and may run from several threads
+struct AudioSourceObject : IObjectClone<AudioSourceObject> {
+    struct Envelope {
+        int blockSize = 0;
+        std::vector<float> peak;    // max |sample| per block
+        std::vector<float> rms;
+    };
+
+    std::string path;
+    int sampleRate = 0;
+    int channels = 0;
+    int bitDepth = 0;               // 0 when the format has none (mp3)
+    std::size_t numSamples = 0;     // per channel
+
+    // count samples of channel from sample start on, zero past the end of the file
+    void read(std::size_t start, std::size_t count, int channel, float *out) const;
+
+    // downsampled envelope, computed by streaming over the file once per
+    // channel and block size, then kept with the source
+    std::shared_ptr<Envelope const> envelope(int channel, int blockSize) const;
+
+    float lengthInSeconds() const {
+        return sampleRate > 0 ? (float)numSamples / sampleRate : 0.0f;
+    }
+
+    struct Impl;
+    std::shared_ptr<Impl> impl;
+};
+
+// opens .wav and .mp3 files, an unchanged file is opened again only after it fell out
+// of the most recently used sources
+std::shared_ptr<AudioSourceObject> openAudioSource(std::string const &path);
+
+}
@@ -4,8 +4,11 @@
 #include <zeno/types/NumericObject.h>
 #include <zeno/types/ListObject.h>
 #include <zeno/utils/logger.h>
+#include <zeno/utils/concurrent_cache.h>
 
 #include <mutex>
+#include <memory>
+#include <cstring>
 #include <assert.h>
 #include <stdarg.h>
 #include <stdio.h>
@@ -199,38 +202,127 @@ bool calcUVForPath(std::string path, zeno::PrimitiveObject* outprim)
     return calcUV(shapes, outprim);
 }
 
-bool calcUVForData(zeno::PrimitiveObject* inprim, zeno::PrimitiveObject* outprim)
+// what xatlas made of a mesh: the input vertex and uv of every output vertex, and the
+// output triangles; it only depends on the topology the charts were cut from, so it is
+// reused for every frame of a deforming mesh
+struct UVLayout
 {
-    std::vector<float> v;
-    for (auto p :inprim->verts)
-    {
-        v.push_back(p[0]);
-        v.push_back(p[1]);
-        v.push_back(p[2]);
+    std::vector<uint32_t> xref;
+    std::vector<zeno::vec3f> uv;
+    std::vector<zeno::vec3i> tris;
+};
+
+static uint64_t hashTopology(zeno::PrimitiveObject *prim)
+{
+    uint64_t h = 1469598103934665603ull;
+    auto mix = [&] (uint64_t v) {
+        h = (h ^ v) * 1099511628211ull;
+    };
+    mix(prim->verts.size());
+    for (auto const &ind: prim->tris) {
+        mix((uint32_t)ind[0] | (uint64_t)(uint32_t)ind[1] << 32);
+        mix((uint32_t)ind[2]);
     }
-    std::vector<float> f;
-    for (auto p :inprim->tris)
-    {
-        f.push_back(p[0]);
-        f.push_back(p[1]);
-        f.push_back(p[2]);
+    return h;
+}
+
+static std::shared_ptr<UVLayout const> unwrapLayout(zeno::PrimitiveObject *prim)
+{
+    xatlas::Atlas *atlas = xatlas::Create();
+    Stopwatch stopwatch;
+    xatlas::SetProgressCallback(atlas, ProgressCallback, &stopwatch);
+
+    // xatlas reads the primitive in place, vec3f and vec3i are tightly packed
+    xatlas::MeshDecl meshDecl;
+    meshDecl.vertexCount = (uint32_t)prim->verts.size();
+    meshDecl.vertexPositionData = prim->verts.data();
+    meshDecl.vertexPositionStride = sizeof(zeno::vec3f);
+    meshDecl.indexCount = (uint32_t)prim->tris.size() * 3;
+    meshDecl.indexData = prim->tris.data();
+    meshDecl.indexFormat = xatlas::IndexFormat::UInt32;
+
+    xatlas::AddMeshError error = xatlas::AddMesh(atlas, meshDecl, 1);
+    if (error != xatlas::AddMeshError::Success) {
+        xatlas::Destroy(atlas);
+        zeno::log_error("Error adding mesh: {}", xatlas::StringForEnum(error));
+        return nullptr;
     }
-    zeno::log_info("total vertices: {}", inprim->verts.size());
-    zeno::log_info("total faces: {}", inprim->tris.size());
+    zeno::log_info("Generating atlas");
+    xatlas::Generate(atlas);
+    zeno::log_info("charts {}", atlas->chartCount);
+    zeno::log_info("{}x{} resolution", atlas->width, atlas->height);
 
-    std::string err;    
-    tinyobj::shape_t shape;
+    auto layout = std::make_shared<UVLayout>();
+    const xatlas::Mesh &mesh = atlas->meshes[0];
+    layout->xref.resize(mesh.vertexCount);
+    layout->uv.resize(mesh.vertexCount);
+    layout->tris.resize(mesh.indexCount / 3);
+    float invWidth = 1.f / atlas->width, invHeight = 1.f / atlas->height;
+#pragma omp parallel for
+    for (int v = 0; v < (int)mesh.vertexCount; v++) {
+        const xatlas::Vertex &vertex = mesh.vertexArray[v];
+        layout->xref[v] = vertex.xref;
+        layout->uv[v] = zeno::vec3f(vertex.uv[0] * invWidth, vertex.uv[1] * invHeight, 0);
+    }
+    std::memcpy(layout->tris.data(), mesh.indexArray, layout->tris.size() * sizeof(zeno::vec3i));
+    xatlas::Destroy(atlas);
+    return layout;
+}
 
-    bool ret = TranformZenodata(shape, v, f, err);
-    if (ret) {
-        std::vector<tinyobj::shape_t> shapes;
-        shapes.push_back(shape);
-        return calcUV(shapes, outprim);
+static std::shared_ptr<UVLayout const> getUVLayout(zeno::PrimitiveObject *prim, bool cacheByTopology)
+{
+    if (!cacheByTopology)
+        return unwrapLayout(prim);
+
+    uint64_t key = hashTopology(prim);
+    // bounded by bytes, a handful of dense meshes may take what many small ones would
+    static zeno::ConcurrentCache<uint64_t, UVLayout const> cache(std::size_t(512) << 20, [] (UVLayout const &layout) {
+        return layout.xref.size() * sizeof(uint32_t) + layout.uv.size() * sizeof(zeno::vec3f) + layout.tris.size() * sizeof(zeno::vec3i);
+    });
+    if (auto layout = cache.find(key)) {
+        zeno::log_info("reusing uv layout of topology {:x}", key);
+        return layout;
     }
-    else{
-        zeno::log_info("shapes: {}", err.c_str());
+    return cache.get_or_compute(key, [&] {
+        return std::shared_ptr<UVLayout const>(unwrapLayout(prim));
+    });
+}
+
+// output vertices take position and attributes of the input vertex they were split from
+static void applyUVLayout(UVLayout const &layout, zeno::PrimitiveObject *inprim, zeno::PrimitiveObject *outprim)
+{
+    size_t nverts = layout.xref.size();
+    outprim->verts.resize(nverts);
+#pragma omp parallel for
+    for (intptr_t i = 0; i < nverts; i++)
+        outprim->verts[i] = inprim->verts[layout.xref[i]];
+    inprim->verts.foreach_attr([&] (auto const &key, auto const &arr) {
+        using T = std::decay_t<decltype(arr[0])>;
+        auto &outarr = outprim->verts.add_attr<T>(key);
+#pragma omp parallel for
+        for (intptr_t i = 0; i < nverts; i++)
+            outarr[i] = arr[layout.xref[i]];
+    });
+    outprim->verts.add_attr<zeno::vec3f>("uv") = layout.uv;
+    outprim->tris.values = layout.tris;
+
+    zeno::log_info("output: vertices {}", outprim->verts.size());
+    zeno::log_info("output: indices {}", outprim->tris.size());
+}
+
+bool calcUVForData(zeno::PrimitiveObject* inprim, zeno::PrimitiveObject* outprim, bool cacheByTopology)
+{
+    zeno::log_info("total vertices: {}", inprim->verts.size());
+    zeno::log_info("total faces: {}", inprim->tris.size());
+    if (inprim->tris.size() == 0) {
+        zeno::log_error("Error: no triangles to unwrap");
         return false;
     }
+
+    auto layout = getUVLayout(inprim, cacheByTopology);
+    if (!layout)
+        return false;
+    applyUVLayout(*layout, inprim, outprim);
     return true;
 }
 
@@ -249,7 +341,8 @@ struct CalcGeometryUV : zeno::INode{
         else
         {
             auto prim = get_input<zeno::PrimitiveObject>("prim");
-            ret = calcUVForData(prim.get(), outprim);                
+            auto cacheByTopology = get_input2<bool>("cacheByTopology");
+            ret = calcUVForData(prim.get(), outprim, cacheByTopology);                
         }
 
         if(ret == false){
@@ -267,6 +360,7 @@ ZENDEFNODE(CalcGeometryUV,
     {
         {"readpath", "objpath", ""},
         {"PrimitiveObject", "prim", ""},
+        {"bool", "cacheByTopology", "1"},
     },
     /*输出*/
     {   
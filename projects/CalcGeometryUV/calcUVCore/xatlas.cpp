@@ -3124,6 +3124,13 @@ struct Task
 };
 
 #if XA_MULTITHREADED
+// Main thread plus workers. There is always at least one worker, so this is never less than 2,
+// even where hardware_concurrency() reports 1 or 0. Thread-local storage is sized by it.
+static uint32_t hardwareThreadCount()
+{
+	return max(2u, std::thread::hardware_concurrency());
+}
+
 class TaskScheduler
 {
 public:
@@ -3131,7 +3138,7 @@ public:
 	{
 		m_threadIndex = 0;
 		// Max with current task scheduler usage is 1 per thread + 1 deep nesting, but allow for some slop.
-		m_maxGroups = std::thread::hardware_concurrency() * 4;
+		m_maxGroups = hardwareThreadCount() * 4;
 		m_groups = XA_ALLOC_ARRAY(MemTag::Default, TaskGroup, m_maxGroups);
 		for (uint32_t i = 0; i < m_maxGroups; i++) {
 			new (&m_groups[i]) TaskGroup();
@@ -3139,7 +3146,7 @@ public:
 			m_groups[i].ref = 0;
 			m_groups[i].userData = nullptr;
 		}
-		m_workers.resize(std::thread::hardware_concurrency() <= 1 ? 1 : std::thread::hardware_concurrency() - 1);
+		m_workers.resize(hardwareThreadCount() - 1);
 		for (uint32_t i = 0; i < m_workers.size(); i++) {
 			new (&m_workers[i]) Worker();
 			m_workers[i].wakeup = false;
@@ -3168,7 +3175,7 @@ public:
 
 	uint32_t threadCount() const
 	{
-		return max(1u, std::thread::hardware_concurrency()); // Including the main thread.
+		return hardwareThreadCount(); // Including the main thread.
 	}
 
 	// userData is passed to Task::func as groupUserData.
@@ -3424,7 +3431,7 @@ public:
 	ThreadLocal()
 	{
 #if XA_MULTITHREADED
-		const uint32_t n = std::thread::hardware_concurrency();
+		const uint32_t n = hardwareThreadCount();
 #else
 		const uint32_t n = 1;
 #endif
@@ -3436,7 +3443,7 @@ public:
 	~ThreadLocal()
 	{
 #if XA_MULTITHREADED
-		const uint32_t n = std::thread::hardware_concurrency();
+		const uint32_t n = hardwareThreadCount();
 #else
 		const uint32_t n = 1;
 #endif
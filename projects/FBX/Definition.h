@@ -30,9 +30,11 @@ std::cout.setstate(std::ios::failbit); std::cout \
 
 #include <limits>
 #include <algorithm>
+#include <unordered_map>
 #include <zeno/utils/log.h>
 #include <zeno/utils/vec.h>
 #include <zeno/core/IObject.h>
+#include <zeno/types/SkinBindingObject.h>
 
 inline namespace ZenoFBXDefinition {
 
@@ -63,6 +65,8 @@ struct SFBXEvalOption {
     bool interAnimData = false;
     bool printAnimData = false;
     bool evalBlendShape = false;
+    bool dualQuatSkinning = false;
+    bool skinNormals = false;
     float globalScale = 1.0f;
 };
 
@@ -626,6 +630,95 @@ struct IMeshInfo : zeno::IObjectClone<IMeshInfo>{
     std::unordered_map<std::string, std::string> value_corsName;
 };
 
+// joint influences of iVertices packed for skinning, built by the reader along
+// with the mesh data and shared read-only by every evaluation of it
+struct SFBXSkin {
+    std::size_t numVerts = 0;
+    std::vector<std::string> bones;     // bone name of each joint of the binding
+    std::shared_ptr<zeno::SkinBindingObject> binding;
+
+    static std::shared_ptr<SFBXSkin> bind(std::vector<SVertex> const &vertices) {
+        auto skin = std::make_shared<SFBXSkin>();
+        skin->numVerts = vertices.size();
+        std::unordered_map<std::string, int> boneIds;
+        std::vector<int> offsets, joints;
+        std::vector<float> weights;
+        offsets.reserve(vertices.size() + 1);
+        offsets.push_back(0);
+        for (auto const &v: vertices) {
+            for (auto const &[name, w]: v.boneWeights) {
+                auto [it, inserted] = boneIds.try_emplace(name, (int)skin->bones.size());
+                if (inserted)
+                    skin->bones.push_back(name);
+                joints.push_back(it->second);
+                weights.push_back(w);
+            }
+            offsets.push_back((int)joints.size());
+        }
+        skin->binding = zeno::skinBind(offsets, joints, weights);
+        return skin;
+    }
+};
+
+// blendshape targets of one mesh compiled to their nonzero deltas, grouped by the
+// vertex they move, built by the reader like SFBXSkin
+struct SFBXBlendShapes {
+    std::string meshName;
+    std::size_t numTargets = 0;
+    std::vector<int> verts;             // vertices moved by any target
+    std::vector<int> start;             // verts.size() + 1 offsets into the deltas
+    std::vector<int> targets;
+    std::vector<zeno::vec3f> deltaPositions;
+    std::vector<zeno::vec3f> deltaNormals;
+
+    static std::shared_ptr<SFBXBlendShapes> compile(std::string const &meshName,
+                                                    std::vector<std::vector<SBSVertex>> const &targets) {
+        auto bs = std::make_shared<SFBXBlendShapes>();
+        bs->meshName = meshName;
+        bs->numTargets = targets.size();
+        std::size_t nverts = 0;
+        for (auto const &t: targets)
+            nverts = std::max(nverts, t.size());
+
+        auto moves = [&] (std::size_t t, std::size_t v) {
+            if (v >= targets[t].size())
+                return false;
+            auto const &dp = targets[t][v].deltaPosition, &dn = targets[t][v].deltaNormal;
+            return dp.x != 0 || dp.y != 0 || dp.z != 0 || dn.x != 0 || dn.y != 0 || dn.z != 0;
+        };
+        std::vector<int> counts(nverts);
+#pragma omp parallel for
+        for (intptr_t v = 0; v < (intptr_t)nverts; v++) {
+            for (std::size_t t = 0; t < targets.size(); t++)
+                counts[v] += moves(t, v);
+        }
+        bs->start.push_back(0);
+        for (std::size_t v = 0; v < nverts; v++) {
+            if (counts[v]) {
+                bs->verts.push_back(v);
+                bs->start.push_back(bs->start.back() + counts[v]);
+            }
+        }
+        bs->targets.resize(bs->start.back());
+        bs->deltaPositions.resize(bs->start.back());
+        bs->deltaNormals.resize(bs->start.back());
+#pragma omp parallel for
+        for (intptr_t k = 0; k < (intptr_t)bs->verts.size(); k++) {
+            int v = bs->verts[k], e = bs->start[k];
+            for (std::size_t t = 0; t < targets.size(); t++) {
+                if (!moves(t, v))
+                    continue;
+                auto const &dp = targets[t][v].deltaPosition, &dn = targets[t][v].deltaNormal;
+                bs->targets[e] = t;
+                bs->deltaPositions[e] = zeno::vec3f(dp.x, dp.y, dp.z);
+                bs->deltaNormals[e] = zeno::vec3f(dn.x, dn.y, dn.z);
+                e++;
+            }
+        }
+        return bs;
+    }
+};
+
 struct FBXData : zeno::IObjectClone<FBXData>{
     IMeshName iMeshName;
     IPathName iPathName;
@@ -646,6 +739,17 @@ struct FBXData : zeno::IObjectClone<FBXData>{
     std::shared_ptr<BoneTree> boneTree;
     std::shared_ptr<NodeTree> nodeTree;
     std::shared_ptr<AnimInfo> animInfo;
+
+    std::shared_ptr<SFBXSkin const> skin;
+    std::shared_ptr<SFBXBlendShapes const> blendShapes;   // of iMeshName.value_relName
+
+    // packs what every evaluation of the mesh shares, for the reader to call once
+    void compileMesh() {
+        skin = SFBXSkin::bind(iVertices.value);
+        blendShapes = nullptr;
+        if (auto it = iBlendSData.value.find(iMeshName.value_relName); it != iBlendSData.value.end())
+            blendShapes = SFBXBlendShapes::compile(it->first, it->second);
+    }
 };
 
 struct IFBXData : zeno::IObjectClone<IFBXData>{
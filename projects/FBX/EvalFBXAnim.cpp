@@ -7,6 +7,7 @@
 #include <zeno/types/DictObject.h>
 #include <zeno/types/CameraObject.h>
 #include <zeno/types/UserData.h>
+#include <zeno/types/SkinBindingObject.h>
 
 #include "assimp/scene.h"
 
@@ -21,6 +22,32 @@
 
 namespace {
 
+// adds the weighted deltas of all targets to the positions (scaled by deltaScale) and
+// normals of prim, each moved vertex summing its own deltas, so there are no write races
+void applyBlendShapes(SFBXBlendShapes const &bs, std::vector<float> const &weights,
+                      zeno::vec3f const &deltaScale, zeno::PrimitiveObject *prim) {
+    auto &nrm = prim->verts.attr<zeno::vec3f>("nrm");
+#pragma omp parallel for
+    for (intptr_t k = 0; k < (intptr_t)bs.verts.size(); k++) {
+        std::size_t v = bs.verts[k];
+        if (v >= prim->verts.size())
+            continue;
+        zeno::vec3f dp(0.0f), dn(0.0f);
+        for (int e = bs.start[k]; e < bs.start[k + 1]; e++) {
+            float w = weights[bs.targets[e]];
+            dp += bs.deltaPositions[e] * w;
+            dn += bs.deltaNormals[e] * w;
+        }
+        prim->verts[v] += dp * deltaScale;
+        if (dn[0] != 0 || dn[1] != 0 || dn[2] != 0) {
+            auto n = nrm[v] + dn;
+            float len = zeno::length(n);
+            if (len > 0)
+                nrm[v] = n / len;
+        }
+    }
+}
+
 struct EvalAnim{
     float m_CurrentFrame;
     float m_DeltaTime;
@@ -38,7 +65,8 @@ struct EvalAnim{
     std::unordered_map<std::string, SBoneOffset> m_BoneOffset;
     std::unordered_map<std::string, SAnimBone> m_AnimBones;
 
-    std::vector<SVertex> m_Vertices;
+    std::vector<SVertex> const *m_Vertices = nullptr;
+    std::shared_ptr<SFBXSkin const> m_Skin;
     std::vector<unsigned int> m_IndicesTris;
     std::vector<unsigned int> m_IndicesLoops;
     std::vector<zeno::vec2i> m_IndicesPolys;
@@ -51,7 +79,11 @@ struct EvalAnim{
                   std::shared_ptr<AnimInfo>& animInfo){
         m_animInfo = *animInfo;
 
-        m_Vertices = fbxData->iVertices.value;
+        m_Vertices = &fbxData->iVertices.value;
+        // the input belongs to the node upstream, bind a copy of our own when it comes without one
+        m_Skin = fbxData->skin;
+        if (!m_Skin || m_Skin->numVerts != m_Vertices->size())
+            m_Skin = SFBXSkin::bind(*m_Vertices);
         m_IndicesTris = fbxData->iIndices.valueTri;
         m_IndicesPolys = fbxData->iIndices.valuePolys;
         m_IndicesLoops = fbxData->iIndices.valueLoops;
@@ -135,8 +167,8 @@ struct EvalAnim{
     }
 
     void calculateMaxBoneInfluence(){
-        for(unsigned int i=0; i<m_Vertices.size(); i++) {
-            int s = m_Vertices[i].boneWeights.size();
+        for(unsigned int i=0; i<m_Vertices->size(); i++) {
+            int s = (*m_Vertices)[i].boneWeights.size();
             m_FbxData.jointIndices_elementSize = std::max(s, m_FbxData.jointIndices_elementSize);
         }
         //std::cout << "FBX: MaxJointInfluence " << m_FbxData.jointIndices_elementSize << std::endl;
@@ -349,64 +381,68 @@ struct EvalAnim{
             getPathTrans(pathName, pathTrans, tranType);
         }
 
-        for(unsigned int i=0; i<m_Vertices.size(); i++){
-            auto& bwe = m_Vertices[i].boneWeights;
-            auto& pos = m_Vertices[i].position;
-            auto& uvw = m_Vertices[i].texCoord;
-            auto& nor = m_Vertices[i].normal;
-            auto& vco = m_Vertices[i].vectexColor;
-
-//            auto& exi = m_Vertices[i].extraInfos;
-//            if(pathName == "/__path__") {
-//                getPathTrans(exi["path"], pathTrans, tranType);
-//            }
-
-            glm::vec4 tpos(0.0f, 0.0f, 0.0f, 0.0f);
-
-            bool boneInflued = false;
-            int bCount = 0;
-            // Influence
-            for(auto& b: bwe){
-                // e.g. b.first -> joint1
-                if(elemSize){
-                    float bIndex = (float)m_JointCorrespondingIndex[b.first];
-                    prim->verts.attr<float>("jointIndice_" + std::to_string(bCount)).push_back(bIndex);
-                    prim->verts.attr<float>("jointWeight_" + std::to_string(bCount)).push_back(b.second);
-                }
-                //std::cout << "FBX: Vert " << i << " name " << b.first << " bIndex " << bIndex << std::endl;
-                boneInflued = true;
-                auto& tr = m_BoneTransforms[b.first];
-                glm::mat4 trans = glm::mat4(tr.a1,tr.b1,tr.c1,tr.d1,
-                                            tr.a2,tr.b2,tr.c2,tr.d2,
-                                            tr.a3,tr.b3,tr.c3,tr.d3,
-                                            tr.a4,tr.b4,tr.c4,tr.d4);
-
-                glm::vec4 lpos = trans * glm::vec4(pos.x, pos.y, pos.z, 1.0f);
-
-                tpos += lpos * b.second;
-                bCount += 1;
-            }
+        auto const &vertices = *m_Vertices;
+        std::size_t nverts = vertices.size();
+        prim->verts.resize(nverts);
+        if(! isTris)
+            uvs.resize(nverts);
+#pragma omp parallel for
+        for(intptr_t i=0; i<(intptr_t)nverts; i++){
+            auto& pos = vertices[i].position;
+            auto& uvw = vertices[i].texCoord;
+            auto& nor = vertices[i].normal;
+            auto& vco = vertices[i].vectexColor;
+
+            ver[i] = zeno::vec3f(pos.x, pos.y, pos.z);
+            posb[i] = zeno::vec3f(0.0f, 0.0f, 0.0f);
+            uv[i] = zeno::vec3f(uvw.x, uvw.y, uvw.z);
+            norm[i] = zeno::vec3f(nor.x, nor.y, nor.z);
+            clr0[i] = zeno::vec3f(vco.r, vco.g, vco.b);
+            if(! isTris)
+                uvs[i] = zeno::vec2f(uvw.x, uvw.y);
+        }
 
-            // Supplement, joint index supplement 0, weight 0
-            for(int z=bCount; z<m_FbxData.jointIndices_elementSize; z++){
-                prim->verts.attr<float>("jointIndice_" + std::to_string(bCount)).push_back(0);
-                prim->verts.attr<float>("jointWeight_" + std::to_string(bCount)).push_back(0.0f);
+        // Influence, the binding was packed once for the mesh, only the bone matrices change per frame
+        auto const& binding = *m_Skin->binding;
+        std::vector<zeno::SkinBindingObject::Matrix> bones(m_Skin->bones.size());
+        for(std::size_t j=0; j<bones.size(); j++){
+            aiMatrix4x4 tr;
+            if(auto it = m_BoneTransforms.find(m_Skin->bones[j]); it != m_BoneTransforms.end())
+                tr = it->second;
+            bones[j] = {zeno::vec4f(tr.a1, tr.a2, tr.a3, tr.a4),
+                        zeno::vec4f(tr.b1, tr.b2, tr.b3, tr.b4),
+                        zeno::vec4f(tr.c1, tr.c2, tr.c3, tr.c4)};
+        }
+        zeno::skinDeform(binding, bones, m_evalOption.dualQuatSkinning, ver.data(),
+                         m_evalOption.skinNormals ? norm.data() : nullptr);
+
+        if(elemSize){
+            // joint index of each bone, missing ones supplemented as joint 0 like the unused slots
+            std::vector<float> jointIndex(m_Skin->bones.size());
+            for(std::size_t j=0; j<jointIndex.size(); j++)
+                jointIndex[j] = (float)m_JointCorrespondingIndex[m_Skin->bones[j]];
+            for(int k=0; k<std::min(elemSize, binding.width); k++){
+                auto& indAttr = prim->verts.attr<float>("jointIndice_" + std::to_string(k));
+                auto& wgtAttr = prim->verts.attr<float>("jointWeight_" + std::to_string(k));
+#pragma omp parallel for
+                for(intptr_t i=0; i<(intptr_t)nverts; i++){
+                    float w = binding.weights[i * binding.width + k];
+                    indAttr[i] = w > 0 ? jointIndex[binding.joints[i * binding.width + k]] : 0.0f;
+                    wgtAttr[i] = w;
+                }
             }
+        }
 
-            // TODO (Bone Influence) Skeleton + Transform
-            //  If remove follow `if`, we will get full transform animation, but the skel animation is gone
-            if(! boneInflued) {
-                tpos = pathTrans * glm::vec4(pos.x, pos.y, pos.z, 1.0f);
+        // TODO (Bone Influence) Skeleton + Transform
+        //  If bound vertices took the path transform too, we would get the full transform animation, but the skel animation is gone
+#pragma omp parallel for
+        for(intptr_t i=0; i<(intptr_t)nverts; i++){
+            glm::vec4 tpos = glm::vec4(ver[i][0], ver[i][1], ver[i][2], 1.0f);
+            if(! binding.isBound(i)) {
+                tpos = pathTrans * tpos;
+                tpos /= tpos.w;
             }
-
-            glm::vec3 fpos = glm::vec3(tpos.x/tpos.w, tpos.y/tpos.w, tpos.z/tpos.w);
-
-            ver.emplace_back(fpos.x * gscale, fpos.y * gscale, fpos.z * gscale);
-            posb.emplace_back(0.0f, 0.0f, 0.0f);
-            uvs.emplace_back(uvw.x, uvw.y, uvw.z);
-            uv.emplace_back(uvw.x, uvw.y, uvw.z);
-            norm.emplace_back(nor.x, nor.y, nor.z);
-            clr0.emplace_back(vco.r, vco.g, vco.b);
+            ver[i] = zeno::vec3f(tpos.x, tpos.y, tpos.z) * gscale;
         }
 
         if(isTris) {
@@ -434,9 +470,9 @@ struct EvalAnim{
                 unsigned int _i1 = trisInd[i][0];
                 unsigned int _i2 = trisInd[i][1];
                 unsigned int _i3 = trisInd[i][2];
-                uv0[i] = zeno::vec3f(m_Vertices[_i1].texCoord[0], m_Vertices[_i1].texCoord[1], 0);
-                uv1[i] = zeno::vec3f(m_Vertices[_i2].texCoord[0], m_Vertices[_i2].texCoord[1], 0);
-                uv2[i] = zeno::vec3f(m_Vertices[_i3].texCoord[0], m_Vertices[_i3].texCoord[1], 0);
+                uv0[i] = zeno::vec3f(vertices[_i1].texCoord[0], vertices[_i1].texCoord[1], 0);
+                uv1[i] = zeno::vec3f(vertices[_i2].texCoord[0], vertices[_i2].texCoord[1], 0);
+                uv2[i] = zeno::vec3f(vertices[_i3].texCoord[0], vertices[_i3].texCoord[1], 0);
             }
         }else{
             // Crash
@@ -491,6 +527,9 @@ struct EvalFBXAnim : zeno::INode {
         auto writeData = get_param<bool>("writeData");
         auto printAnimData = get_param<bool>("printAnimData");
         auto evalBlendShape = get_param<bool>("evalBlendShape");
+        auto outputBlendShapePrims = get_param<bool>("outputBlendShapePrims");
+        auto skinning = get_param<std::string>("skinning");
+        auto skinNormals = get_param<bool>("skinNormals");
 
         unit == "FROM_MAYA" ? evalOption.globalScale = 0.01f : evalOption.globalScale = 1.0f;
         interAnimData == "TRUE" ? evalOption.interAnimData = true : evalOption.interAnimData = false;
@@ -500,6 +539,8 @@ struct EvalFBXAnim : zeno::INode {
             evalOption.printAnimData = true;
         if(evalBlendShape)
             evalOption.evalBlendShape = true;
+        evalOption.dualQuatSkinning = skinning == "DQS";
+        evalOption.skinNormals = skinNormals;
 
         auto nodeTree = evalOption.interAnimData ? fbxData->nodeTree : get_input<NodeTree>("nodetree");
         auto boneTree = evalOption.interAnimData ? fbxData->boneTree : get_input<BoneTree>("bonetree");
@@ -569,82 +610,72 @@ struct EvalFBXAnim : zeno::INode {
         pathName->set(fbxData->iPathName.value);
         outMeshName->set(meshName);
 
-        auto bsValue = fbxData->iBlendSData.value;
+        auto const &bsValue = fbxData->iBlendSData.value;
         float gScale = evalOption.globalScale;
 
+        glm::mat4 pathTrans(1.0);
+        int tranType = -1;
+        if(! bsValue.empty())
+            anim.getPathTrans(fbxData->iPathName.value_oriPath, pathTrans, tranType);
+        // The deltas follow the scale of the path transform
+        auto pathTransScale = glm::vec3(glm::length(glm::vec3(pathTrans[0])),
+                                        glm::length(glm::vec3(pathTrans[1])),
+                                        glm::length(glm::vec3(pathTrans[2])));
+        zeno::vec3f deltaScale = zeno::vec3f(pathTransScale.x, pathTransScale.y, pathTransScale.z) * gScale;
+
         // XXX When the input data is single partten
 //        TIMER_START(BlendShapeCreate)
-        for(auto & [bsName, nameOfBlendShapes]: bsValue){
-            glm::mat4 pathTrans(1.0);
-            auto pathName = fbxData->iPathName.value_oriPath;
-            int tranType = -1;
-            anim.getPathTrans(pathName, pathTrans, tranType);
-
-            //std::cout << "BlendShape Key " << bsName << "\n";
-            for(int i=0; i< nameOfBlendShapes.size(); i++){
-                auto bsprim = std::make_shared<zeno::PrimitiveObject>();
-                auto &verAttr = bsprim->verts;
-                auto &indAttr = bsprim->tris;
-                auto &nrmAttr = bsprim->verts.add_attr<zeno::vec3f>("nrm");
-                auto &dnrmAttr = bsprim->verts.add_attr<zeno::vec3f>("dnrm");
-                auto &dposAttr = bsprim->verts.add_attr<zeno::vec3f>("dpos");
-                auto& blendShapeData = nameOfBlendShapes[i];
-                //std::cout << " BlendShape " << i << "\n";
-
-                auto pathTransScale = glm::vec3(glm::length(glm::vec3(pathTrans[0])),
-                                                glm::length(glm::vec3(pathTrans[1])),
-                                                glm::length(glm::vec3(pathTrans[2])));
-
-                for(unsigned int j=0; j<blendShapeData.size(); j++){ // Mesh Vert
-                    auto& vdata = blendShapeData[j];
-                    auto& pos = vdata.position;
-                    auto& nrm = vdata.normal;
-                    auto& dpos = vdata.deltaPosition;
-                    auto& dnrm = vdata.deltaNormal;
-
-                    // TODO BlendShape Normal Compute
-                    glm::vec4 adpos = glm::vec4(pathTransScale, 1.0f) * glm::vec4(dpos.x, dpos.y, dpos.z, 1.0f);
-                    dpos = aiVector3D(adpos.x/adpos.w, adpos.y/adpos.w, adpos.z/adpos.w);
-
-                    verAttr.emplace_back(pos.x * gScale, pos.y * gScale, pos.z * gScale);
-                    nrmAttr.emplace_back(nrm.x, nrm.y, nrm.z);
-                    dposAttr.emplace_back(adpos.x * gScale, adpos.y * gScale, adpos.z * gScale);
-                    dnrmAttr.emplace_back(dnrm.x, dnrm.y, dnrm.z);
-                }
+        if(outputBlendShapePrims){
+            for(auto & [bsName, nameOfBlendShapes]: bsValue){
+                //std::cout << "BlendShape Key " << bsName << "\n";
+                for(auto& blendShapeData: nameOfBlendShapes){
+                    auto bsprim = std::make_shared<zeno::PrimitiveObject>();
+                    auto &verAttr = bsprim->verts;
+                    auto &nrmAttr = bsprim->verts.add_attr<zeno::vec3f>("nrm");
+                    auto &dnrmAttr = bsprim->verts.add_attr<zeno::vec3f>("dnrm");
+                    auto &dposAttr = bsprim->verts.add_attr<zeno::vec3f>("dpos");
+                    verAttr.resize(blendShapeData.size());
+
+#pragma omp parallel for
+                    for(intptr_t j=0; j<(intptr_t)blendShapeData.size(); j++){ // Mesh Vert
+                        auto& vdata = blendShapeData[j];
+                        auto& pos = vdata.position;
+                        auto& nrm = vdata.normal;
+                        auto& dpos = vdata.deltaPosition;
+                        auto& dnrm = vdata.deltaNormal;
+
+                        // TODO BlendShape Normal Compute
+                        verAttr[j] = zeno::vec3f(pos.x, pos.y, pos.z) * gScale;
+                        nrmAttr[j] = zeno::vec3f(nrm.x, nrm.y, nrm.z);
+                        dposAttr[j] = zeno::vec3f(dpos.x, dpos.y, dpos.z) * deltaScale;
+                        dnrmAttr[j] = zeno::vec3f(dnrm.x, dnrm.y, dnrm.z);
+                    }
 
-                bsPrimsOrigin->arr.emplace_back(bsprim);
+                    bsPrimsOrigin->arr.emplace_back(bsprim);
+                }
             }
         }
 //        TIMER_END(BlendShapeCreate)
 
 //        TIMER_START(BlendShapeEval)
         // TODO FBXData Write BlendShape
-        if(bsValue.find(meshName) != bsValue.end()){
-            if(fbxData->iKeyMorph.value.find(meshName) != fbxData->iKeyMorph.value.end()){
-
-                auto blendShapeData = bsValue[meshName];
-                auto keyMorphs = fbxData->iKeyMorph.value[meshName];
-
-                unsigned int kstart = 0;
-                unsigned int kend;
-                bool found = false;
-                for(unsigned int i=0; i<keyMorphs.size()-1; i++){
-                    //std::cout << " i " << i << " " << keyMorphs[i+1].m_Time << " current " << anim.m_CurrentFrame << "\n";
-                    if(anim.m_CurrentFrame <= keyMorphs[i+1].m_Time){
-                        kstart = i;
-                        found = true;
-                        break;
-                    }
-                }
-                kend = kstart+1;
-                if(! found){
-                    kstart = keyMorphs.size()-2;
-                    kend = kstart+1;
-                }
+        auto bsIt = bsValue.find(meshName);
+        if(bsIt != bsValue.end()){
+            auto morphIt = fbxData->iKeyMorph.value.find(meshName);
+            if(morphIt != fbxData->iKeyMorph.value.end() && ! morphIt->second.empty()){
+
+                auto& blendShapeData = bsIt->second;
+                auto& keyMorphs = morphIt->second;
+
+                // The first key at or after the current frame ends the pair, past the last key the last pair is used
+                auto kit = std::lower_bound(keyMorphs.begin() + 1, keyMorphs.end(), (double)anim.m_CurrentFrame,
+                                            [](SKeyMorph const& k, double t){ return k.m_Time < t; });
+                std::size_t kend = std::min<std::size_t>(kit - keyMorphs.begin(), keyMorphs.size() - 1);
+                std::size_t kstart = kend ? kend - 1 : 0;
 
                 auto& kdstart = keyMorphs[kstart];
                 auto& kdend = keyMorphs[kend];
-                float factor = (anim.m_CurrentFrame - kdstart.m_Time) / (kdend.m_Time - kdstart.m_Time);
+                float factor = kdend.m_Time > kdstart.m_Time ? (anim.m_CurrentFrame - kdstart.m_Time) / (kdend.m_Time - kdstart.m_Time) : 0.0f;
                 std::cout << "Eval BlendShape " << meshName << " Factor " << factor << "\n";
                 std::cout << "Eval BlendShape Index " << kstart << " " << kend << "\n";
                 std::cout << "Eval BlendShape Time " << kdstart.m_Time << " " << kdend.m_Time << " " << anim.m_CurrentFrame << "\n";
@@ -656,36 +687,45 @@ struct EvalFBXAnim : zeno::INode {
                     factor = 1.0;
                 }
 
+                std::vector<float> weights(blendShapeData.size());
                 for(unsigned int i=0; i<blendShapeData.size(); i++){ // Anim Mesh & Same as BlendShape WeightsAndValues
-                    auto bsprim = std::make_shared<zeno::PrimitiveObject>();
-                    auto &verAttr = bsprim->verts;
-                    auto &nrmAttr = bsprim->verts.add_attr<zeno::vec3f>("nrm");
-                    auto &norb = bsprim->verts.add_attr<zeno::vec3f>("nrmb");
-                    auto &posb = bsprim->verts.add_attr<zeno::vec3f>("posb");
-                    auto &bsw = bsprim->verts.add_attr<float>("bsw");
-                    double w = kdstart.m_Weights[i] * (1.0f - factor) + kdend.m_Weights[i] * factor;
-                    auto& bsdata = blendShapeData[i];
-                    for(unsigned int j=0; j<bsdata.size(); j++){
-                        auto& pos = bsdata[j].position;
-                        auto& nrm = bsdata[j].normal;
-                        auto& dpos = bsdata[j].deltaPosition;
-                        auto& dnor = bsdata[j].deltaNormal;
-
-                        verAttr.emplace_back(pos.x * gScale, pos.y * gScale, pos.z * gScale);
-                        nrmAttr.emplace_back(nrm.x, nrm.y, nrm.z);
-                        posb.emplace_back(dpos.x * gScale, dpos.y * gScale, dpos.z * gScale);
-                        norb.emplace_back(dnor.x, dnor.y, dnor.z);
-                        bsw.emplace_back((float)w);
-                    }
+                    weights[i] = kdstart.m_Weights[i] * (1.0f - factor) + kdend.m_Weights[i] * factor;
+                }
 
-                    if(evalBlendShape){
-                        for(unsigned int j=0; j<bsdata.size(); j++) {
-                            //std::cout << " " << j << " " << posb[j][0] << ","<<posb[j][1] <<","<<posb[j][2] << " - " << w << "\n";
-                            prim->verts[j] = prim->verts[j] + posb[j] * w;
+                if(outputBlendShapePrims){
+                    for(unsigned int i=0; i<blendShapeData.size(); i++){
+                        auto bsprim = std::make_shared<zeno::PrimitiveObject>();
+                        auto &verAttr = bsprim->verts;
+                        auto &nrmAttr = bsprim->verts.add_attr<zeno::vec3f>("nrm");
+                        auto &norb = bsprim->verts.add_attr<zeno::vec3f>("nrmb");
+                        auto &posb = bsprim->verts.add_attr<zeno::vec3f>("posb");
+                        auto &bsw = bsprim->verts.add_attr<float>("bsw");
+                        auto& bsdata = blendShapeData[i];
+                        verAttr.resize(bsdata.size());
+#pragma omp parallel for
+                        for(intptr_t j=0; j<(intptr_t)bsdata.size(); j++){
+                            auto& pos = bsdata[j].position;
+                            auto& nrm = bsdata[j].normal;
+                            auto& dpos = bsdata[j].deltaPosition;
+                            auto& dnor = bsdata[j].deltaNormal;
+
+                            verAttr[j] = zeno::vec3f(pos.x, pos.y, pos.z) * gScale;
+                            nrmAttr[j] = zeno::vec3f(nrm.x, nrm.y, nrm.z);
+                            posb[j] = zeno::vec3f(dpos.x, dpos.y, dpos.z) * deltaScale;
+                            norb[j] = zeno::vec3f(dnor.x, dnor.y, dnor.z);
+                            bsw[j] = weights[i];
                         }
+                        bsPrims->arr.emplace_back(bsprim);
                     }
+                }
 
-                    bsPrims->arr.emplace_back(bsprim);
+                // All targets at once from their nonzero deltas, compiled by the reader with the mesh data
+                if(evalBlendShape){
+                    auto blendShapes = fbxData->blendShapes;
+                    if(! blendShapes || blendShapes->meshName != meshName
+                        || blendShapes->numTargets != blendShapeData.size())
+                        blendShapes = SFBXBlendShapes::compile(meshName, blendShapeData);
+                    applyBlendShapes(*blendShapes, weights, deltaScale, prim.get());
                 }
             }else{
                 std::cout << "BlendShape NotFound MorphKey " << meshName << "\n";
@@ -732,6 +772,9 @@ ZENDEFNODE(EvalFBXAnim,
                    {"bool", "writeData", "false"},
                    {"bool", "printAnimData", "false"},
                    {"bool", "evalBlendShape", "true"},
+                   {"bool", "outputBlendShapePrims", "true"},
+                   {"enum LBS DQS", "skinning", "LBS"},
+                   {"bool", "skinNormals", "false"},
                },  /* category: */
                {
                    "FBX",
@@ -833,6 +833,7 @@ struct Mesh{
             sub_data->iPathTrans = piecePathTrans;
             sub_data->iKeyMorph.value = morph;
             sub_data->iMeshInfo.value_corsName = m_MeshCorsName;
+            sub_data->compileMesh();
 
             sub_data->boneTree = boneTree;
             sub_data->nodeTree = nodeTree;
@@ -1117,6 +1118,7 @@ void readFBXFile(
         data->animInfo = animInfo;
         data->boneTree = boneTree;
         data->nodeTree = nodeTree;
+        data->compileMesh();
     }
 
     if(readOption.makePrim){
@@ -116,6 +116,22 @@ struct FEMIntegrator : zeno::IObject {
 
     SpMat _connMatrix;
 
+    // elements grouped by colour, no two elements of a colour share a vertex: a colour is
+    // assembled in parallel without atomics, and with the colours taken one after another
+    // every entry sums its terms in the same order on every run
+    std::vector<int> _elmColorOffsets;
+    std::vector<int> _elmsByColor;
+
+    // linear solvers kept across Newton iterations and frames, the symbolic analysis of
+    // the LDLT is done once per connectivity pattern and only the numeric part redone;
+    // CG runs on the row major view of the Hessian, as Eigen only multithreads the SpMV of
+    // row major matrices
+    using SpMatRowMajor = Eigen::SparseMatrix<SPMAT_SCALER,Eigen::RowMajor>;
+    Eigen::SimplicialLDLT<SpMat> _LDLTSolver;
+    bool _patternAnalyzed = false;
+    Eigen::ConjugateGradient<SpMatRowMajor,Eigen::Lower|Eigen::Upper> _CGSolver;
+    VecXd _CGWarmStart;
+
     size_t _stepID;
 
     // initialize all the element-wise attributes by interpolating corresponding vertex-wise attributes, 
@@ -153,6 +169,9 @@ struct FEMIntegrator : zeno::IObject {
         _connMatrix = SpMat(prim->size() * 3,prim->size() * 3);
         _connMatrix.setFromTriplets(connTriplets.begin(),connTriplets.end());
         _connMatrix.makeCompressed();
+        _patternAnalyzed = false;
+        _CGWarmStart.resize(0);
+        ColorElements(prim->quads.values,prim->size());
 
         // _elmVolume.resize(nm_elms);
         _elmdFdx.resize(nm_elms);
@@ -554,21 +573,11 @@ struct FEMIntegrator : zeno::IObject {
             // }
 
 
-            deriv.setZero();
-            HValBuffer.setZero();
-
-            // std::cout << "SIZE_OF_H_MATRIX : " << HValBuffer.size() << std::endl;
-
-            // std::cout << "ASSEMBLE_HERE" << std::endl;
-            for(size_t elm_id = 0;elm_id < nm_elms;++elm_id){
-                auto tet = shape->quads[elm_id];
+            for(size_t elm_id = 0;elm_id < nm_elms;++elm_id)
                 obj += objBuffer[elm_id];
-                // std::cout << "ASSEMBLE_ELM_VECTOR" << std::endl;
-                AssembleElmVector(tet,derivBuffer[elm_id],deriv);
-                // std::cout << "ASSEMBLE_ELM_MATRIX" << std::endl;
-                AssembleElmMatrixAdd(tet,HBuffer[elm_id],MatHelper::MapHMatrixRef(shape->size(),_connMatrix,HValBuffer.data()));
-                // std::cout << "FINISH ASSEMBLING" << std::endl;
-            }
+
+            AssembleElmVectors(shape->quads.values,derivBuffer,deriv);
+            AssembleElmMatrices(shape->quads.values,HBuffer,HValBuffer);
 
             // auto tet = shape->quads[11221];
             // std::cout << "g1:\n" <<  
@@ -590,68 +599,70 @@ struct FEMIntegrator : zeno::IObject {
 
 
 
-    void AssembleElmVectors(const std::vector<zeno::vec4i>& elms,const std::vector<Vec12d>& elm_vecs,VecXd& global_vec) const {
-        auto atomicCas = [](int64_t* dest,int64_t expected,int64_t desired) {
-#if defined(_MSC_VER)
-            return InterlockedCompareExchange64(dest, desired, expected);   // (__int64 *)
-#else
-            __atomic_compare_exchange_n(const_cast<int64_t volatile *>(dest),&expected,desired,false,__ATOMIC_ACQ_REL,__ATOMIC_RELAXED);
-            return expected;
-#endif
-        };
-        auto atomicDoubleAdd = [&atomicCas](double*dst, double val) {
-            static_assert(sizeof(double) == sizeof(int64_t), "sizeof float != sizeof int");
-            int64_t oldVal = reinterpret_bits<int64_t>(*dst);
-            int64_t newVal = reinterpret_bits<int64_t>(reinterpret_bits<double>(oldVal) + val), readVal{};
-            while ((readVal = atomicCas((int64_t*)dst, oldVal, newVal)) != oldVal) {
-                oldVal = readVal;
-                newVal = reinterpret_bits<int64_t>(reinterpret_bits<double>(readVal) + val);
+    // greedy colouring in element order, each element takes the first colour none of the
+    // elements around its vertices has
+    void ColorElements(const std::vector<zeno::vec4i>& elms,size_t nm_verts) {
+        std::vector<std::vector<uint64_t>> used(nm_verts);  // one bit per colour taken at a vertex
+        std::vector<int> color(elms.size());
+        int nm_colors = 0;
+        for(size_t elm_id = 0;elm_id < elms.size();++elm_id){
+            const auto& elm = elms[elm_id];
+            int c = 0;
+            for(size_t w = 0;;++w){
+                uint64_t taken = 0;
+                for(size_t i = 0;i < 4;++i)
+                    if(w < used[elm[i]].size())
+                        taken |= used[elm[i]][w];
+                if(~taken){
+                    int b = 0;
+                    while(taken >> b & 1)
+                        ++b;
+                    c = w * 64 + b;
+                    break;
+                }
+            }
+            for(size_t i = 0;i < 4;++i){
+                auto& mask = used[elm[i]];
+                if(mask.size() <= c / 64)
+                    mask.resize(c / 64 + 1);
+                mask[c / 64] |= uint64_t(1) << (c % 64);
             }
-            return reinterpret_bits<double>(oldVal);
-        };
+            color[elm_id] = c;
+            nm_colors = std::max(nm_colors,c + 1);
+        }
 
-        global_vec.setZero();
+        _elmColorOffsets.assign(nm_colors + 1,0);
+        for(auto c : color)
+            ++_elmColorOffsets[c + 1];
+        for(int c = 0;c < nm_colors;++c)
+            _elmColorOffsets[c + 1] += _elmColorOffsets[c];
+        _elmsByColor.resize(elms.size());
+        std::vector<int> cursor(_elmColorOffsets.begin(),_elmColorOffsets.end() - 1);
+        for(size_t elm_id = 0;elm_id < elms.size();++elm_id)
+            _elmsByColor[cursor[color[elm_id]]++] = elm_id;
+    }
 
-        // #pragma omp parallel for
-        // for(size_t i = 0;i < elms.size()*12;++i){
-        //     size_t elm_id = i / 12;
-        //     const auto& elm = elms[elm_id];
-        //     auto v_id = elm[(i%12)/3];
-        //     auto d_id = (i % 12) % 3;
-        //     auto val = elm_vecs[elm_id][i % 12];
-        //     atomicDoubleAdd(&global_vec.data()[v_id * 3 + d_id],val);
-        // }
-
-#if 0
-        #pragma omp parallel for
-        for(size_t i = 0;i < elms.size();++i){
-            size_t elm_id = i;
-            const auto& elm = elms[elm_id];
-            for(size_t j = 0;j < 12;++j){
-                auto v_id = elm[j/3];
-                auto d_id = j % 3;
-                auto val = elm_vecs[elm_id][j];
-                atomicDoubleAdd(&global_vec.data()[v_id * 3 + d_id],val);
-            }
+    // calls f on every element, the elements of a colour in parallel and the colours in
+    // order; serially in element order when the colouring is not of these elements
+    template<typename F>
+    void ForEachElmByColor(size_t nm_elms,F&& f) const {
+        if(_elmColorOffsets.empty() || (size_t)_elmColorOffsets.back() != nm_elms){
+            for(size_t elm_id = 0;elm_id < nm_elms;++elm_id)
+                f(elm_id);
+            return;
         }
-#else
-        constexpr int seg = 8;
-        const auto nseg = (elms.size() + seg - 1) / seg;
-        #pragma omp parallel for
-        for(auto ii = 0;ii < nseg;++ii)
-        for(size_t k = 0; k != seg; ++k) {
-            size_t elm_id = ii * seg + k;
-            if (elm_id >= elms.size()) break;
-            const auto& elm = elms[elm_id];
-            for(size_t j = 0;j != 12;++j){
-                auto v_id = elm[j/3];
-                auto d_id = j % 3;
-                auto val = elm_vecs[elm_id][j];
-                atomicDoubleAdd(&global_vec.data()[v_id * 3 + d_id],val);
-            }
+        for(size_t c = 0;c + 1 < _elmColorOffsets.size();++c){
+            #pragma omp parallel for
+            for(intptr_t k = _elmColorOffsets[c];k < _elmColorOffsets[c + 1];++k)
+                f(_elmsByColor[k]);
         }
-#endif
+    }
 
+    void AssembleElmVectors(const std::vector<zeno::vec4i>& elms,const std::vector<Vec12d>& elm_vecs,VecXd& global_vec) const {
+        global_vec.setZero();
+        ForEachElmByColor(elms.size(),[&](size_t elm_id){
+            AssembleElmVector(elms[elm_id],elm_vecs[elm_id],global_vec);
+        });
     }
 
     void AssembleElmVector(const zeno::vec4i& elm,const Vec12d& elm_vec,VecXd& global_vec) const{
@@ -662,6 +673,58 @@ struct FEMIntegrator : zeno::IObject {
             // shape->verts[elm[i]] += zeno::vec3f(elm_vec[i*3 + 0],elm_vec[i*3 + 1],elm_vec[i*3 + 2]);
     }
 
+    // accumulate the element Hessians into the values of _connMatrix's pattern, colour by
+    // colour; the 3x3 block of a vertex pair takes three consecutive entries of each of its
+    // columns, so one search per column locates it
+    void AssembleElmMatrices(const std::vector<zeno::vec4i>& elms,const std::vector<Mat12x12d>& elm_Hs,VecXd& HValBuffer) const {
+        HValBuffer.setZero();
+        const auto* outer = _connMatrix.outerIndexPtr();
+        const auto* inner = _connMatrix.innerIndexPtr();
+        double* values = HValBuffer.data();
+
+        ForEachElmByColor(elms.size(),[&](size_t elm_id){
+            const auto& elm = elms[elm_id];
+            const auto& elm_H = elm_Hs[elm_id];
+            for(size_t j = 0;j < 4;++j)
+                for(size_t c = 0;c < 3;++c){
+                    auto col = elm[j] * 3 + c;
+                    for(size_t i = 0;i < 4;++i){
+                        auto slot = std::lower_bound(inner + outer[col],inner + outer[col + 1],elm[i] * 3) - inner;
+                        for(size_t r = 0;r < 3;++r)
+                            values[slot + r] += elm_H(i * 3 + r,j * 3 + c);
+                    }
+                }
+        });
+    }
+
+    // solve H x = b for the Newton step, with the factorization reused across calls or with
+    // Jacobi preconditioned CG warm started from the previous step; false when it fails
+    bool SolveNewtonStep(size_t nm_verts,VecXd& HValBuffer,const VecXd& b,VecXd& x,bool use_cg,FEM_Scaler cg_tol) {
+        auto H = MatHelper::MapHMatrix(nm_verts,_connMatrix,HValBuffer.data());
+        if(use_cg){
+            if(_CGWarmStart.size() != b.size())
+                _CGWarmStart.setZero(b.size());
+            // H is symmetric, so its column major arrays read as row major give it back
+            // without a copy
+            Eigen::Map<const SpMatRowMajor> HRowMajor(H.rows(),H.cols(),H.nonZeros(),
+                H.outerIndexPtr(),H.innerIndexPtr(),H.valuePtr());
+            _CGSolver.setTolerance(cg_tol);
+            _CGSolver.compute(HRowMajor);
+            x = _CGSolver.solveWithGuess(b,_CGWarmStart);
+            _CGWarmStart = x;
+            return _CGSolver.info() == Eigen::Success;
+        }
+        if(!_patternAnalyzed){
+            _LDLTSolver.analyzePattern(H);
+            _patternAnalyzed = true;
+        }
+        _LDLTSolver.factorize(H);
+        if(_LDLTSolver.info() != Eigen::Success)
+            return false;
+        x = _LDLTSolver.solve(b);
+        return true;
+    }
+
     void AssembleElmMatrixAdd(const zeno::vec4i& elm,const Mat12x12d& elm_H,Eigen::Map<SpMat> H) const{
         for(size_t i = 0;i < 4;++i) {
             for(size_t j = 0;j < 4;++j)
@@ -388,9 +388,6 @@ ZENDEFNODE(SolveFEMFast,{
 struct SolveFEM : zeno::INode {
     virtual void apply() override {
         // std::cout << "BEGIN SOLVER " << std::endl;
-        Eigen::SparseLU<SpMat> _LUSolver;
-        Eigen::SimplicialLDLT<SpMat> _LDLTSolver;
-
         auto integrator = get_input<FEMIntegrator>("integrator");
         auto shape = get_input<PrimitiveObject>("shape");
         auto elmView = get_input<PrimitiveObject>("elmView");
@@ -409,6 +406,8 @@ struct SolveFEM : zeno::INode {
         auto c2 = get_input2<float>("CurvatureCoeff");
         auto beta = get_input2<float>("BTL_shrinkingRate");
         auto epsilon = get_input2<float>("epsilon");
+        auto use_cg = get_input2<std::string>("linearSolver") == "PCG";
+        auto cg_tol = get_input2<float>("cgTolerance");
 
         std::vector<Vec2d> wolfeBuffer;
         wolfeBuffer.resize(max_linesearch);
@@ -515,8 +514,8 @@ struct SolveFEM : zeno::INode {
             r *= -1;
 
             clock_t begin_solve = clock();
-            _LDLTSolver.compute(MatHelper::MapHMatrix(shape->size(),integrator->_connMatrix,HBuffer.data()));
-            dp = _LDLTSolver.solve(r);
+            if(!integrator->SolveNewtonStep(shape->size(),HBuffer,r,dp,use_cg,cg_tol))
+                throw std::runtime_error("FAIL TO SOLVE THE NEWTON STEP");
             clock_t end_solve = clock();
 
             // std::cout << "INTERNAL SIZE : " << r.norm() << "\t" << dp.norm() << HBuffer.norm() << std::endl;
@@ -585,7 +584,7 @@ struct SolveFEM : zeno::INode {
 ZENDEFNODE(SolveFEM,{
     {"integrator","shape","elmView","skin",{"int","maxNRIters","10"},{"int","maxBTLs","10"},{"float","ArmijoCoeff","0.01"},
         {"float","CurvatureCoeff","0.9"},{"float","BTL_shrinkingRate","0.5"},
-        {"float","epsilon","1e-8"}
+        {"float","epsilon","1e-8"},{"enum LDLT PCG","linearSolver","LDLT"},{"float","cgTolerance","1e-6"}
     },
     {"shape"},
     {},
@@ -1,4 +1,5 @@
 #include "declares.h"
+#include <zeno/funcs/PrimitiveUtils.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtx/transform.hpp>
@@ -263,187 +264,24 @@ ZENDEFNODE(AssignUniformAffineToPrim,{
 
 
 struct EmbedPrimitiveToVolumeMesh : zeno::INode {
-    FEM_Scaler ComputeDistToTriangle(const Vec3d& vp,const Vec3d& v0,const Vec3d& v1,const Vec3d& v2){
-        auto v012 = (v0 + v1 + v2) / 3;
-        auto v01 = (v0 + v1) / 2;
-        auto v02 = (v0 + v2) / 2;
-        auto v12 = (v1 + v2) / 2;
-
-        FEM_Scaler dist = 1e6;
-        FEM_Scaler tdist = (v012 - vp).norm();
-        dist = tdist < dist ? tdist : dist;
-        tdist = (v01 - vp).norm();
-        dist = tdist < dist ? tdist : dist;
-        tdist = (v02 - vp).norm();
-        dist = tdist < dist ? tdist : dist;
-        tdist = (v12 - vp).norm();
-        dist = tdist < dist ? tdist : dist;
-
-        tdist = (v0 - vp).norm();
-        dist = tdist < dist ? tdist : dist;
-        tdist = (v1 - vp).norm();
-        dist = tdist < dist ? tdist : dist;
-        tdist = (v2 - vp).norm();
-        dist = tdist < dist ? tdist : dist;
-
-        return dist;
-    }
-
     virtual void apply() override {
         auto prim = get_input<zeno::PrimitiveObject>("prim");
         auto vmesh = get_input<zeno::PrimitiveObject>("vmesh");
 
         auto& embed_id = prim->add_attr<float>("embed_id");
-        // embed_id.resize(prim->size(),-1);
-        // std::cout << "CHECK:" << embed_id[10641] << std::endl;
         auto& elm_w = prim->add_attr<zeno::vec3f>("embed_w");
 
         auto fitting_in = (int)get_input<zeno::NumericObject>("fitting_in")->get<float>();
-        // elm_w.resize(prim->size(),zeno::vec3f(0));
-
-        // auto& v0s = prim->add_attr<zeno::vec3f>("v0");
-        // auto& v1s = prim->add_attr<zeno::vec3f>("v1");
-        // auto& v2s = prim->add_attr<zeno::vec3f>("v2");
-        // auto& v3s = prim->add_attr<zeno::vec3f>("v3");
-        // prim->resize(prim->size());
 
-        // std::cout << "CHECK:" << embed_id[10641] << std::endl;
+        // vertices outside the volume are fitted onto their nearest tet
+        std::vector<int> tet_ids;
+        std::vector<zeno::vec4f> tet_ws;
+        zeno::primTetEmbed(vmesh.get(), prim->verts.values, tet_ids, tet_ws, fitting_in);
 
         #pragma omp parallel for
-        for(auto i = 0;i < prim->size();++i){
-            auto vp = Vec3d(prim->verts[i][0],prim->verts[i][1],prim->verts[i][2]);
-            embed_id[i] = -1;
-
-            FEM_Scaler closest_dist = 1e6;
-            int closest_tet_id;
-            Vec4d closest_tet_w;
-
-            for(size_t j = 0;j < vmesh->quads.size();++j){
-                const auto& tet = vmesh->quads[j];
-                Vec3d v0 = Vec3d(vmesh->verts[tet[0]][0],vmesh->verts[tet[0]][1],vmesh->verts[tet[0]][2]);
-                Vec3d v1 = Vec3d(vmesh->verts[tet[1]][0],vmesh->verts[tet[1]][1],vmesh->verts[tet[1]][2]);
-                Vec3d v2 = Vec3d(vmesh->verts[tet[2]][0],vmesh->verts[tet[2]][1],vmesh->verts[tet[2]][2]);
-                Vec3d v3 = Vec3d(vmesh->verts[tet[3]][0],vmesh->verts[tet[3]][1],vmesh->verts[tet[3]][2]);
-
-                Mat4x4d M;
-                M.col(0) << v0,1.0;
-                M.col(1) << v1,1.0;
-                M.col(2) << v2,1.0;
-                M.col(3) << v3,1.0;
-
-
-                auto VMT = M.determinant();
-
-                M.col(0) << vp,1.0;
-                M.col(1) << v1,1.0;
-                M.col(2) << v2,1.0;
-                M.col(3) << v3,1.0;
-
-                auto VM0 = M.determinant();
-
-                M.col(0) << v0,1.0;
-                M.col(1) << vp,1.0; 
-                M.col(2) << v2,1.0;
-                M.col(3) << v3,1.0;
-
-                auto VM1 = M.determinant();
-
-                M.col(0) << v0,1.0;
-                M.col(1) << v1,1.0;
-                M.col(2) << vp,1.0;
-                M.col(3) << v3,1.0;
-
-                auto VM2 = M.determinant();
-
-                M.col(0) << v0,1.0;
-                M.col(1) << v1,1.0;
-                M.col(2) << v2,1.0;
-                M.col(3) << vp,1.0;
-
-                auto VM3 = M.determinant();
-
-                Vec4d w = Vec4d(VM0 / VMT,VM1 / VMT,VM2 / VMT,VM3 / VMT);
-
-                if(w[0] > 0 && w[1] > 0 && w[2] > 0 && w[3] > 0){
-                    embed_id[i] = (float)j;
-                    elm_w[i][0] = w[0];
-                    elm_w[i][1] = w[1];
-                    elm_w[i][2] = w[2];
-                    if(fabs(1 - w[0] - w[1] - w[2] - w[3]) > 1e-6){
-                        std::cout << "INVALID : " << i << "\t" << j << "\t" << w.transpose() << std::endl;
-                        // throw std::runtime_error("INVALID W");
-                    }
-
-                    Vec3d interpPos = w[0] * v0 + w[1] * v1 + w[2] * v2 + w[3] * v3;
-                    FEM_Scaler interpError = (interpPos - vp).norm();
-                    if(interpError > 1e-6){
-                        std::cout << "INTERP ERROR : " << interpError << "\t" << interpPos.transpose() << "\t" << vp.transpose() << std::endl;
-                    }
-                    prim->verts[i] = zeno::vec3f(interpPos[0],interpPos[1],interpPos[2]);
-                    // v0s[i] = zeno::vec3f(v0[0],v0[1],v0[2]);
-                    // v1s[i] = zeno::vec3f(v1[0],v1[1],v1[2]);
-                    // v2s[i] = zeno::vec3f(v2[0],v2[1],v2[2]);
-                    // v3s[i] = zeno::vec3f(v3[0],v3[1],v3[2]);
-                    
-                    // if(i == 10641){
-                    //     std::cout << "FIND : " << i << "\t" << j << std::endl;
-                    // }
-                    // std::cout << "FIND : " << i << "\t" << j << "\t" << w0 << "\t" << w1 << "\t" << w2 << "\t" << w3 << std::endl;
-                    break;
-                }
-
-                if(w[0] < 0){
-                    FEM_Scaler dist = ComputeDistToTriangle(vp,v1,v2,v3);
-                    if(dist < closest_dist){
-                        closest_dist = dist;
-                        closest_tet_id = j;
-                        closest_tet_w = w;
-                    }
-                }
-
-                if(w[1] < 0){
-                    FEM_Scaler dist = ComputeDistToTriangle(vp,v0,v2,v3);
-                    if(dist < closest_dist){
-                        closest_dist = dist;
-                        closest_tet_id = j;
-                        closest_tet_w = w;
-                    }
-                }
-
-                if(w[2] < 0){
-                    FEM_Scaler dist = ComputeDistToTriangle(vp,v0,v1,v3);
-                    if(dist < closest_dist){
-                        closest_dist = dist;
-                        closest_tet_id = j;
-                        closest_tet_w = w;
-                    }
-                }
-
-                if(w[3] < 0){
-                    FEM_Scaler dist = ComputeDistToTriangle(vp,v0,v1,v2);
-                    if(dist < closest_dist){
-                        closest_dist = dist;
-                        closest_tet_id = j;
-                        closest_tet_w = w;
-                    }
-                }
-            }
-
-
-            if(embed_id[i] < -1e-3 && fitting_in) {
-
-
-                embed_id[i] = closest_tet_id;
-                for(size_t i = 0;i < 4;++i)
-                    closest_tet_w[i] = closest_tet_w[i] < 0 ? 0 : closest_tet_w[i];
-                FEM_Scaler wsum = closest_tet_w.sum();
-                closest_tet_w /= wsum;
-
-                elm_w[i] = zeno::vec3f(closest_tet_w[0],closest_tet_w[1],closest_tet_w[2]);
-
-
-                // std::cout << "CORRECT ID : " << i << "\t" << closest_tet_id << "\t" << closest_tet_w.transpose() << std::endl;
-            }
+        for(intptr_t i = 0;i < (intptr_t)prim->size();++i){
+            embed_id[i] = (float)tet_ids[i];
+            elm_w[i] = zeno::vec3f(tet_ws[i][0],tet_ws[i][1],tet_ws[i][2]);
         }
 
         for(size_t i = 0;i < embed_id.size();++i){
@@ -453,8 +291,6 @@ struct EmbedPrimitiveToVolumeMesh : zeno::INode {
             }
         }
 
-        // std::cout << "CHECK_ID:" << embed_id[10641] << std::endl;
-
         set_output("prim",prim);
     }
 };
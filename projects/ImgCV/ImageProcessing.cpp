@@ -12,6 +12,7 @@
 #include <cmath>
 #include <zeno/utils/log.h>
 #include <opencv2/opencv.hpp>
+#include "imgcv.h"
 
 namespace zeno {
 
@@ -406,16 +407,11 @@ ZENDEFNODE(ImageFlip, {
 struct ImageRGB2HSV : INode {
     virtual void apply() override {
         auto image = get_input<PrimitiveObject>("image");
-        float H = 0, S = 0, V = 0;
-        for (auto i = 0; i < image->verts.size(); i++){
-            float R = image->verts[i][0];
-            float G = image->verts[i][1];
-            float B = image->verts[i][2];
-            zeno::RGBtoHSV(R, G, B, H, S, V);
-            image->verts[i][0]= H;
-            image->verts[i][1]= S;
-            image->verts[i][2]= V;
-        }
+        imagePointwise(image->verts.values, [](vec3f &v) {
+            float H = 0, S = 0, V = 0;
+            zeno::RGBtoHSV(v[0], v[1], v[2], H, S, V);
+            v = {H, S, V};
+        });
         set_output("image", image);
     }
 };
@@ -434,16 +430,11 @@ ZENDEFNODE(ImageRGB2HSV, {
 struct ImageHSV2RGB : INode {
     virtual void apply() override {
         auto image = get_input<PrimitiveObject>("image");
-        float R = 0, G = 0, B = 0;
-        for (auto i = 0; i < image->verts.size(); i++){
-            float H = image->verts[i][0];
-            float S = image->verts[i][1];
-            float V = image->verts[i][2];
-            zeno::HSVtoRGB(H, S, V, R, G, B);
-            image->verts[i][0]= R ;
-            image->verts[i][1]= G ;
-            image->verts[i][2]= B ;
-        }
+        imagePointwise(image->verts.values, [](vec3f &v) {
+            float R = 0, G = 0, B = 0;
+            zeno::HSVtoRGB(v[0], v[1], v[2], R, G, B);
+            v = {R, G, B};
+        });
         set_output("image", image);
     }
 };
@@ -462,14 +453,14 @@ ZENDEFNODE(ImageHSV2RGB, {
 struct ImageEditHSV : INode {//TODO::FIX BUG
     virtual void apply() override {
         auto image = get_input<PrimitiveObject>("image");
-        float H = 0, S = 0, V = 0;
         float Hi = get_input2<float>("H");
         float Si = get_input2<float>("S");
         float Vi = get_input2<float>("V");
-        for (auto i = 0; i < image->verts.size(); i++) {
-            float R = image->verts[i][0];
-            float G = image->verts[i][1];
-            float B = image->verts[i][2];
+        imagePointwise(image->verts.values, [=](vec3f &v) {
+            float H = 0, S = 0, V = 0;
+            float R = v[0];
+            float G = v[1];
+            float B = v[2];
             zeno::RGBtoHSV(R, G, B, H, S, V);
             //S = S + (S - 0.5)*(Si-1);
             //V = V + (V - 0.5)*(Vi-1);
@@ -479,10 +470,8 @@ struct ImageEditHSV : INode {//TODO::FIX BUG
             S = S * Si;
             V = V * Vi;
             zeno::HSVtoRGB(H, S, V, R, G, B);
-            image->verts[i][0] = R;
-            image->verts[i][1] = G;
-            image->verts[i][2] = B;
-        }
+            v = {R, G, B};
+        });
         set_output("image", image);
     }
 };
@@ -660,14 +649,8 @@ struct ImageBlur : INode {
             gaussBlur(image->verts, img_out->verts, w, h, sigmaX, 3);
         }
         else{//CV BLUR
-            cv::Mat imagecvin(h, w, CV_32FC3);
-            cv::Mat imagecvout(h, w, CV_32FC3);
-            for (auto a = 0; a < image->verts.size(); a++){
-                int i = a / w;
-                int j = a % w;
-                vec3f rgb = image->verts[i * w + j];
-                imagecvin.at<cv::Vec3f>(i, j) = {rgb[0], rgb[1], rgb[2]};
-            }
+            cv::Mat imagecvin = imageMatView(image->verts.values, w, h);
+            cv::Mat imagecvout = imageMatView(img_out->verts.values, w, h);
             if(kernelSize%2==0){
                 kernelSize += 1;
             }
@@ -691,12 +674,6 @@ struct ImageBlur : INode {
             else{
                 zeno::log_error("ImageBlur: Blur type does not exist");
             }
-            for (auto a = 0; a < image->verts.size(); a++){
-                int i = a / w;
-                int j = a % w;
-                cv::Vec3f rgb = imagecvout.at<cv::Vec3f>(i, j);
-                img_out->verts[i * w + j] = {rgb[0], rgb[1], rgb[2]};
-            }
         }
         set_output("image", img_out);
     }
@@ -723,12 +700,9 @@ struct ImageEditContrast : INode {
         auto image = get_input<PrimitiveObject>("image");
         float ContrastRatio = get_input2<float>("ContrastRatio");
         float ContrastCenter = get_input2<float>("ContrastCenter");
-        auto &ud = image->userData();
-        int w = ud.get2<int>("w");
-        int h = ud.get2<int>("h");
-        for (auto i = 0; i < image->verts.size(); i++) {
-            image->verts[i] = image->verts[i] + (image->verts[i]-ContrastCenter) * (ContrastRatio-1);
-        }
+        imagePointwise(image->verts.values, [=](vec3f &v) {
+            v = v + (v - ContrastCenter) * (ContrastRatio - 1);
+        });
         set_output("image", image);
     }
 };
@@ -748,9 +722,9 @@ ZENDEFNODE(ImageEditContrast, {
 struct ImageEditInvert : INode{
     virtual void apply() override {
         auto image = get_input<PrimitiveObject>("image");
-        for (auto i = 0; i < image->verts.size(); i++) {
-            image->verts[i] = 1 - image->verts[i];
-        }
+        imagePointwise(image->verts.values, [](vec3f &v) {
+            v = 1 - v;
+        });
         set_output("image", image);
     }
 };
@@ -839,36 +813,37 @@ struct ImageGray : INode {
     void apply() override {
         auto image = get_input<PrimitiveObject>("image");
         auto mode = get_input2<std::string>("mode");
-        auto &ud = image->userData();
-        int w = ud.get2<int>("w");
-        int h = ud.get2<int>("h");
-        for (auto i = 0; i < image->verts.size(); i++) {
-            vec3f &v = image->verts[i];
-            if(mode=="Average"){
+        auto &pixels = image->verts.values;
+        if(mode=="Average"){
+            imagePointwise(pixels, [](vec3f &v) {
                 float avg = (v[0] + v[1] + v[2]) / 3;
                 v = vec3f(avg);
-            }
-            else if(mode=="Luminance"){
-                float lumi = 0.3 * v[0] + 0.59 * v[1] + 0.11 * v[2];//(GIMP/PS)
-                v =vec3f(lumi);
-            }
-            else if(mode=="Red"){
-                v = vec3f(v[0]);
-            }
-            else if(mode=="Green"){
-                v = vec3f(v[1]);
-            }
-            else if(mode=="Blue"){
-                v = vec3f(v[2]);
-            }
-            else if(mode=="MaxComponent"){
-                float max = std::max(v[0], std::max(v[1], v[2]));
-                v = vec3f(max);
-            }
-            else if(mode=="MinComponent"){
-                float min = std::min(v[0], std::min(v[1], v[2]));
-                v = vec3f(min);
-            }
+            });
+        }
+        else if(mode=="Luminance"){
+            imagePointwise(pixels, [](vec3f &v) {
+                float lumi = 0.3f * v[0] + 0.59f * v[1] + 0.11f * v[2];//(GIMP/PS)
+                v = vec3f(lumi);
+            });
+        }
+        else if(mode=="Red"){
+            imagePointwise(pixels, [](vec3f &v) { v = vec3f(v[0]); });
+        }
+        else if(mode=="Green"){
+            imagePointwise(pixels, [](vec3f &v) { v = vec3f(v[1]); });
+        }
+        else if(mode=="Blue"){
+            imagePointwise(pixels, [](vec3f &v) { v = vec3f(v[2]); });
+        }
+        else if(mode=="MaxComponent"){
+            imagePointwise(pixels, [](vec3f &v) {
+                v = vec3f(std::max(v[0], std::max(v[1], v[2])));
+            });
+        }
+        else if(mode=="MinComponent"){
+            imagePointwise(pixels, [](vec3f &v) {
+                v = vec3f(std::min(v[0], std::min(v[1], v[2])));
+            });
         }
         set_output("image", image);
     }
@@ -1032,22 +1007,12 @@ struct ImageDilate: INode {
         auto &ud = image->userData();
         int w = ud.get2<int>("w");
         int h = ud.get2<int>("h");
-        cv::Mat imagecvin(h, w, CV_32FC3);
-        cv::Mat imagecvout(h, w, CV_32FC3);
-        for (int i = 0; i < h; i++) {
-            for (int j = 0; j < w; j++) {
-                vec3f rgb = image->verts[i * w + j];
-                imagecvin.at<cv::Vec3f>(i, j) = {rgb[0], rgb[1], rgb[2]};
-            }
-        }
-        const int kernelSize = 3;
+        // checks verts against w * h before the result is sized and swapped in
+        cv::Mat imagecvin = imageMatView(image->verts.values, w, h);
+        std::vector<vec3f> result(image->verts.size());
+        cv::Mat imagecvout = imageMatView(result, w, h);
         dilateImage(imagecvin, imagecvout, kheight, kwidth, strength);
-        for (int i = 0; i < h; i++) {
-            for (int j = 0; j < w; j++) {
-                cv::Vec3f rgb = imagecvout.at<cv::Vec3f>(i, j);
-                image->verts[i * w + j] = {rgb[0], rgb[1], rgb[2]};
-            }
-        }
+        image->verts.values.swap(result);
         set_output("image", image);
     }
 };
@@ -1112,24 +1077,14 @@ struct ImageErode: INode {
         auto &ud = image->userData();
         int w = ud.get2<int>("w");
         int h = ud.get2<int>("h");
-        cv::Mat imagecvin(h, w, CV_32FC3);
-        cv::Mat imagecvout(h, w, CV_32FC3);
-        for (int i = 0; i < h; i++) {
-            for (int j = 0; j < w; j++) {
-                vec3f rgb = image->verts[i * w + j];
-                imagecvin.at<cv::Vec3f>(i, j) = {rgb[0], rgb[1], rgb[2]};
-            }
-        }
+        cv::Mat imagecvin = imageMatView(image->verts.values, w, h);
+        std::vector<vec3f> result(image->verts.size());
+        cv::Mat imagecvout = imageMatView(result, w, h);
 
         cv::Mat kernel = getStructuringElement(cv::MORPH_RECT, cv::Size(kheight, kwidth));
         cv::erode(imagecvin, imagecvout, kernel,cv::Point(-1, -1), strength);
 
-        for (int i = 0; i < h; i++) {
-            for (int j = 0; j < w; j++) {
-                cv::Vec3f rgb = imagecvout.at<cv::Vec3f>(i, j);
-                image->verts[i * w + j] = {rgb[0], rgb[1], rgb[2]};
-            }
-        }
+        image->verts.values.swap(result);
         set_output("image", image);
     }
 };
@@ -1160,17 +1115,10 @@ struct ImageColor : INode {
         image->userData().set2("isImage", 1);
         image->userData().set2("w", size[0]);
         image->userData().set2("h", size[1]);
+        std::fill(image->verts.begin(), image->verts.end(), vec3f(color[0], color[1], color[2]));
         if(balpha){
             auto &alphaAttr = image->verts.add_attr<float>("alpha");
-            for (int i = 0; i < vertsize ; i++) {
-                image->verts[i] = {color[0], color[1], color[2]};
-                alphaAttr[i] = color[3];
-            }
-        }
-        else{
-            for (int i = 0; i < vertsize ; i++) {
-                image->verts[i] = {color[0], color[1], color[2]};
-            }
+            std::fill(alphaAttr.begin(), alphaAttr.end(), color[3]);
         }
         set_output("image", image);
         
@@ -1201,17 +1149,10 @@ struct ImageColor2 : INode {
         image->userData().set2("isImage", 1);
         image->userData().set2("w", size[0]);
         image->userData().set2("h", size[1]);
+        std::fill(image->verts.begin(), image->verts.end(), color);
         if(balpha){
             auto &alphaAttr = image->verts.add_attr<float>("alpha");
-            for (int i = 0; i < vertsize ; i++) {
-                image->verts[i] = {color[0], color[1], color[2]};
-                alphaAttr[i] = alpha;
-            }
-        }
-        else{
-            for (int i = 0; i < vertsize ; i++) {
-                image->verts[i] = {color[0], color[1], color[2]};
-            }
+            std::fill(alphaAttr.begin(), alphaAttr.end(), alpha);
         }
         set_output("image", image);
     }
@@ -1235,35 +1176,22 @@ struct ImageClamp: INode {//Add Unpremultiplied Space Option?
     void apply() override {
         auto image = get_input<PrimitiveObject>("image");
         auto background = get_input2<std::string>("ClampedValue");
-        auto &ud = image->userData();
-        int w = ud.get2<int>("w");
-        int h = ud.get2<int>("h");
         auto up = get_input2<float>("Max");
         auto low = get_input2<float>("Min");
         if(background == "LimitValue"){
-        for (auto i = 0; i < image->verts.size(); i++) {
-            image->verts[i] = zeno::clamp(image->verts[i], low, up);
-            }
+            imagePointwise(image->verts.values, [=](vec3f &v) {
+                v = zeno::clamp(v, low, up);
+            });
         }
-        else if(background == "Black"){
-            for (auto i = 0; i < image->verts.size(); i++) {
-                vec3f &v = image->verts[i];
+        else if(background == "Black" || background == "White"){
+            float fill = background == "White" ? 1 : 0;
+            imagePointwise(image->verts.values, [=](vec3f &v) {
                 for(int j = 0; j < 3; j++){
                     if((v[j]<low) || (v[j]>up)){
-                        v[j] = 0;
+                        v[j] = fill;
                     }
                 }
-            }
-        }
-        else if(background == "White"){
-            for (auto i = 0; i < image->verts.size(); i++) {
-                vec3f &v = image->verts[i];
-                for(int j = 0; j < 3; j++){
-                    if((v[j]<low) || (v[j]>up)){
-                        v[j] = 1;
-                    }
-                }
-            }
+            });
         }
 
         set_output("image", image);
@@ -1573,9 +1501,7 @@ struct ImageLevels: INode {
         MinRed /= 255.0f, MinGreen /= 255.0f, MinBlue /= 255.0f, MaxRed /= 255.0f, MaxGreen /= 255.0f, MaxBlue /= 255.0f;
 
         if(autolevel){
-#pragma omp parallel for
-            for (int i = 0; i < w * h; i++) {
-                vec3f &v = image->verts[i];
+            imagePointwise(image->verts.values, [=](vec3f &v) {
                 v[0] = (v[0] < MinRed) ? MinRed : v[0];
                 v[1] = (v[1] < MinGreen) ? MinGreen : v[1];
                 v[2] = (v[2] < MinBlue) ? MinBlue : v[2];
@@ -1583,19 +1509,17 @@ struct ImageLevels: INode {
                 v[1] = (v[1] - MinGreen) / (MaxGreen - MinGreen);
                 v[2] = (v[2] - MinBlue) / (MaxBlue - MinBlue);
                 v = clamp ? zeno::clamp((v * outputRange + outputMin), 0, 1) : (v * outputRange + outputMin);
-            }
+            });
         }
         else if (channel == "All") {
-#pragma omp parallel for
-            for (int i = 0; i < w * h; i++) {
-                vec3f &v = image->verts[i];
+            imagePointwise(image->verts.values, [=](vec3f &v) {
                 v[0] = (v[0] < inputMin) ? inputMin : v[0];
                 v[1] = (v[1] < inputMin) ? inputMin : v[1];
                 v[2] = (v[2] < inputMin) ? inputMin : v[2];
                 v = (v - inputMin) / inputRange; 
                 v = pow(v, gammaCorrection);
                 v = clamp ? zeno::clamp((v * outputRange + outputMin), 0, 1) : (v * outputRange + outputMin);
-            }
+            });
             if(image->has_attr("alpha")){
                 auto &alphaAttr = image->verts.attr<float>("alpha");
 #pragma omp parallel for
@@ -1608,36 +1532,33 @@ struct ImageLevels: INode {
             }
         }
         else if (channel == "R") {
-#pragma omp parallel for
-        for (int i = 0; i < w * h; i++) {
-                float &v = image->verts[i][0];
+            imagePointwise(image->verts.values, [=](vec3f &pixel) {
+                float &v = pixel[0];
                 if (v < inputMin) v = inputMin;
                 v = (v - inputMin) / inputRange;
                 v = pow(v, gammaCorrection);
                 v = clamp ? zeno::clamp((v * outputRange + outputMin), 0, 1) : (v * outputRange + outputMin);
-            }
+            });
         }
 
         else if (channel == "G") {
-#pragma omp parallel for
-        for (int i = 0; i < w * h; i++) {
-                float &v = image->verts[i][1];
+            imagePointwise(image->verts.values, [=](vec3f &pixel) {
+                float &v = pixel[1];
                 if (v < inputMin) v = inputMin;
                 v = (v - inputMin) / inputRange;
                 v = pow(v, gammaCorrection);
                 v = clamp ? zeno::clamp((v * outputRange + outputMin), 0, 1) : (v * outputRange + outputMin);
-            }
+            });
         }
         
         else if (channel == "B") {
-#pragma omp parallel for
-        for (int i = 0; i < w * h; i++) {
-                float &v = image->verts[i][2];
+            imagePointwise(image->verts.values, [=](vec3f &pixel) {
+                float &v = pixel[2];
                 if (v < inputMin) v = inputMin;
                 v = (v - inputMin) / inputRange;
                 v = pow(v, gammaCorrection);
                 v = clamp ? zeno::clamp((v * outputRange + outputMin), 0, 1) : (v * outputRange + outputMin);
-            }
+            });
         }
         
         else if (channel == "A") {
@@ -96,41 +96,22 @@ struct ImageEdgeDetect : INode {
             set_output("image", image);
         }*/
         if (mode == "Sobel") {
-            cv::Mat imagecvin(h, w, CV_32F);
-#pragma omp parallel for
-            for (int i = 0; i < h; i++) {
-                for (int j = 0; j < w; j++) {
-                    vec3f rgb = image->verts[i * w + j];
-                    var = rgb[0] * 0.299 + rgb[1] * 0.587 + rgb[2] *0.114;//TODO:: detect rgb three channel?
-                    imagecvin.at<float>(i, j) = var;
-                }
-            }
+            cv::Mat imagecvin;//TODO:: detect rgb three channel?
+            cv::cvtColor(imageMatView(image->verts.values, w, h), imagecvin, cv::COLOR_RGB2GRAY);
             cv::Mat gradX, gradY;
             //cv::Sobel(imagecvin, gradX, CV_32F, 1, 0, kernelSize,scale,delta,borderType);
             cv::Sobel(imagecvin, gradX, CV_32F, 1, 0, kernelSize);
             cv::Sobel(imagecvin, gradY, CV_32F, 0, 1, kernelSize);
-#pragma omp parallel for
-            for (int i = 0; i < h; i++) {
-                for (int j = 0; j < w; j++) {
-                    float magnitude = abs(gradX.at<float>(i, j)) + abs(gradY.at<float>(i, j));//manhattan distance？ not euclidean distance
-                    image->verts[i * w + j] = {magnitude, magnitude, magnitude};
-                }
-            }
+            cv::Mat magnitude = cv::abs(gradX) + cv::abs(gradY);//manhattan distance？ not euclidean distance
+            cv::Mat imagecvout = imageMatView(image->verts.values, w, h);
+            cv::cvtColor(magnitude, imagecvout, cv::COLOR_GRAY2RGB);
             set_output("image", image);
         }
         else if (mode == "Roberts") {
-            cv::Mat imagecvin(h, w, CV_32F);
-            cv::Mat imagecvout(h, w, CV_32F);
+            cv::Mat imagecvin;
+            cv::Mat imagecvout;
             cv::Mat robertsX, robertsY;
-            cv::Mat magnitude;
-#pragma omp parallel for
-            for (int i = 0; i < h; i++) {
-                for (int j = 0; j < w; j++) {
-                    vec3f rgb = image->verts[i * w + j];
-                    var = (rgb[0] * 0.299 + rgb[1] * 0.587 + rgb[2] *0.114);
-                    imagecvin.at<float>(i, j) = var;
-                }
-            }
+            cv::cvtColor(imageMatView(image->verts.values, w, h), imagecvin, cv::COLOR_RGB2GRAY);
             cv::Mat kernelX = (cv::Mat_<float>(2, 2) << 1, 0, 0, -1);
             cv::filter2D(imagecvin, robertsX, -1, kernelX);
 
@@ -138,12 +119,8 @@ struct ImageEdgeDetect : INode {
             cv::filter2D(imagecvin, robertsY, -1, kernelY);
 
             cv::magnitude(robertsX, robertsY, imagecvout);
-#pragma omp parallel for
-            for (int i = 0; i < h; i++) {
-                for (int j = 0; j < w; j++) {
-                    image->verts[i * w + j] = vec3f(imagecvout.at<float>(i, j));
-                }
-            }
+            cv::Mat imagecvrgb = imageMatView(image->verts.values, w, h);
+            cv::cvtColor(imagecvout, imagecvrgb, cv::COLOR_GRAY2RGB);
             set_output("image", image);
         }
         /*if (mode == "roberts_threshold") {
@@ -173,18 +150,10 @@ struct ImageEdgeDetect : INode {
             set_output("image", image);
         }*/
         else if (mode == "Prewitt") {
-            cv::Mat imagecvin(h, w, CV_32F);
-            cv::Mat imagecvout(h, w, CV_32F);
-            cv::Mat edges;
+            cv::Mat imagecvin;
+            cv::Mat imagecvout;
             cv::Mat prewittX, prewittY;
-#pragma omp parallel for
-            for (int i = 0; i < h; i++) {
-                for (int j = 0; j < w; j++) {
-                    vec3f rgb = image->verts[i * w + j];
-                    var =  (rgb[0] * 0.299 + rgb[1] * 0.587 + rgb[2] *0.114);
-                    imagecvin.at<float>(i, j) = var;
-                }
-            }
+            cv::cvtColor(imageMatView(image->verts.values, w, h), imagecvin, cv::COLOR_RGB2GRAY);
             cv::Mat kernelX = (cv::Mat_<float>(3, 3) << -1, 0, 1, -1, 0, 1, -1, 0, 1);
             cv::filter2D(imagecvin, prewittX, -1, kernelX);
 
@@ -192,12 +161,8 @@ struct ImageEdgeDetect : INode {
             cv::filter2D(imagecvin, prewittY, -1, kernelY);
 
             cv::magnitude(prewittX, prewittY, imagecvout);
-#pragma omp parallel for
-            for (int i = 0; i < h; i++) {
-                for (int j = 0; j < w; j++) {
-                    image->verts[i * w + j] = vec3f(imagecvout.at<float>(i, j));
-                }
-            }
+            cv::Mat imagecvrgb = imageMatView(image->verts.values, w, h);
+            cv::cvtColor(imagecvout, imagecvrgb, cv::COLOR_GRAY2RGB);
             set_output("image", image);
         }
         /*if (mode == "Canny") {//TODO：： Canny opencv only accept 8bit image
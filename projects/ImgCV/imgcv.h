@@ -1,9 +1,43 @@
 #ifndef ZENO_IMGCV_H
 #define ZENO_IMGCV_H
 #include <opencv2/core/utility.hpp>
+#include <opencv2/core.hpp>
 #include "zeno/core/IObject.h"
+#include <zeno/types/PrimitiveObject.h>
+#include <zeno/types/UserData.h>
+#include <zeno/utils/Error.h>
+#include <algorithm>
+#include <cstddef>
+#include <string>
 
 namespace zeno {
+    // image prims keep their pixels as verts, rows of w rgb floats (verts[i * w + j]),
+    // so a CV_32FC3 header can alias them without copying; the header does not own
+    // the pixels and is invalidated by resizing the vector. Throws when the pixels
+    // are not exactly w * h, a header over them would read or write out of bounds
+    inline cv::Mat imageMatView(std::vector<vec3f> &pixels, int w, int h) {
+        if (w < 0 || h < 0 || pixels.size() != std::size_t(w) * std::size_t(h))
+            throw makeError("image of " + std::to_string(pixels.size()) + " pixels is not "
+                            + std::to_string(w) + "x" + std::to_string(h));
+        return cv::Mat(h, w, CV_32FC3, pixels.data());
+    }
+
+    // one parallel in-place sweep of f(vec3f &) over all pixels; each thread takes whole
+    // blocks so it streams its own contiguous run, and f inlines into the inner loop
+    template <class F>
+    inline void imagePointwise(std::vector<vec3f> &pixels, F const &f) {
+        constexpr std::ptrdiff_t kBlock = 4096;
+        std::ptrdiff_t n = pixels.size();
+        vec3f *data = pixels.data();
+#pragma omp parallel for schedule(static)
+        for (std::ptrdiff_t b = 0; b < n; b += kBlock) {
+            std::ptrdiff_t e = std::min(b + kBlock, n);
+            for (std::ptrdiff_t i = b; i < e; i++) {
+                f(data[i]);
+            }
+        }
+    }
+
     struct CVImageObject : IObjectClone<CVImageObject> {
         cv::Mat image;
 
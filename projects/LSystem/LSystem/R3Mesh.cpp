@@ -155,8 +155,11 @@ Tree(const string code, const bool isPlus)
   // return;
 
   LPlusSystem l(this);
-  string lsystem=l.generateFromCode(code, isPlus);
-  l.draw(lsystem); 
+  LSysDerivation derivation;
+  if (l.deriveFromCode(code, isPlus, derivation))
+    l.draw(derivation);
+  else
+    l.draw(l.generateFromCode(code, isPlus));
   Update();
 
 }
@@ -13,6 +13,11 @@ string LPlusSystem::generateFromCode(const string code, const bool plus)
 	return LSystem::generateFromCode(code);
 
 }
+bool LPlusSystem::deriveFromCode(const string code, const bool plus, LSysDerivation &out)
+{
+	isPlus=plus;
+	return LSystem::deriveFromCode(code, out);
+}
 void LPlusSystem::run(const char command,const float param)
 {
 	if (!isPlus)
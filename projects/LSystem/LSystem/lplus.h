@@ -12,5 +12,6 @@ public:
 	bool isPlus;
 	LPlusSystem(R3Mesh *m);
 	string generateFromCode(const string code, const bool plus);
-	virtual void run(const char command,const float param);
+	bool deriveFromCode(const string code, const bool plus, LSysDerivation &out);
+	void run(const char command,const float param) override;
 };
\ No newline at end of file
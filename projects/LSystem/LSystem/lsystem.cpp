@@ -1,5 +1,6 @@
 #include "lsystem.h"
 #include <sstream>
+#include <limits>
 using namespace std;
 void LSystem::replaceAll(string& str, const string& from, const string& to) 
 {
@@ -32,20 +33,66 @@ string LSystem::reproduce(const string axiom,const AssociativeArray rules, const
 		return reproduce(produce(axiom,rules),rules,iterations-1);
 	return axiom;
 }
-string LSystem::generateFromCode(const string code)
+uint64_t LSysDerivation::size() const
+{
+	uint64_t n=0;
+	for (unsigned char c:axiom)
+		n+=levels.empty() ? 1 : lengths[0][c];
+	return n;
+}
+bool LSystem::derive(const string axiom,const AssociativeArray rules, const int iterations, LSysDerivation &out)
+{
+	AssociativeArray::const_iterator iter;
+	for (iter=rules.begin(); iter!=rules.end();++iter)
+		if (iter->first.size()!=1)
+			return false;
+	out.axiom=axiom;
+	int n=max(iterations,0);
+	out.levels.assign(n,array<string,256>());
+	out.fixed.assign(n,array<bool,256>());
+	out.lengths.assign(n,array<uint64_t,256>());
+	for (int k=0;k<n;++k)
+	{
+		// replaceAll with a single character key maps every character on its own,
+		// so the rules of one iteration compose into a map per character
+		array<string,256> &level=out.levels[k];
+		for (int c=0;c<256;++c)
+			level[c]=string(1,(char)c);
+		for (iter=rules.begin(); iter!=rules.end();++iter)
+		{
+			const vector<string> &value=iter->second;
+			int index=rand()%value.size();
+			for (int c=0;c<256;++c)
+				replaceAll(level[c],iter->first,value[index]);
+		}
+	}
+	for (int k=n-1;k>=0;--k)
+	{
+		for (int c=0;c<256;++c)
+		{
+			const string &s=out.levels[k][c];
+			out.fixed[k][c]=s.size()==1 && (unsigned char)s[0]==c && (k==n-1 || out.fixed[k+1][c]);
+			uint64_t len=0;
+			for (unsigned char d:s)
+			{
+				uint64_t l=k==n-1 ? 1 : out.lengths[k+1][d];
+				len=l>numeric_limits<uint64_t>::max()-len ? numeric_limits<uint64_t>::max() : len+l;
+			}
+			out.lengths[k][c]=len;
+		}
+	}
+	return true;
+}
+void LSystem::parseCode(const string code, string &axiom, AssociativeArray &rules, int &iterations)
 {
     auto isSetIterations{false};
-    int iterations;
+    iterations=0;
 
     auto isSetDefaultCoefficient{false};
 
     auto isSetThickness{false};
     float thickness;
 
-    std::string axiom;
-
-    AssociativeArray rules;
-
     std::stringstream ss(code);
     while (ss)
     {
@@ -90,7 +137,39 @@ string LSystem::generateFromCode(const string code)
 			rules[temp.substr(0,equalSignPos)].push_back(temp.substr(equalSignPos+1));
 		}
     }
-    return reproduce(axiom, rules, iterations);
+}
+string LSystem::generateFromCode(const string code)
+{
+    string axiom;
+    AssociativeArray rules;
+    int iterations;
+    parseCode(code, axiom, rules, iterations);
+
+    LSysDerivation derivation;
+    if (!derive(axiom, rules, iterations, derivation))
+        return reproduce(axiom, rules, iterations);
+    // materialize in independent chunks, each seeking to its offset
+    uint64_t size=derivation.size();
+    string result(size, '\0');
+    const int64_t chunk=1<<20;
+    int64_t nchunks=(size+chunk-1)/chunk;
+#pragma omp parallel for schedule(dynamic)
+    for (int64_t i=0;i<nchunks;++i)
+    {
+        char *out=&result[i*chunk];
+        derivation.expandRange(i*chunk, min<uint64_t>(size, (i+1)*chunk), [&] (char c) {
+            *out++=c;
+        });
+    }
+    return result;
+}
+bool LSystem::deriveFromCode(const string code, LSysDerivation &out)
+{
+    string axiom;
+    AssociativeArray rules;
+    int iterations;
+    parseCode(code, axiom, rules, iterations);
+    return derive(axiom, rules, iterations, out);
 }
 void LSystem::run(const char command,const float param)
 {
@@ -143,48 +222,53 @@ void LSystem::run(const char command,const float param)
 
 
 }
-void LSystem::draw(const string tree)
+void LSystem::CommandReader::feed(char c)
 {
-	char paramBuf[1024];
-	int bufIndex=0;
-	string data=tree;
-	float param=0;
-	bool getParam=false,checkParam=false;
-	char command;
-	for (int i=0;i<data.size();++i)
+	if (getParam)
 	{
-		char c=data[i];
-		if (getParam)
+		if (c==')')
 		{
-			if (c==')')
-			{
-				paramBuf[bufIndex]=0;
-				bufIndex=0;
-				param=atof(paramBuf);
-				getParam=false;
-				run(command,param);
-			}
-			else
-				paramBuf[bufIndex++]=c;
-			continue;
+			paramBuf[bufIndex]=0;
+			bufIndex=0;
+			getParam=false;
+			system.run(command,atof(paramBuf));
 		}
-		if (checkParam)
+		else if (bufIndex<(int)sizeof(paramBuf)-1)
+			paramBuf[bufIndex++]=c;
+		return;
+	}
+	if (checkParam)
+	{
+		checkParam=false;
+		if (c=='(')
 		{
-			checkParam=false;
-			if (c=='(')
-			{
-				param=0;	
-				getParam=true;
-				continue;
-			}
-			run(command,1);
-
+			getParam=true;
+			return;
 		}
-		command=c;
-		checkParam=true;
+		system.run(command,1);
 	}
+	command=c;
+	checkParam=true;
+}
+void LSystem::CommandReader::finish()
+{
 	if (checkParam)
-		run(command,1);
-
-	//cout <<data<<endl;
-}
\ No newline at end of file
+		system.run(command,1);
+	checkParam=false;
+}
+void LSystem::draw(const string tree)
+{
+	CommandReader reader(*this);
+	for (char c:tree)
+		reader.feed(c);
+	reader.finish();
+}
+void LSystem::draw(const LSysDerivation &data)
+{
+	// the derived string is streamed into the turtle, never stored
+	CommandReader reader(*this);
+	data.expand([&] (char c) {
+		reader.feed(c);
+	});
+	reader.finish();
+}
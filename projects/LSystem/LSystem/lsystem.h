@@ -4,8 +4,67 @@
 #include "turtle.h"
 #include <string>
 #include <map>
+#include <array>
+#include <cstdint>
 using namespace std;
 typedef map<string,vector<string> > AssociativeArray;
+
+// the derived string of an l-system, kept as the axiom plus what every symbol turns into
+// at each iteration; symbols are expanded on the fly so the (exponentially long) result
+// never has to be materialized. only rules with single-character keys can be derived
+// this way, the rules of one iteration are then composed into one map per symbol
+struct LSysDerivation
+{
+	string axiom;
+	vector<array<string,256> > levels;    // levels[k][c]: c rewritten by iteration k
+	vector<array<bool,256> > fixed;       // fixed[k][c]: c is left alone from iteration k on
+	vector<array<uint64_t,256> > lengths; // lengths[k][c]: final length of c from iteration k on, saturated
+
+	uint64_t size() const;
+
+	// calls emit(c) for every symbol of the derived string in order
+	template <class F>
+	void expand(F &&emit) const
+	{
+		expandRange(0, size(), emit);
+	}
+
+	// calls emit(c) for the symbols [first, last) of the derived string, seeking to
+	// first through the length table, so disjoint ranges may be expanded in parallel
+	template <class F>
+	void expandRange(uint64_t first, uint64_t last, F &&emit) const
+	{
+		struct Frame { const string *s; size_t i; };
+		vector<Frame> stack;
+		stack.push_back({&axiom, 0});
+		uint64_t pos=0;
+		while (!stack.empty() && pos<last)
+		{
+			Frame &top=stack.back();
+			if (top.i==top.s->size())
+			{
+				stack.pop_back();
+				continue;
+			}
+			unsigned char c=(*top.s)[top.i++];
+			size_t k=stack.size()-1;
+			uint64_t len=k<levels.size() ? lengths[k][c] : 1;
+			if (pos+len<=first)
+			{
+				pos+=len;
+				continue;
+			}
+			if (k==levels.size() || fixed[k][c])
+			{
+				emit((char)c);
+				++pos;
+				continue;
+			}
+			stack.push_back({&levels[k][c], 0});
+		}
+	}
+};
+
 class LSystem 
 {
 protected:
@@ -13,6 +72,7 @@ protected:
 	TurtleSystem turtle;
 	void replaceAll(string& str, const string& from, const string& to) ;
     string produce(const string axiom, const AssociativeArray rules);
+	void parseCode(const string code, string &axiom, AssociativeArray &rules, int &iterations);
 	virtual void run(const char command,const float param);
 	float defaultCoefficient;
 public:
@@ -21,7 +81,31 @@ public:
 	{
 
 	}
+	virtual ~LSystem() = default;
 	string reproduce(const string axiom,const AssociativeArray rules, const int iterations=1);
+	// same result (and same use of rand()) as reproduce, false if a rule key is not a single character
+	bool derive(const string axiom,const AssociativeArray rules, const int iterations, LSysDerivation &out);
 	virtual string generateFromCode(const string code);
+	bool deriveFromCode(const string code, LSysDerivation &out);
 	void draw(const string data);
+	void draw(const LSysDerivation &data);
+	// record branches and leaves as turtle frames instead of adding geometry to the mesh
+	void recordInstances(vector<TurtleInstance> *branches, vector<TurtleInstance> *leaves)
+	{
+		turtle.record(branches,leaves);
+	}
+
+private:
+	// parses "c" and "c(param)" commands one character at a time
+	struct CommandReader
+	{
+		LSystem &system;
+		char paramBuf[1024];
+		int bufIndex=0;
+		bool getParam=false,checkParam=false;
+		char command=0;
+		CommandReader(LSystem &s):system(s) {}
+		void feed(char c);
+		void finish();
+	};
 };
\ No newline at end of file
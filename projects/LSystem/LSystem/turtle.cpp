@@ -81,6 +81,11 @@ TurtleSystem::TurtleSystem(R3Mesh * m)
 :mesh(m)
 {
 }
+void TurtleSystem::record(vector<TurtleInstance> *b, vector<TurtleInstance> *l)
+{
+  branches=b;
+  leaves=l;
+}
 void TurtleSystem::save()
 {
   Turtle t=(Turtle)*this;
@@ -106,6 +111,11 @@ void TurtleSystem::restore()
 }
 void TurtleSystem::drawLeaf(float param)
 {
+  if (leaves)
+  {
+    leaves->push_back({position,direction,right,param,thickness,reduction});
+    return;
+  }
 
   R3Shape s=mesh->Leaf(direction);
 
@@ -123,9 +133,11 @@ void TurtleSystem::drawLeaf(float param)
 }
 void TurtleSystem::draw(float param)
 {
-  static int num=0;
-  if (num++ % 1000 ==0) cout <<num<<" drawing"<<endl;
-
+  if (branches)
+  {
+    branches->push_back({position,direction,right,param,thickness,reduction});
+    return;
+  }
   int slices;
   if (thickness<.2)
     slices=20;
@@ -26,13 +26,26 @@ struct Turtle
   void setReduction(float param);
 
 
+};
+// a branch or leaf as the turtle frame it is drawn in, instead of its geometry
+struct TurtleInstance
+{
+  R3Vector position;
+  R3Vector direction;
+  R3Vector right;
+  float length;
+  float thickness;
+  float reduction;
 };
 class TurtleSystem: public Turtle 
 {
   stack<Turtle> state;
   R3Mesh *mesh;
+  vector<TurtleInstance> *branches=nullptr;
+  vector<TurtleInstance> *leaves=nullptr;
 public:
   TurtleSystem(R3Mesh * m);
+  void record(vector<TurtleInstance> *b, vector<TurtleInstance> *l);
   void save();
   void restore();
   void draw(float param);
@@ -3,6 +3,7 @@
 #include "zeno/types/PrimitiveObject.h"
 
 #include "LSystem/R3Mesh.h"
+#include "LSystem/lplus.h"
 
 #include <iostream>
 #include <sstream>
@@ -300,6 +301,70 @@ namespace zeno
             },
         });
 
+    // branches and leaves as point prims of turtle frames, to be instanced (e.g. by
+    // PrimDuplicate with dirAttr nrm, tanAttr tang) rather than meshed per branch
+    struct ProceduralTreeInstances : zeno::INode
+    {
+        static std::shared_ptr<zeno::PrimitiveObject> toPrim(std::vector<TurtleInstance> const &insts, bool isLeaf)
+        {
+            auto prim = std::make_shared<zeno::PrimitiveObject>();
+            prim->resize(insts.size());
+            auto &pos = prim->attr<zeno::vec3f>("pos");
+            auto &nrm = prim->add_attr<zeno::vec3f>("nrm");
+            auto &tang = prim->add_attr<zeno::vec3f>("tang");
+            auto &scale = prim->add_attr<float>(isLeaf ? "scale" : "length");
+            auto &radius = prim->add_attr<float>("radius");
+            auto &reduction = prim->add_attr<float>("reduction");
+#pragma omp parallel for
+            for (int i = 0; i < (int)insts.size(); ++i)
+            {
+                const auto &t = insts[i];
+                pos[i] = zeno::vec3f(t.position.X(), t.position.Y(), t.position.Z());
+                nrm[i] = zeno::vec3f(t.direction.X(), t.direction.Y(), t.direction.Z());
+                tang[i] = zeno::vec3f(t.right.X(), t.right.Y(), t.right.Z());
+                scale[i] = t.length;
+                radius[i] = t.length * t.thickness;
+                reduction[i] = t.reduction;
+            }
+            return prim;
+        }
+
+        virtual void apply() override
+        {
+            auto generator = get_input<zeno::LSysGenerator>("generator");
+            auto code = generator->getCode();
+            auto isPlus = generator->isPlus();
+
+            std::vector<TurtleInstance> branches, leaves;
+            LPlusSystem l(nullptr);
+            l.recordInstances(&branches, &leaves);
+            LSysDerivation derivation;
+            if (l.deriveFromCode(code, isPlus, derivation))
+                l.draw(derivation);
+            else
+                l.draw(l.generateFromCode(code, isPlus));
+
+            set_output("branches", toPrim(branches, false));
+            set_output("leaves", toPrim(leaves, true));
+        }
+    };
+
+    ZENDEFNODE(
+        ProceduralTreeInstances,
+        {
+            {
+                {"LSysGenerator", "generator"},
+            },
+            {
+                {"primitive", "branches"},
+                {"primitive", "leaves"},
+            },
+            {},
+            {
+                "LSystem",
+            },
+        });
+
     /*
     struct R3MeshToPrim : zeno::INode
     {
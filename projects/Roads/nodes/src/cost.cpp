@@ -125,23 +125,31 @@ namespace {
         std::string OutputChannel;
         ZENO_DECLARE_INPUT_FIELD(OutputChannel, "Vert_OutputChannel", false, "", "gradient");
 
+        float SmoothSigma = 0.0f;
+        ZENO_DECLARE_INPUT_FIELD(SmoothSigma, "Smooth Sigma (0 to disable)", false, "", "0");
+
         zeno::AttrVector<float> HeightList{};
         ZENO_BINDING_PRIMITIVE_ATTRIBUTE(Primitive, HeightList, HeightChannel, zeno::reflect::EZenoPrimitiveAttr::VERT);
 
         void apply() override {
             RoadsAssert(AutoParameter->Nx * AutoParameter->Ny <= AutoParameter->HeightList.size(), "Bad size in userdata! Check your nx ny.");
 
-            DynamicGrid<HeightPoint> HeightField(AutoParameter->Nx, AutoParameter->Ny);
-            for (size_t i = 0; i < HeightField.size(); ++i) {
-                HeightField[i] = AutoParameter->HeightList[i];
+            DynamicGrid<float> SmoothedField(AutoParameter->Nx, AutoParameter->Ny);
+            std::copy_n(AutoParameter->HeightList.begin(), SmoothedField.size(), SmoothedField.begin());
+            if (AutoParameter->SmoothSigma > 0) {
+                DynamicGrid<float> Scratch(AutoParameter->Nx, AutoParameter->Ny);
+                filter::GaussianFilter(SmoothedField, AutoParameter->SmoothSigma, Scratch);
             }
 
+            DynamicGrid<HeightPoint> HeightField(AutoParameter->Nx, AutoParameter->Ny);
+            std::copy(SmoothedField.begin(), SmoothedField.end(), HeightField.begin());
+
             DynamicGrid<SlopePoint> SlopeField = CalculateSlope(HeightField);
             if (!AutoParameter->Primitive->verts.has_attr(AutoParameter->OutputChannel)) {
                 AutoParameter->Primitive->verts.add_attr<float>(AutoParameter->OutputChannel);
             }
             std::vector<float> &SlopeAttr = AutoParameter->Primitive->verts.attr<float>(AutoParameter->OutputChannel);
-            SlopeAttr.insert(SlopeAttr.begin(), SlopeField.begin(), SlopeField.end());
+            std::copy(SlopeField.begin(), SlopeField.end(), SlopeAttr.begin());
         }
     };
 
@@ -176,6 +184,52 @@ namespace {
         Vertex m_goal;
     };
 
+    // Edge cost of the path search: height and gradient differences and the turning
+    // curvature through Prev, From and To, each mapped through its control curve
+    struct PathCostKernel {
+        size_t Nx = 0;
+        ArrayList<float> Height;
+        ArrayList<float> Gradient;
+        const zeno::CurveData *HeightCurve = nullptr;
+        const zeno::CurveData *GradientCurve = nullptr;
+        const zeno::CurveData *CurvatureCurve = nullptr;
+        float CurvatureThreshold = -1.0f;
+
+        static const zeno::CurveData *ResolveCurve(const std::shared_ptr<zeno::CurveObject> &Curve) {
+            if (Curve && Curve->keys.count("x")) {
+                return &Curve->keys.at("x");
+            }
+            zeno::log_warn("[Roads] Invalid Curve !");
+            return nullptr;
+        }
+
+        static float MapCost(const zeno::CurveData *Curve, float Threshold, float In) {
+            if (Threshold > 0 && In > Threshold) {
+                return 9e06f;
+            }
+            return Curve ? Curve->eval(In) : In;
+        }
+
+        float Curvature(size_t A, size_t B, size_t C) const {
+            const float Ax = float(A % Nx), Ay = float(A / Nx);
+            const float Bx = float(B % Nx), By = float(B / Nx);
+            const float Cx = float(C % Nx), Cy = float(C / Nx);
+
+            Eigen::Vector3f BA = {Ax - Bx, Ay - By, Height[A] - Height[B]};
+            Eigen::Vector3f BC = {Cx - Bx, Cy - By, Height[C] - Height[B]};
+            float Magnitude_BC = BC.norm();
+
+            float Magnitude_Change = (BC.normalized() - BA.normalized()).norm();
+            return Magnitude_Change / (Magnitude_BC * Magnitude_BC) * BC.z();
+        }
+
+        float operator()(size_t Prev, size_t From, size_t To) const {
+            return MapCost(HeightCurve, -1.0f, std::abs(Height[From] - Height[To]))
+                 + MapCost(GradientCurve, -1.0f, std::abs(Gradient[From] - Gradient[To]))
+                 + MapCost(CurvatureCurve, CurvatureThreshold, std::abs(Curvature(Prev, From, To)));
+        }
+    };
+
     struct ZENO_CRTP(CalcPathCost_Simple, zeno::reflect::IParameterAutoNode) {
         //struct CalcPathCost_Simple : public zeno::reflect::IParameterAutoNode<CalcPathCost_Simple> {
         ZENO_GENERATE_NODE_BODY(CalcPathCost_Simple);
@@ -217,6 +271,10 @@ namespace {
         zeno::vec2f Goal;
         ZENO_DECLARE_INPUT_FIELD(Goal, "Goal Point");
 
+        // Lines of (start, goal) vertex indices of Prim, solved in parallel instead of Start/Goal
+        std::shared_ptr<zeno::PrimitiveObject> Queries = nullptr;
+        ZENO_DECLARE_INPUT_FIELD(Queries, "Start Goal Pairs (Lines)", true);
+
         std::shared_ptr<zeno::CurveObject> HeightCurve = nullptr;
         ZENO_DECLARE_INPUT_FIELD(HeightCurve, "Height Cost Control", true);
 
@@ -249,104 +307,60 @@ namespace {
         void apply() override {
             RoadsAssert(AutoParameter->Nx * AutoParameter->Ny <= AutoParameter->GradientList.size(), "Bad nx ny.");
 
-            CostPoint GoalPoint{static_cast<size_t>(AutoParameter->Goal[0]), static_cast<size_t>(AutoParameter->Goal[1]), 0};
-            CostPoint StartPoint{static_cast<size_t>(AutoParameter->Start[0]), static_cast<size_t>(AutoParameter->Start[1]), 0};
+            const size_t Nx = AutoParameter->Nx, Ny = AutoParameter->Ny;
 
-            DefaultedHashMap<CostPoint, CostPoint> Predecessor;
-            DefaultedHashMap<CostPoint, float> CostMap;
-
-            size_t Nx = AutoParameter->Nx, Ny = AutoParameter->Ny;
-
-            auto MapFuncGen = [](const std::shared_ptr<zeno::CurveObject> &Curve, float Threshold) -> std::function<float(float)> {
-                if (Curve) {
-                    return [Curve, Threshold](float In) -> float {
-                        if (Threshold > 0 && In > Threshold) {
-                            return 9e06f;
-                        }
-                        return Curve->eval(float(In));
-                    };
-                } else {
-                    zeno::log_warn("[Roads] Invalid Curve !");
-                    return [Threshold](float In) -> float {
-                        if (Threshold > 0 && In > Threshold) {
-                            return 9e06f;
-                        }
-                        return In;
-                    };
+            PathCostKernel Kernel;
+            Kernel.Nx = Nx;
+            Kernel.Height.resize(Nx * Ny);
+            Kernel.Gradient.resize(Nx * Ny);
+#pragma omp parallel for
+            for (int64_t i = 0; i < int64_t(Nx * Ny); ++i) {
+                Kernel.Height[i] = AutoParameter->PositionList[i].at(1);
+                Kernel.Gradient[i] = AutoParameter->GradientList[i];
+            }
+            Kernel.HeightCurve = PathCostKernel::ResolveCurve(AutoParameter->HeightCurve);
+            Kernel.GradientCurve = PathCostKernel::ResolveCurve(AutoParameter->GradientCurve);
+            Kernel.CurvatureCurve = PathCostKernel::ResolveCurve(AutoParameter->CurvatureCurve);
+            Kernel.CurvatureThreshold = AutoParameter->CurvatureThreshold;
+
+            ArrayList<std::pair<size_t, size_t>> Queries;
+            if (AutoParameter->Queries) {
+                for (const auto &Line: AutoParameter->Queries->lines) {
+                    Queries.emplace_back(size_t(Line[0]), size_t(Line[1]));
                 }
-            };
-
-            auto HeightCostFunc = MapFuncGen(AutoParameter->HeightCurve, -1.0f);
-            auto GradientCostFunc = MapFuncGen(AutoParameter->GradientCurve, -1.0f);
-            auto CurvatureCostFunc = MapFuncGen(AutoParameter->CurvatureCurve, AutoParameter->CurvatureThreshold);
-
-            DynamicGrid<CostPoint> CostGrid(AutoParameter->Nx, AutoParameter->Ny);
-            CostGrid.resize(AutoParameter->Nx * AutoParameter->Ny);
-            //#pragma omp parallel for
-            for (size_t i = 0; i < AutoParameter->Nx * AutoParameter->Ny; ++i) {
-                size_t x = i % AutoParameter->Nx;
-                size_t y = i / AutoParameter->Ny;
-                CostGrid[i] = (CostPoint{x, y, 0, AutoParameter->PositionList[i].at(1), AutoParameter->GradientList[i]});
+            } else {
+                size_t StartIdx = static_cast<size_t>(AutoParameter->Start[0]) + static_cast<size_t>(AutoParameter->Start[1]) * Nx;
+                size_t GoalIdx = static_cast<size_t>(AutoParameter->Goal[0]) + static_cast<size_t>(AutoParameter->Goal[1]) * Nx;
+                Queries.emplace_back(StartIdx, GoalIdx);
             }
 
-            auto CalcCurvature = [&CostGrid, Nx](const CostPoint &A, const CostPoint &B, const CostPoint &C) -> float {
-                float Height_A = float(CostGrid[A[0] + A[1] * Nx].Height);
-                float Height_B = float(CostGrid[B[0] + B[1] * Nx].Height);
-                float Height_C = float(CostGrid[C[0] + C[1] * Nx].Height);
-
-                Eigen::Vector4f BA = {float(A[0] - B[0]), float(A[1] - B[1]), float(Height_A - Height_B), float(A[2] - B[2])};
-                Eigen::Vector4f BC = {float(C[0] - B[0]), float(C[1] - B[1]), float(Height_C - Height_B), float(C[2] - B[2])};
-                float Magnitude_BC = BC.norm();
-
-                Eigen::Vector4f BA_Normalized = BA.normalized();
-                Eigen::Vector4f BC_Normalized = BC.normalized();
-
-                float Magnitude_Change = (BC_Normalized - BA_Normalized).norm();
-                return Magnitude_Change / (Magnitude_BC * Magnitude_BC) * BC.z();
-            };
-
-            const size_t IndexMax = AutoParameter->Nx * AutoParameter->Ny - 1;
-            std::function<float(const CostPoint &, const CostPoint &)> CostFunc = [&CalcCurvature, &HeightCostFunc, &GradientCostFunc, &CurvatureCostFunc, &CostGrid, &Predecessor, IndexMax, Nx, Ny](const CostPoint &A, const CostPoint &B) mutable -> float {
-                size_t ia = A[0] + A[1] * Nx;
-                size_t ib = B[0] + B[1] * Nx;
-
-                //constexpr size_t Seed = 12306;
-                //size_t Hash = (ia + 0x9e3779b9 + (Seed << 4) + (Seed >> 2)) ^ (ib * 0x9e3779b9 + (Seed << 2) + (Seed >> 4));
-
-                // We assume that A already searched and have a predecessor
-                const CostPoint &PrevPoint = Predecessor[A];
-
-                // Calc curvature
-                float Curvature = CalcCurvature(PrevPoint, A, B);
-
-                float Cost = HeightCostFunc(float(std::abs(CostGrid[ia].Height - CostGrid[ib].Height))) + GradientCostFunc(float(std::abs(CostGrid[ia].Gradient - CostGrid[ib].Gradient))) + CurvatureCostFunc(float(std::abs(Curvature)));
-                return Cost;
-            };
-
             zeno::log_info("[Roads] Generating trajectory...");
 
-            ROADS_TIMING_PRE_GENERATED;
-
-            ROADS_TIMING_BLOCK("AStar Extended", roads::energy::RoadsShortestPath(StartPoint, GoalPoint, CostPoint{static_cast<size_t>(AutoParameter->Nx), static_cast<size_t>(AutoParameter->Ny)}, AutoParameter->ConnectiveMask, AutoParameter->AngleMask, AutoParameter->WeightHeuristic, Predecessor, CostMap, CostFunc));
-
-            zeno::log_info("[Roads] Result Predecessor Size: {}; CostMap Size: {}", Predecessor.size(), CostMap.size());
+            energy::DenseGridPlanner Planner(Nx, Ny, AutoParameter->ConnectiveMask);
+            ArrayList<energy::DenseGridPlanner::Path> Paths;
 
-            CostPoint Current = GoalPoint;
-
-            ArrayList<size_t> Path;
-            while (Current != StartPoint) {
-                Path.push_back(Current[0] + Current[1] * AutoParameter->Nx);
-                Current = Predecessor[Current];
+            ROADS_TIMING_PRE_GENERATED;
+            if (Queries.size() == 1) {
+                ROADS_TIMING_BLOCK("AStar Dense Grid", Paths.push_back(Planner.Solve(Queries[0].first, Queries[0].second, AutoParameter->WeightHeuristic, Kernel)));
+            } else {
+                ROADS_TIMING_BLOCK("AStar Dense Grid", Paths = Planner.SolveBatch(Queries, AutoParameter->WeightHeuristic, Kernel));
             }
-            Path.push_back(StartPoint[0] + StartPoint[1] * AutoParameter->Nx);
 
             if (AutoParameter->bRemoveTriangles) {
                 AutoParameter->Primitive->tris.clear();
             }
 
-            AutoParameter->Primitive->lines.resize(Path.size() - 1);
-            for (size_t i = 0; i < Path.size() - 1; ++i) {
-                AutoParameter->Primitive->lines[i] = zeno::vec2i(int(Path[i]), int(Path[i + 1]));
+            AutoParameter->Primitive->lines.clear();
+            for (size_t q = 0; q < Paths.size(); ++q) {
+                const auto &Path = Paths[q].Cells;
+                if (!Paths[q].bFound) {
+                    zeno::log_warn("[Roads] No path from cell {} to cell {}.", Queries[q].first, Queries[q].second);
+                    continue;
+                }
+                zeno::log_info("[Roads] Path {}: {} cells, cost {}", q, Path.size(), Paths[q].Cost);
+                for (size_t i = 0; i + 1 < Path.size(); ++i) {
+                    AutoParameter->Primitive->lines.push_back(zeno::vec2i(int(Path[i]), int(Path[i + 1])));
+                }
             }
         }
     };
@@ -578,54 +592,27 @@ namespace {
             zeno::AttrVector<zeno::vec3f>& PositionAttr = Mesh->verts;
             zeno::AttrVector<float>& RoadMaskk = AutoParameter->RoadMask;
 
-            std::vector<float> UpdatedHeightField(PositionAttr.size());
+            // Gaussian weighted, slope aware smoothing of the masked cells; each epoch reads the
+            // previous epoch's heights, buffers are allocated once and reused
+            DynamicGrid<float> HeightField(Nx, Ny), SmoothedField(Nx, Ny), Scratch(Nx, Ny);
+#pragma omp parallel for
+            for (int32_t i = 0; i < HeightField.size(); ++i) {
+                HeightField[i] = PositionAttr[i][1];
+            }
 
             for (int32_t Epoch = 0; Epoch < Epochs; ++Epoch) {
+                filter::SlopeAwareFilter(HeightField, SmoothedField, SmoothRadius, SlopeThreshold, OverThresholdWeightRatio, Scratch);
 #pragma omp parallel for
-                for (int32_t y = 0; y < Ny; ++y) {
-                    for (int32_t x = 0; x < Nx; ++x) {
-                        int32_t Idx = y * Nx + x;
-                        if (0 != RoadMaskk[Idx]) {
-                            float HeightSummary = 0.0f;
-                            float WeightSummary = 0;
-
-                            for (int32_t dx = -SmoothRadius; dx <= SmoothRadius; ++dx) {
-                                for (int32_t dy = -SmoothRadius; dy <= SmoothRadius; ++dy) {
-                                    int32_t nx = x + dx;
-                                    int32_t ny = y + dy;
-
-                                    if (nx >= 0 && ny >= 0 && nx < Nx && ny < Ny) {
-                                        float Distance = std::sqrt(dx * dx + dy * dy);
-                                        float Slope = 0.0f;
-
-                                        if (Distance > 1e-3) {
-                                            Slope = std::abs<float>(PositionAttr[y*Nx + x][1] - PositionAttr[ny*Nx + nx][1]) / Distance;
-                                        }
-
-                                        float Weight = std::exp(-(dx*dx + dy*dy) / (2.0f * SmoothRadius * SmoothRadius));
-
-                                        if (Slope > SlopeThreshold) {
-                                            Weight *= OverThresholdWeightRatio;
-                                        }
-
-                                        HeightSummary += PositionAttr[ny * Nx + nx].at(1) * Weight;
-                                        WeightSummary += Weight;
-                                    }
-                                }
-                            }
-
-                            if (WeightSummary > 0) {
-                                UpdatedHeightField[Idx] = HeightSummary / WeightSummary;
-                            }
-                        }
-                    }
+                for (int32_t i = 0; i < HeightField.size(); ++i) {
+                    if (0 != RoadMaskk[i])
+                        HeightField[i] = SmoothedField[i];
                 }
             }
 
 #pragma omp parallel for
-            for (int32_t i = 0; i < UpdatedHeightField.size(); ++i) {
+            for (int32_t i = 0; i < HeightField.size(); ++i) {
                 if (0 != RoadMaskk[i])
-                    PositionAttr[i][1] = UpdatedHeightField[i];
+                    PositionAttr[i][1] = HeightField[i];
             }
         }
     };
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "pch.h"
+
+namespace roads::filter {
+
+    // Filters over Nx * Ny float grids (x fastest). Every filter runs as separate x and y
+    // sweeps, parallel over rows or blocks of columns; results go back into the field
+    // passed in, the caller owned Scratch grid (same size) is the second buffer, so that
+    // epochs of smoothing allocate nothing.
+
+    // Mean over the (2 * Radius + 1)^2 window clipped to the grid, via running sums:
+    // O(1) per cell whatever the radius.
+    ROADS_API void BoxFilter(DynamicGrid<float> &Field, int32_t Radius, DynamicGrid<float> &Scratch);
+
+    // Gaussian of the given standard deviation, approximated by three box filters,
+    // so also O(1) per cell.
+    ROADS_API void GaussianFilter(DynamicGrid<float> &Field, float Sigma, DynamicGrid<float> &Scratch);
+
+    // Gaussian weights exp(-d^2 / (2 Radius^2)) over the window clipped to the grid, where
+    // a neighbour steeper than SlopeThreshold from the center (|dh| / distance, on In)
+    // has its weight scaled by OverThresholdWeightRatio. Applied as an x then a y pass,
+    // O(Radius) per cell; exact when no neighbour is over the threshold.
+    ROADS_API void SlopeAwareFilter(const DynamicGrid<float> &In, DynamicGrid<float> &Out, int32_t Radius, float SlopeThreshold, float OverThresholdWeightRatio, DynamicGrid<float> &Scratch);
+
+}// namespace roads::filter
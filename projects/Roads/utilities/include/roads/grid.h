@@ -1,9 +1,15 @@
 #pragma once
 
 #include "pch.h"
+#include <algorithm>
+#include <cstdint>
+#include <exception>
 #include <functional>
+#include <limits>
+#include <mutex>
 #include <numeric>
 #include <queue>
+#include <stdexcept>
 #include <unordered_map>
 
 //#include "boost/graph/use_mpi.hpp"
@@ -191,6 +197,206 @@ namespace roads {
                 }
             }
         }
+
+        // A* over a dense Nx * Ny grid. Cells are indexed x + y * Nx, the search keeps its
+        // costs and predecessors in flat arrays (the predecessor as an index into the
+        // move offsets), reused across queries through a generation stamp.
+        //
+        // The cost kernel is called as Kernel(Prev, From, To) with cell indices, Prev being
+        // the predecessor of From (From itself at the start), and must not be negative.
+        // Its type is a template parameter so it can be inlined into the search loop.
+        class DenseGridPlanner {
+        public:
+            struct Path {
+                ArrayList<size_t> Cells;// goal to start
+                float Cost = std::numeric_limits<float>::max();
+                bool bFound = false;
+            };
+
+            DenseGridPlanner(size_t InNx, size_t InNy, int32_t InMaskK) : Nx(InNx), Ny(InNy), MaskK(std::max(InMaskK, 1)) {
+                for (int32_t dx = -MaskK; dx <= MaskK; ++dx) {
+                    for (int32_t dy = -MaskK; dy <= MaskK; ++dy) {
+                        if (GreatestCommonDivisor(std::abs(dx), std::abs(dy)) == 1) {
+                            Offsets.push_back({dx, dy});
+                        }
+                    }
+                }
+                if (Offsets.size() >= NoPredecessor) {
+                    throw std::runtime_error("[Roads] Connective mask too large.");
+                }
+            }
+
+            // Queries are (start, goal) cell pairs, solved in parallel with one workspace per thread.
+            // An error in any query (e.g. a negative cost) is rethrown once the batch is done,
+            // exceptions must not leave the parallel region.
+            template<typename CostKernelType>
+            ArrayList<Path> SolveBatch(const ArrayList<std::pair<size_t, size_t>> &Queries, float WeightHeuristic, const CostKernelType &Kernel) const {
+                ArrayList<Path> Result(Queries.size());
+                std::exception_ptr Error;
+                std::mutex ErrorMutex;
+#pragma omp parallel
+                {
+                    Workspace Space;
+#pragma omp for schedule(dynamic, 1)
+                    for (int64_t i = 0; i < int64_t(Queries.size()); ++i) {
+                        try {
+                            Result[i] = Solve(Space, Queries[i].first, Queries[i].second, WeightHeuristic, Kernel);
+                        } catch (...) {
+                            std::lock_guard<std::mutex> Lock(ErrorMutex);
+                            if (!Error) {
+                                Error = std::current_exception();
+                            }
+                        }
+                    }
+                }
+                if (Error) {
+                    std::rethrow_exception(Error);
+                }
+                return Result;
+            }
+
+            template<typename CostKernelType>
+            Path Solve(size_t Start, size_t Goal, float WeightHeuristic, const CostKernelType &Kernel) const {
+                Workspace Space;
+                return Solve(Space, Start, Goal, WeightHeuristic, Kernel);
+            }
+
+        private:
+            struct Workspace {
+                ArrayList<float> CostTo;
+                ArrayList<uint16_t> Predecessor;// index into Offsets, NoPredecessor at the start
+                ArrayList<uint32_t> Stamp;     // cell is reached in this query iff Stamp == Generation
+                ArrayList<uint8_t> Closed;
+                uint32_t Generation = 0;
+            };
+
+            // Fewest moves from A to B, since a move spans at most MaskK cells on either axis.
+            float StepCount(size_t A, size_t B) const {
+                int64_t dx = std::abs(int64_t(A % Nx) - int64_t(B % Nx));
+                int64_t dy = std::abs(int64_t(A / Nx) - int64_t(B / Nx));
+                return float((std::max(dx, dy) + MaskK - 1) / MaskK);
+            }
+
+            template<typename CostKernelType>
+            Path Solve(Workspace &Space, size_t Start, size_t Goal, float WeightHeuristic, const CostKernelType &Kernel) const {
+                Path Result;
+                const size_t NumCells = Nx * Ny;
+                if (Start >= NumCells || Goal >= NumCells) {
+                    return Result;
+                }
+                if (Space.Stamp.size() != NumCells) {
+                    Space.CostTo.resize(NumCells);
+                    Space.Predecessor.resize(NumCells);
+                    Space.Stamp.assign(NumCells, 0);
+                    Space.Closed.resize(NumCells);
+                    Space.Generation = 0;
+                }
+                if (++Space.Generation == 0) {
+                    std::fill(Space.Stamp.begin(), Space.Stamp.end(), 0);
+                    Space.Generation = 1;
+                }
+                const uint32_t Generation = Space.Generation;
+
+                // Heuristic: fewest remaining moves times the average cost per move of a walk
+                // from start to goal, scaled by WeightHeuristic. That average is an estimate,
+                // not a lower bound of the cost per move, so only a zero weight guarantees the
+                // cheapest path; a nonzero weight expands fewer cells at the price of possibly
+                // costlier paths, the larger the weight the more so.
+                float StepCost = 0.0f;
+                if (Start != Goal && WeightHeuristic > 0) {
+                    const int64_t gx = int64_t(Goal % Nx), gy = int64_t(Goal / Nx);
+                    size_t Prev = Start, From = Start;
+                    float Total = 0.0f;
+                    int32_t Steps = 0;
+                    while (From != Goal) {
+                        // Take the move in Offsets landing closest to the goal. The unit move
+                        // towards it is always one of them, so every step gets closer.
+                        const int64_t x = int64_t(From % Nx), y = int64_t(From / Nx);
+                        int64_t BestDist = std::numeric_limits<int64_t>::max();
+                        size_t To = From;
+                        for (const auto &Offset : Offsets) {
+                            const int64_t nx = x + Offset[0], ny = y + Offset[1];
+                            if (nx < 0 || ny < 0 || nx >= int64_t(Nx) || ny >= int64_t(Ny)) continue;
+                            const int64_t Dist = (gx - nx) * (gx - nx) + (gy - ny) * (gy - ny);
+                            if (Dist < BestDist) {
+                                BestDist = Dist;
+                                To = size_t(nx + ny * int64_t(Nx));
+                            }
+                        }
+                        Total += Kernel(Prev, From, To);
+                        Prev = From;
+                        From = To;
+                        ++Steps;
+                    }
+                    StepCost = WeightHeuristic * Total / float(Steps);
+                }
+
+                using QueueItem = std::pair<float, size_t>;
+                std::priority_queue<QueueItem, ArrayList<QueueItem>, std::greater<QueueItem>> Q;
+                Space.Stamp[Start] = Generation;
+                Space.CostTo[Start] = 0.0f;
+                Space.Predecessor[Start] = NoPredecessor;
+                Space.Closed[Start] = 0;
+                Q.push({StepCost * StepCount(Start, Goal), Start});
+
+                while (!Q.empty()) {
+                    const size_t Cell = Q.top().second;
+                    Q.pop();
+                    if (Space.Closed[Cell]) {
+                        continue;
+                    }
+                    Space.Closed[Cell] = 1;
+                    if (Cell == Goal) {
+                        break;
+                    }
+
+                    const int64_t x = int64_t(Cell % Nx), y = int64_t(Cell / Nx);
+                    const uint16_t PrevDir = Space.Predecessor[Cell];
+                    const size_t Prev = PrevDir == NoPredecessor ? Cell : size_t(Cell - Offsets[PrevDir][0] - Offsets[PrevDir][1] * int64_t(Nx));
+                    const float BaseCost = Space.CostTo[Cell];
+
+                    for (size_t Dir = 0; Dir < Offsets.size(); ++Dir) {
+                        const int64_t nx = x + Offsets[Dir][0], ny = y + Offsets[Dir][1];
+                        if (nx < 0 || ny < 0 || nx >= int64_t(Nx) || ny >= int64_t(Ny)) continue;
+                        const size_t Next = size_t(nx + ny * int64_t(Nx));
+                        const bool bReached = Space.Stamp[Next] == Generation;
+                        if (bReached && Space.Closed[Next]) continue;
+
+                        const float EdgeCost = Kernel(Prev, Cell, Next);
+                        if (EdgeCost < 0) {
+                            throw std::runtime_error("[Roads] Graph should not have negative weight. Check your curve !");
+                        }
+                        const float NewCost = BaseCost + EdgeCost;
+                        if (!bReached || NewCost < Space.CostTo[Next]) {
+                            Space.Stamp[Next] = Generation;
+                            Space.Closed[Next] = 0;
+                            Space.CostTo[Next] = NewCost;
+                            Space.Predecessor[Next] = uint16_t(Dir);
+                            Q.push({NewCost + StepCost * StepCount(Next, Goal), Next});
+                        }
+                    }
+                }
+
+                if (Space.Stamp[Goal] != Generation || !Space.Closed[Goal]) {
+                    return Result;
+                }
+                Result.bFound = true;
+                Result.Cost = Space.CostTo[Goal];
+                for (size_t Cell = Goal;;) {
+                    Result.Cells.push_back(Cell);
+                    const uint16_t Dir = Space.Predecessor[Cell];
+                    if (Dir == NoPredecessor) break;
+                    Cell = size_t(Cell - Offsets[Dir][0] - Offsets[Dir][1] * int64_t(Nx));
+                }
+                return Result;
+            }
+
+            static constexpr uint16_t NoPredecessor = 0xffff;
+
+            size_t Nx, Ny;
+            int32_t MaskK;
+            ArrayList<std::array<int32_t, 2>> Offsets;
+        };
     }// namespace energy
 
     namespace spline {
@@ -1,5 +1,6 @@
 #pragma once
 
 #include "pch.h"
+#include "filter.h"
 #include "grid.h"
 #include "kdtree.h"
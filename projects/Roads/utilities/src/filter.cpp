@@ -0,0 +1,152 @@
+#include "roads/filter.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace roads;
+
+namespace {
+    // Columns swept together by the y passes, so that every row access is a contiguous run.
+    constexpr int64_t ColumnBlock = 64;
+
+    // Box along x, In -> Out, through a prefix sum of each row.
+    void BoxFilterX(const DynamicGrid<float> &In, DynamicGrid<float> &Out, int64_t Radius) {
+        const int64_t Nx = In.Nx, Ny = In.Ny;
+#pragma omp parallel
+        {
+            ArrayList<double> Prefix(Nx + 1);
+#pragma omp for
+            for (int64_t y = 0; y < Ny; ++y) {
+                const float *Row = In.data() + y * Nx;
+                float *OutRow = Out.data() + y * Nx;
+                Prefix[0] = 0.0;
+                for (int64_t x = 0; x < Nx; ++x) {
+                    Prefix[x + 1] = Prefix[x] + Row[x];
+                }
+                for (int64_t x = 0; x < Nx; ++x) {
+                    const int64_t Lo = std::max<int64_t>(x - Radius, 0);
+                    const int64_t Hi = std::min<int64_t>(x + Radius, Nx - 1);
+                    OutRow[x] = float((Prefix[Hi + 1] - Prefix[Lo]) / double(Hi - Lo + 1));
+                }
+            }
+        }
+    }
+
+    // Box along y, In -> Out, with a running sum per column of a block.
+    void BoxFilterY(const DynamicGrid<float> &In, DynamicGrid<float> &Out, int64_t Radius) {
+        const int64_t Nx = In.Nx, Ny = In.Ny;
+        const int64_t NumBlocks = (Nx + ColumnBlock - 1) / ColumnBlock;
+#pragma omp parallel for
+        for (int64_t Block = 0; Block < NumBlocks; ++Block) {
+            const int64_t X0 = Block * ColumnBlock;
+            const int64_t Width = std::min(ColumnBlock, Nx - X0);
+            double Sum[ColumnBlock] = {};
+            for (int64_t y = 0; y <= std::min(Radius, Ny - 1); ++y) {
+                for (int64_t i = 0; i < Width; ++i) {
+                    Sum[i] += In[X0 + i + y * Nx];
+                }
+            }
+            for (int64_t y = 0; y < Ny; ++y) {
+                const int64_t Lo = std::max<int64_t>(y - Radius, 0);
+                const int64_t Hi = std::min<int64_t>(y + Radius, Ny - 1);
+                const double InvCount = 1.0 / double(Hi - Lo + 1);
+                for (int64_t i = 0; i < Width; ++i) {
+                    Out[X0 + i + y * Nx] = float(Sum[i] * InvCount);
+                }
+                if (y + Radius + 1 < Ny) {
+                    for (int64_t i = 0; i < Width; ++i) {
+                        Sum[i] += In[X0 + i + (y + Radius + 1) * Nx];
+                    }
+                }
+                if (y - Radius >= 0) {
+                    for (int64_t i = 0; i < Width; ++i) {
+                        Sum[i] -= In[X0 + i + (y - Radius) * Nx];
+                    }
+                }
+            }
+        }
+    }
+
+    ArrayList<float> GaussianWeights(int64_t Radius) {
+        ArrayList<float> Weights(2 * Radius + 1);
+        for (int64_t d = -Radius; d <= Radius; ++d) {
+            Weights[d + Radius] = std::exp(-float(d * d) / (2.0f * float(Radius * Radius)));
+        }
+        return Weights;
+    }
+}// namespace
+
+void roads::filter::BoxFilter(DynamicGrid<float> &Field, int32_t Radius, DynamicGrid<float> &Scratch) {
+    if (Radius <= 0 || Field.empty()) return;
+    BoxFilterX(Field, Scratch, Radius);
+    BoxFilterY(Scratch, Field, Radius);
+}
+
+void roads::filter::GaussianFilter(DynamicGrid<float> &Field, float Sigma, DynamicGrid<float> &Scratch) {
+    if (Sigma <= 0 || Field.empty()) return;
+    // Widths of three boxes whose convolution has variance Sigma^2 (odd widths wl, wl + 2).
+    constexpr int32_t NumBoxes = 3;
+    const float IdealWidth = std::sqrt(12.0f * Sigma * Sigma / NumBoxes + 1.0f);
+    int32_t wl = int32_t(std::floor(IdealWidth));
+    if (wl % 2 == 0) --wl;
+    const int32_t wu = wl + 2;
+    const int32_t m = int32_t(std::round((12.0f * Sigma * Sigma - NumBoxes * wl * wl - 4 * NumBoxes * wl - 3 * NumBoxes) / (-4.0f * wl - 4.0f)));
+    for (int32_t i = 0; i < NumBoxes; ++i) {
+        BoxFilter(Field, ((i < m ? wl : wu) - 1) / 2, Scratch);
+    }
+}
+
+void roads::filter::SlopeAwareFilter(const DynamicGrid<float> &In, DynamicGrid<float> &Out, int32_t Radius, float SlopeThreshold, float OverThresholdWeightRatio, DynamicGrid<float> &Scratch) {
+    const int64_t Nx = In.Nx, Ny = In.Ny;
+    if (Radius <= 0 || In.empty()) {
+        std::copy(In.begin(), In.end(), Out.begin());
+        return;
+    }
+    const int64_t R = Radius;
+    const ArrayList<float> Weights = GaussianWeights(R);
+    auto SlopeWeight = [SlopeThreshold, OverThresholdWeightRatio](float Center, float Neighbour, int64_t Distance) {
+        return std::abs(Center - Neighbour) / float(std::abs(Distance)) > SlopeThreshold ? OverThresholdWeightRatio : 1.0f;
+    };
+
+    // x pass, In -> Scratch
+#pragma omp parallel for
+    for (int64_t y = 0; y < Ny; ++y) {
+        const float *Row = In.data() + y * Nx;
+        for (int64_t x = 0; x < Nx; ++x) {
+            float HeightSummary = 0.0f, WeightSummary = 0.0f;
+            const int64_t Lo = std::max<int64_t>(-R, -x), Hi = std::min<int64_t>(R, Nx - 1 - x);
+            for (int64_t dx = Lo; dx <= Hi; ++dx) {
+                float Weight = Weights[dx + R];
+                if (dx != 0) Weight *= SlopeWeight(Row[x], Row[x + dx], dx);
+                HeightSummary += Row[x + dx] * Weight;
+                WeightSummary += Weight;
+            }
+            Scratch[x + y * Nx] = HeightSummary / WeightSummary;
+        }
+    }
+
+    // y pass, Scratch -> Out, slopes still taken on In; rows are accumulated whole
+#pragma omp parallel
+    {
+        ArrayList<float> HeightSummary(Nx), WeightSummary(Nx);
+#pragma omp for
+        for (int64_t y = 0; y < Ny; ++y) {
+            std::fill(HeightSummary.begin(), HeightSummary.end(), 0.0f);
+            std::fill(WeightSummary.begin(), WeightSummary.end(), 0.0f);
+            const float *Center = In.data() + y * Nx;
+            const int64_t Lo = std::max<int64_t>(-R, -y), Hi = std::min<int64_t>(R, Ny - 1 - y);
+            for (int64_t dy = Lo; dy <= Hi; ++dy) {
+                const float *Source = Scratch.data() + (y + dy) * Nx;
+                const float *Neighbour = In.data() + (y + dy) * Nx;
+                const float BaseWeight = Weights[dy + R];
+                for (int64_t x = 0; x < Nx; ++x) {
+                    const float Weight = dy != 0 ? BaseWeight * SlopeWeight(Center[x], Neighbour[x], dy) : BaseWeight;
+                    HeightSummary[x] += Source[x] * Weight;
+                    WeightSummary[x] += Weight;
+                }
+            }
+            for (int64_t x = 0; x < Nx; ++x) {
+                Out[x + y * Nx] = HeightSummary[x] / WeightSummary[x];
+            }
+        }
+    }
+}
@@ -5,14 +5,11 @@
 #include <zeno/PrimitiveObject.h>
 #include <zeno/utils/UserData.h>
 #include <zeno/StringObject.h>
+#include <zeno/types/SkinBindingObject.h>
 
 #include <igl/directed_edge_parents.h>
 #include <igl/forward_kinematics.h>
 #include <igl/deform_skeleton.h>
-#include <igl/dqs.h>
-
-
-#include <igl/lbs_matrix.h>
 
 #include "skinning_iobject.h"
 
@@ -68,7 +65,58 @@ ZENDEFNODE(BlendPoses, {
     {"Skinning"},
 });
 
-// input the forward kinematics result
+// number of per-handle weight attributes prefix_0, prefix_1, ... of the shape
+size_t countSkinHandles(PrimitiveObject *shape, std::string const &attr_prefix) {
+    size_t nm_handles = 0;
+    while(shape->has_attr(attr_prefix + "_" + std::to_string(nm_handles)))
+        nm_handles++;
+    return nm_handles;
+}
+
+// packs the nonzero weights of the per-handle attributes into a binding, so that the
+// dense weight matrix is read once per mesh instead of once per frame
+std::shared_ptr<SkinBindingObject> bindSkinWeights(PrimitiveObject *shape, std::string const &attr_prefix, int maxInfluences) {
+    size_t nm_handles = countSkinHandles(shape, attr_prefix);
+    std::vector<float const *> W(nm_handles);
+    for(size_t i = 0;i < nm_handles;++i)
+        W[i] = shape->attr<float>(attr_prefix + "_" + std::to_string(i)).data();
+
+    std::vector<int> offsets(shape->size() + 1, 0), joints;
+    std::vector<float> weights;
+    for(size_t j = 0;j < shape->size();++j){
+        for(size_t i = 0;i < nm_handles;++i){
+            if(std::isnan(W[i][j])){
+                std::cout << "NAN VALUE DETECTED IN SKINNING WEIGHT MATRIX : " << j << "\t" << i << "\t" << W[i][j] << std::endl;
+                throw std::runtime_error("NAN VALUE DETECTED IN SKINNING WEIGHT MATRIX");
+            }
+            if(W[i][j] != 0){
+                joints.push_back(i);
+                weights.push_back(W[i][j]);
+            }
+        }
+        offsets[j + 1] = joints.size();
+    }
+    return skinBind(offsets, joints, weights, maxInfluences);
+}
+
+struct MakeSkinBinding : zeno::INode {
+    virtual void apply() override {
+        auto shape = get_input<PrimitiveObject>("shape");
+        auto attr_prefix = get_param<std::string>("attr_prefix");
+        auto maxInfluences = get_param<int>("maxInfluences");
+        set_output("binding",bindSkinWeights(shape.get(),attr_prefix,maxInfluences));
+    }
+};
+
+ZENDEFNODE(MakeSkinBinding, {
+    {"shape"},
+    {"binding"},
+    {{"string","attr_prefix","sw"},{"int","maxInfluences","0"}},
+    {"Skinning"},
+});
+
+// input the forward kinematics result, the binding is made from the shape's weight
+// attributes when not given
 struct DoSkinning : zeno::INode {
     virtual void apply() override {
         auto shape = get_input<PrimitiveObject>("shape");
@@ -79,40 +127,12 @@ struct DoSkinning : zeno::INode {
         auto Qs_ = get_input<zeno::ListObject>("Qs")->get<NumericObject>();
         auto Ts_ = get_input<zeno::ListObject>("Ts")->get<NumericObject>();
 
-        // std::cout << "GOT QS AND TS INPUT" << std::endl;
-        size_t dim = 3;
-        size_t nm_handles = 0;
-
-
-        auto& out_chan = shape->add_attr<zeno::vec3f>(outputChannel);
-        // std::cout << "CHECKOUT_1" << std::endl;
-
-        while(true){
-            std::string attr_name = attr_prefix + "_" + std::to_string(nm_handles);
-            if(shape->has_attr(attr_name)){
-                nm_handles++;
-                continue;
-            }
-            break;
-        }
-
-        Eigen::MatrixXd W;
-        W.resize(shape->size(),nm_handles);
-        for(size_t i = 0;i < nm_handles;++i){ 
-            std::string attr_name = attr_prefix +  "_" + std::to_string(i);
-            for(size_t j = 0;j < shape->size();++j){
-                if(!shape->has_attr(attr_name)){
-                    std::cout << "DO NOT HAVE " << attr_name << std::endl;
-                    std::cout << "NM_QS_AND_TS : " << nm_handles << std::endl;
-                    throw std::runtime_error("The Skinned Prim Does Not Have Weight Attr");
-                }
-                W(j,i) = shape->attr<float>(attr_name)[j];
-                if(std::isnan(W(j,i))){
-                    std::cout << "NAN VALUE DETECTED IN SKINNING WEIGHT MATRIX : " << j << "\t" << i << "\t" << W(j,i) << std::endl;
-                    throw std::runtime_error("NAN VALUE DETECTED IN SKINNING WEIGHT MATRIX");
-                }
-            }
-        }
+        auto binding = has_input("binding") ? get_input<SkinBindingObject>("binding") : bindSkinWeights(shape.get(),attr_prefix,0);
+        size_t nm_handles = has_input("binding") ? Qs_.size() : countSkinHandles(shape.get(),attr_prefix);
+        if(binding->size() != shape->size())
+            throw std::runtime_error("THE SKIN BINDING DOES NOT MATCH THE SHAPE");
+        if(Qs_.size() < nm_handles || Ts_.size() < nm_handles)
+            throw std::runtime_error("NOT ENOUGH QS AND TS FOR THE SKINNING HANDLES");
 
         std::vector<Eigen::Vector3d> Ts;
         RotationList Qs;
@@ -186,66 +206,26 @@ struct DoSkinning : zeno::INode {
 
 
 
-        // std::cout << "CHECKOUT_3" << std::endl;
-
-        Eigen::MatrixXd T(nm_handles*(dim+1),dim);
-        for(int e = 0;e<nm_handles;e++){
+        std::vector<SkinBindingObject::Matrix> T(nm_handles);
+        for(size_t e = 0;e < nm_handles;e++){
             Eigen::Affine3d a = Eigen::Affine3d::Identity();
             a.translate(Ts[e]);
             a.rotate(Qs[e]);
-            T.block(e*(dim+1),0,dim+1,dim) =
-                a.matrix().transpose().block(0,0,dim+1,dim);
+            for(int r = 0;r < 3;r++)
+                T[e][r] = zeno::vec4f(a(r,0),a(r,1),a(r,2),a(r,3));
         }
-        // Compute deformation via LBS as matrix multiplication
-        Eigen::MatrixXd U,V;
-        V.resize(shape->size(),3);
-        for(size_t i = 0;i < V.rows();++i)
-            V.row(i) << shape->verts[i][0],shape->verts[i][1],shape->verts[i][2];
-
-
-        if(std::isnan(V.norm()) || std::isnan(W.norm()) || std::isnan(T.norm())){
-            std::cout << V.norm() << "\t" << W.norm() << std::endl;
-            throw std::runtime_error("IN SKINNING NAN VW DETECTED");
-        }
-
-        if(algorithm == "DQS"){
-            // std::cout << "DQS SKINNING " << std::endl;
-            igl::dqs(V,W,Qs,Ts,U);
-        }else if(algorithm == "LBS"){
-            Eigen::MatrixXd M;
-            igl::lbs_matrix(V,W,M);
-            U = M*T;
-        }        
 
         auto deformed_shape = std::make_shared<zeno::PrimitiveObject>(*shape);// automatic copy all the attributes
-        // deformed_shape->resize(shape->size());
-        // deformed_shape->tris.resize(shape->tris.size());
-        // deformed_shape->quads.resize(shape->quads.size());
-
-        if(std::isnan(U.norm())){
-            std::cout << "W : \n" << W << std::endl;
-            std::cout << "NAN DEFORMED SHAPE DETECTED: " << U.norm() << std::endl;
-            std::cout << "AFFINE : " << std::endl;
-            for(size_t i = 0;i < nm_handles;++i){
-                std::cout << Qs[i].x() << "\t" 
-                            << Qs[i].y() << "\t" 
-                            << Qs[i].z() << "\t" 
-                            << Qs[i].w() << std::endl;
-                std::cout << Ts[i].transpose() << std::endl;
-            }
-
-            throw std::runtime_error("NAN DEFORMED SHAPE DETECTED");
-        }
-        // std::cout << "CHECKOUT_4" << std::endl;
-        for(size_t i = 0;i < deformed_shape->size();++i)
-            out_chan[i] = zeno::vec3f(U.row(i)[0],U.row(i)[1],U.row(i)[2]);
+        auto& out_chan = deformed_shape->add_attr<zeno::vec3f>(outputChannel);
+        std::copy(shape->verts.begin(),shape->verts.end(),out_chan.begin());
+        skinDeform(*binding,T,algorithm == "DQS",out_chan.data());
 
         set_output("dshape",std::move(deformed_shape));
     }
 };
 
 ZENDEFNODE(DoSkinning, {
-    {"shape","Qs","Ts","restBones"},
+    {"shape","Qs","Ts","restBones","binding"},
     {"dshape"},
     {{"enum LBS DQS","algorithm","DQS"},{"string","attr_prefix","sw"},{"string","out_channel","curPos"},{"int","FK","0"}},
     {"Skinning"},
@@ -4,6 +4,7 @@
 #include <cstring>
 #include <string>
 #include <map>
+#include <mutex>
 
 namespace zfx::x64 {
 
@@ -48,8 +49,10 @@ struct Executable {
 
 struct Assembler {
     std::map<std::string, std::unique_ptr<Executable>> cache;
+    std::mutex mtx;
 
     Executable *assemble(std::string const &lines) {
+        std::lock_guard lck(mtx);
         if (auto it = cache.find(lines); it != cache.end()) {
             return it->second.get();
         }
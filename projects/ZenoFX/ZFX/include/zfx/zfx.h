@@ -7,6 +7,7 @@
 #include <memory>
 #include <tuple>
 #include <map>
+#include <mutex>
 
 namespace zfx {
 
@@ -117,7 +118,9 @@ struct Program {
 };
 
 struct Compiler {
+    // programs are never evicted, wrangle nodes keep the raw pointers handed out
     std::map<std::string, std::unique_ptr<Program>> cache;
+    std::mutex mtx;
 
     Program *compile
         ( std::string const &code
@@ -128,6 +131,7 @@ struct Compiler {
         options.dump(ss);
         auto key = ss.str();
 
+        std::lock_guard lck(mtx);
         auto it = cache.find(key);
         if (it != cache.end()) {
             return it->second.get();
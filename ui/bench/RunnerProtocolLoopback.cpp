@@ -0,0 +1,166 @@
+// loopback round-trip test of the editor <-> persistent runner protocol, exits non-zero on failure,
+// usage: zeno_runner_protocol_loopback
+#include "launch/runnerprotocol.h"
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+int g_failures = 0;
+
+void check(bool ok, char const *what) {
+    printf("  %-56s %s\n", what, ok ? "ok" : "FAILED");
+    if (!ok)
+        g_failures++;
+}
+
+bool sameOptions(RunRequest const &a, RunRequest const &b) {
+    return a.action == b.action && a.sessionid == b.sessionid && a.enableCache == b.enableCache
+        && a.cacheNum == b.cacheNum && a.cacheDir == b.cacheDir
+        && a.applyLightAndCameraOnly == b.applyLightAndCameraOnly
+        && a.applyMaterialOnly == b.applyMaterialOnly && a.autoRmCurcache == b.autoRmCurcache;
+}
+
+// runner side, the same loop as runner_serve: answer each request with a runFinished packet
+// whose payload echoes the options and commands the runner ended up with.
+std::string serve(std::istream &in, RunRequest req, std::string &err) {
+    std::string out, progJson;
+    // log lines may be interleaved with the packets
+    out += "runner started\n";
+    while (readRunRequest(in, req, progJson, err)) {
+        std::string echo = encodeRunRequest(req, progJson);
+        std::string info = "{\"action\":\"runFinished\",\"key\":\"0\"}";
+        auto head = encodePacketHead(info, echo.size());
+        out.append(head.begin(), head.end());
+        out += echo;
+    }
+    return out;
+}
+
+// editor side, the same framing viewdecode.cpp expects.
+std::vector<std::pair<std::string, std::string>> decodePackets(std::string const &stream, bool &ok) {
+    std::vector<std::pair<std::string, std::string>> packets;
+    ok = true;
+    size_t pos = 0;
+    while ((pos = stream.find("\a\b\r\t", pos)) != std::string::npos) {
+        pos += 4;
+        RunnerPacketHeader header;
+        if (stream.size() - pos < sizeof(header)) {
+            ok = false;
+            break;
+        }
+        std::memcpy(&header, stream.data() + pos, sizeof(header));
+        pos += sizeof(header);
+        if (!header.isValid() || header.total_size < header.info_size || stream.size() - pos < header.total_size) {
+            ok = false;
+            break;
+        }
+        packets.emplace_back(stream.substr(pos, header.info_size),
+                             stream.substr(pos + header.info_size, header.total_size - header.info_size));
+        pos += header.total_size;
+    }
+    return packets;
+}
+
+void testRoundTrip() {
+    printf("round trip of load and patch requests:\n");
+    std::vector<std::pair<RunRequest, std::string>> sent;
+
+    RunRequest load;
+    load.action = "load";
+    load.sessionid = 3;
+    load.enableCache = true;
+    load.cacheNum = 12;
+    load.cacheDir = "/tmp/zen cache/\"quoted\"\\dir\n\xe7\xbc\x93\xe5\xad\x98";
+    load.applyLightAndCameraOnly = true;
+    load.autoRmCurcache = false;
+    // the payload may hold anything, including newlines and nul bytes
+    static const char loadJson[] = "[[\"addNode\",\"CreateCube\",\"a\"]]\n\0\n{";
+    sent.emplace_back(load, std::string(loadJson, sizeof(loadJson) - 1));
+
+    RunRequest patch = load;
+    patch.action = "patch";
+    patch.sessionid = 4;
+    patch.cacheNum = 1;
+    patch.cacheDir = "/tmp/other";
+    patch.applyLightAndCameraOnly = false;
+    patch.applyMaterialOnly = true;
+    patch.autoRmCurcache = true;
+    sent.emplace_back(patch, "[[\"clearNodeInputs\",\"a\"]]");
+
+    // cacheautorm switched back off between runs of the same runner
+    RunRequest empty = patch;
+    empty.autoRmCurcache = false;
+    empty.enableCache = false;
+    sent.emplace_back(empty, "");
+
+    std::stringstream pipe;
+    for (auto const &[req, progJson] : sent)
+        pipe << encodeRunRequest(req, progJson);
+
+    std::string err;
+    std::string reply = serve(pipe, RunRequest{}, err);
+    check(err.empty(), "runner reached the end of the stream cleanly");
+
+    bool ok = false;
+    auto packets = decodePackets(reply, ok);
+    check(ok, "reply packets are well framed");
+    check(packets.size() == sent.size(), "one reply per request");
+
+    bool allSame = packets.size() == sent.size();
+    for (size_t i = 0; allSame && i < sent.size(); i++) {
+        allSame = packets[i].first == "{\"action\":\"runFinished\",\"key\":\"0\"}";
+        std::istringstream echo(packets[i].second);
+        RunRequest got;
+        std::string progJson, echoErr;
+        allSame = allSame && readRunRequest(echo, got, progJson, echoErr);
+        allSame = allSame && sameOptions(got, sent[i].first) && progJson == sent[i].second;
+    }
+    check(allSame, "runner saw every option and payload as sent");
+}
+
+void testDefaults() {
+    printf("requests from older editors:\n");
+    // a header without the cache options keeps what the runner had before
+    RunRequest req;
+    req.sessionid = 7;
+    req.cacheNum = 5;
+    req.autoRmCurcache = true;
+    std::istringstream in("\n\n{\"action\":\"load\",\"size\":2}\n[]");
+    std::string progJson, err;
+    bool ok = readRunRequest(in, req, progJson, err);
+    check(ok && progJson == "[]", "blank lines before the header are skipped");
+    check(req.action == "load" && req.sessionid == 7 && req.cacheNum == 5 && req.autoRmCurcache,
+          "missing options keep their previous value");
+}
+
+void testMalformed() {
+    printf("malformed requests:\n");
+    RunRequest req;
+    std::string progJson, err;
+
+    std::istringstream eof("");
+    check(!readRunRequest(eof, req, progJson, err) && err.empty(), "end of stream is not an error");
+
+    std::istringstream garbage("not json\n");
+    check(!readRunRequest(garbage, req, progJson, err) && !err.empty(), "invalid header is reported");
+
+    std::istringstream nosize("{\"action\":\"load\"}\n");
+    check(!readRunRequest(nosize, req, progJson, err) && !err.empty(), "header without size is reported");
+
+    std::istringstream truncated("{\"action\":\"patch\",\"size\":10}\nabc");
+    check(!readRunRequest(truncated, req, progJson, err) && !err.empty(), "truncated payload is reported");
+}
+
+}
+
+int main() {
+    testRoundTrip();
+    testDefaults();
+    testMalformed();
+    printf(g_failures ? "%d check(s) FAILED\n" : "all checks passed\n", g_failures);
+    return g_failures ? 1 : 0;
+}
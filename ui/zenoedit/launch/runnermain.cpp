@@ -23,6 +23,7 @@
 #include <zeno/utils/scope_exit.h>
 #include "corelaunch.h"
 #include "viewdecode.h"
+#include "runnerprotocol.h"
 #include "settings/zsettings.h"
 #include <zeno/funcs/ParseObjectFromUi.h>
 #include "startup/zstartup.h"
@@ -39,31 +40,8 @@ static FILE *ourfp;
 static char ourbuf[1 << 20]; // 1MB
 #endif
 
-struct Header { // sync with viewdecode.cpp
-    size_t total_size;
-    size_t info_size;
-    size_t magicnum;
-    size_t checksum;
-
-    void makeValid() {
-        magicnum = 314159265;
-        checksum = total_size ^ info_size ^ magicnum;
-    }
-};
-
 static void send_packet(std::string_view info, const char *buf, size_t len) {
-    Header header;
-    header.total_size = info.size() + len;
-    header.info_size = info.size();
-    header.makeValid();
-
-    std::vector<char> headbuffer(4 + sizeof(Header) + info.size());
-    headbuffer[0] = '\a';
-    headbuffer[1] = '\b';
-    headbuffer[2] = '\r';
-    headbuffer[3] = '\t';
-    std::memcpy(headbuffer.data() + 4, &header, sizeof(Header));
-    std::memcpy(headbuffer.data() + 4 + sizeof(Header), info.data(), info.size());
+    std::vector<char> headbuffer = encodePacketHead(info, len);
 
     zeno::log_debug("runner tx head-buffer {} data-buffer {}", headbuffer.size(), len);
 #ifdef ZENO_IPC_USE_TCP
@@ -85,18 +63,32 @@ static void send_packet(std::string_view info, const char *buf, size_t len) {
 #endif
 }
 
-static int runner_start(std::string const &progJson, int sessionid, const LAUNCH_PARAM& param) {
-    zeno::log_trace("runner got program JSON: {}", progJson);
-    //MessageBox(0, "runner", "runner", MB_OK);           //convient to attach process by debugger, at windows.
-    zeno::scope_exit sp([=]() { std::cout.flush(); });
-    //zeno::TimerAtexitHelper timerHelper;
+static RunRequest runner_request(int sessionid, const LAUNCH_PARAM& param) {
+    RunRequest req;
+    req.sessionid = sessionid;
+    req.enableCache = param.enableCache;
+    req.cacheNum = param.cacheNum;
+    req.cacheDir = param.cacheDir.toStdString();
+    req.applyLightAndCameraOnly = param.applyLightAndCameraOnly;
+    req.applyMaterialOnly = param.applyMaterialOnly;
+    req.autoRmCurcache = param.autoRmCurcache;
+    return req;
+}
+
+//per-run options come with each request, `param` only keeps the ones fixed by the process args.
+static void runner_reset(const RunRequest& req, LAUNCH_PARAM& param) {
+    param.enableCache = req.enableCache;
+    param.cacheNum = req.cacheNum;
+    param.cacheDir = QString::fromStdString(req.cacheDir);
+    param.applyLightAndCameraOnly = req.applyLightAndCameraOnly;
+    param.applyMaterialOnly = req.applyMaterialOnly;
+    param.autoRmCurcache = req.autoRmCurcache;
 
     auto session = &zeno::getSession();
-    session->globalState->sessionid = sessionid;
+    session->globalState->sessionid = req.sessionid;
     session->globalState->clearState();
     session->globalComm->clearState();
     session->globalStatus->clearState();
-    auto graph = session->createGraph();
 
     //$ZSG value
     zeno::setConfigVariable("ZSG", param.zsgPath.toStdString());
@@ -114,6 +106,12 @@ static int runner_start(std::string const &progJson, int sessionid, const LAUNCH
     else {
         zeno::getSession().globalComm->frameCache("", 0);
     }
+}
+
+static int runner_exec(zeno::Graph *graph, std::string const &progJson, bool bPatch, const LAUNCH_PARAM& param) {
+    zeno::log_trace("runner got program JSON: {}", progJson);
+    zeno::scope_exit sp([=]() { std::cout.flush(); });
+    auto session = &zeno::getSession();
 
     auto onfail = [&] {
         auto statJson = session->globalStatus->toJson();
@@ -122,7 +120,10 @@ static int runner_start(std::string const &progJson, int sessionid, const LAUNCH
     };
 
     zeno::GraphException::catched([&] {
-        graph->loadGraph(progJson.c_str());
+        if (bPatch)
+            graph->patchGraph(progJson.c_str());
+        else
+            graph->loadGraph(progJson.c_str());
     }, *session->globalStatus);
     if (session->globalStatus->failed())
         return onfail();
@@ -247,6 +248,7 @@ static int runner_start(std::string const &progJson, int sessionid, const LAUNCH
         } else {
             auto const& viewObjs = session->globalComm->getViewObjects();
             zeno::log_debug("runner got {} view objects", viewObjs.size());
+            //one object in the buffer at a time, a frame of big objects is never held encoded as a whole.
             for (auto const& [key, obj] : viewObjs) {
                 if (zeno::encodeObject(obj.get(), buffer))
                     send_packet("{\"action\":\"viewObject\",\"key\":\"" + key + "\"}",
@@ -263,6 +265,46 @@ static int runner_start(std::string const &progJson, int sessionid, const LAUNCH
     return 0;
 }
 
+static int runner_start(std::string const &progJson, int sessionid, LAUNCH_PARAM param) {
+    //MessageBox(0, "runner", "runner", MB_OK);           //convient to attach process by debugger, at windows.
+    //zeno::TimerAtexitHelper timerHelper;
+    runner_reset(runner_request(sessionid, param), param);
+    auto graph = zeno::getSession().createGraph();
+    return runner_exec(graph.get(), progJson, false, param);
+}
+
+// keep the graph alive between runs: each request on stdin is a one-line json
+// header ({"action":"load"|"patch","size":N, per-run cache options}) followed
+// by N bytes of graph commands. A patch only carries what changed since the
+// previous request, so untouched nodes stay clean and keep their caches.
+static int runner_serve(int sessionid, LAUNCH_PARAM param) {
+    std::shared_ptr<zeno::Graph> graph;
+    RunRequest req = runner_request(sessionid, param);
+    std::string progJson, err;
+    while (readRunRequest(std::cin, req, progJson, err)) {
+        runner_reset(req, param);
+        bool bPatch = req.action == "patch";
+        if (bPatch && !graph) {
+            zeno::log_error("runner got a patch without any graph loaded");
+            return 1;
+        }
+        if (!bPatch)
+            graph = zeno::getSession().createGraph();
+
+        int ret = runner_exec(graph.get(), progJson, bPatch, param);
+        if (ret != 0) {
+            //the editor forgets what it has sent as well, next request is a full load.
+            graph = nullptr;
+        }
+        send_packet("{\"action\":\"runFinished\",\"key\":\"" + std::to_string(ret) + "\"}", "", 0);
+    }
+    if (!err.empty()) {
+        zeno::log_error("runner got {}", err);
+        return 1;
+    }
+    return 0;
+}
+
 }
 int runner_main(const QCoreApplication& app);
 int runner_main(const QCoreApplication& app) {
@@ -291,6 +333,7 @@ int runner_main(const QCoreApplication& app) {
         {"projectFps", "current project fps", "fps"},
         {"objcachedir", "objcachedir", "obj temp cache dir"},
         {"generator", "generator", "the node ident which trigger generate command"},
+        {"persistent", "persistent", "keep the graph alive and read load/patch requests from stdin"},
         });
     cmdParser.process(app);
     if (cmdParser.isSet("sessionid"))
@@ -317,6 +360,9 @@ int runner_main(const QCoreApplication& app) {
         param.projectFps = cmdParser.value("projectFps").toInt();
     if (cmdParser.isSet("generator"))
         param.generator = cmdParser.value("generator");
+    bool bPersistent = false;
+    if (cmdParser.isSet("persistent"))
+        bPersistent = cmdParser.value("persistent").toInt();
 
     std::cerr.rdbuf(std::cout.rdbuf());
     std::clog.rdbuf(std::cout.rdbuf());
@@ -340,12 +386,6 @@ int runner_main(const QCoreApplication& app) {
 
     zeno::log_debug("runner started on sessionid={}", sessionid);
 
-    std::string progJson;
-    std::istreambuf_iterator<char> iit(std::cin.rdbuf()), eiit;
-    std::back_insert_iterator<std::string> sit(progJson);
-    std::copy(iit, eiit, sit);
-
-
 #ifdef ZENO_IPC_USE_TCP
     // Notify this is runner process
     static int calledOnce = ([]{
@@ -353,6 +393,14 @@ int runner_main(const QCoreApplication& app) {
     }(), 0);
 #endif
 
+    if (bPersistent)
+        return runner_serve(sessionid, param);
+
+    std::string progJson;
+    std::istreambuf_iterator<char> iit(std::cin.rdbuf()), eiit;
+    std::back_insert_iterator<std::string> sit(progJson);
+    std::copy(iit, eiit, sit);
+
     return runner_start(progJson, sessionid, param);
 }
 #endif
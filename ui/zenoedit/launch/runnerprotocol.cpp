@@ -0,0 +1,102 @@
+#include "runnerprotocol.h"
+#include <rapidjson/document.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+#include <cstring>
+#include <istream>
+
+static constexpr size_t kPacketMagic = 314159265;
+
+void RunnerPacketHeader::makeValid() {
+    magicnum = kPacketMagic;
+    checksum = total_size ^ info_size ^ magicnum;
+}
+
+bool RunnerPacketHeader::isValid() const {
+    if (magicnum != kPacketMagic) return false;
+    return (total_size ^ info_size ^ magicnum ^ checksum) == 0;
+}
+
+std::vector<char> encodePacketHead(std::string_view info, size_t len) {
+    RunnerPacketHeader header;
+    header.total_size = info.size() + len;
+    header.info_size = info.size();
+    header.makeValid();
+
+    std::vector<char> headbuffer(4 + sizeof(RunnerPacketHeader) + info.size());
+    headbuffer[0] = '\a';
+    headbuffer[1] = '\b';
+    headbuffer[2] = '\r';
+    headbuffer[3] = '\t';
+    std::memcpy(headbuffer.data() + 4, &header, sizeof(RunnerPacketHeader));
+    std::memcpy(headbuffer.data() + 4 + sizeof(RunnerPacketHeader), info.data(), info.size());
+    return headbuffer;
+}
+
+std::string encodeRunRequest(const RunRequest& req, std::string_view progJson) {
+    rapidjson::StringBuffer s;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(s);
+    writer.StartObject();
+    writer.Key("action");
+    writer.String(req.action.c_str());
+    writer.Key("size");
+    writer.Uint64(progJson.size());
+    writer.Key("sessionid");
+    writer.Int(req.sessionid);
+    writer.Key("enablecache");
+    writer.Int(req.enableCache);
+    writer.Key("cachenum");
+    writer.Int(req.cacheNum);
+    writer.Key("cachedir");
+    writer.String(req.cacheDir.c_str(), req.cacheDir.size());
+    writer.Key("cacheLightCameraOnly");
+    writer.Int(req.applyLightAndCameraOnly);
+    writer.Key("cacheMaterialOnly");
+    writer.Int(req.applyMaterialOnly);
+    writer.Key("cacheautorm");
+    writer.Int(req.autoRmCurcache);
+    writer.EndObject();
+
+    std::string request(s.GetString(), s.GetLength());
+    request += '\n';
+    request.append(progJson);
+    return request;
+}
+
+bool readRunRequest(std::istream& in, RunRequest& req, std::string& progJson, std::string& err) {
+    err.clear();
+    std::string header;
+    do {
+        if (!std::getline(in, header))
+            return false;
+    } while (header.empty());
+
+    rapidjson::Document doc;
+    doc.Parse(header.c_str(), header.size());
+    if (!doc.IsObject() || !doc.HasMember("action") || !doc["action"].IsString()
+        || !doc.HasMember("size") || !doc["size"].IsUint64()) {
+        err = "invalid request header: " + header;
+        return false;
+    }
+    auto getInt = [&](const char* key, auto& value) {
+        if (doc.HasMember(key) && doc[key].IsInt())
+            value = doc[key].GetInt();
+    };
+
+    req.action = doc["action"].GetString();
+    getInt("sessionid", req.sessionid);
+    getInt("enablecache", req.enableCache);
+    getInt("cachenum", req.cacheNum);
+    if (doc.HasMember("cachedir") && doc["cachedir"].IsString())
+        req.cacheDir.assign(doc["cachedir"].GetString(), doc["cachedir"].GetStringLength());
+    getInt("cacheLightCameraOnly", req.applyLightAndCameraOnly);
+    getInt("cacheMaterialOnly", req.applyMaterialOnly);
+    getInt("cacheautorm", req.autoRmCurcache);
+
+    progJson.assign(doc["size"].GetUint64(), '\0');
+    if (!in.read(progJson.data(), progJson.size())) {
+        err = "request truncated";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <vector>
+
+//wire format between the editor and the runner process, kept free of Qt so that it can be tested alone.
+
+//runner -> editor: \a\b\r\t, this header, the json info, then the payload.
+struct RunnerPacketHeader {
+    size_t total_size;
+    size_t info_size;
+    size_t magicnum;
+    size_t checksum;
+
+    void makeValid();
+    bool isValid() const;
+};
+
+//everything sent before the payload of a packet carrying `len` bytes.
+std::vector<char> encodePacketHead(std::string_view info, size_t len);
+
+//editor -> persistent runner: a one-line json header, then `size` bytes of graph commands.
+//the cache options may change between runs, so every request carries all of them.
+struct RunRequest {
+    std::string action;     //"load" or "patch"
+    int sessionid = 0;
+    bool enableCache = false;
+    int cacheNum = 1;
+    std::string cacheDir;
+    bool applyLightAndCameraOnly = false;
+    bool applyMaterialOnly = false;
+    bool autoRmCurcache = false;
+};
+
+std::string encodeRunRequest(const RunRequest& req, std::string_view progJson);
+//options missing from the header keep their value in `req`.
+//returns false at the end of the stream, or with `err` set when the request is malformed.
+bool readRunRequest(std::istream& in, RunRequest& req, std::string& progJson, std::string& err);
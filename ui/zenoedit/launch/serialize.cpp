@@ -8,6 +8,10 @@
 #include "variantptr.h"
 #include "settings/zsettings.h"
 #include <QSet>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
 
 using namespace JsonHelper;
 
@@ -40,13 +44,14 @@ void resolveOutputSocket(
         QModelIndex dictlistIdx = outSockIdx.data(ROLE_PARAM_COREIDX).toModelIndex();
         bool bDict = dictlistIdx.data(ROLE_PARAM_TYPE) == "dict";
         QString _tmpNode = bDict ? "ExtractDict" : "list-what?";
-        QString mockNode = UiHelper::generateUuid(_tmpNode);
+        QString dictlistName = dictlistIdx.data(ROLE_PARAM_NAME).toString();
+        //keep the ident stable between launches, so that a patch does not see it as a new node.
+        QString mockNode = QString("%1:%2:%3").arg(outNodeId, dictlistName, outSock);
         mockNode = nameMangling(graphIdPrefix, mockNode);
         AddStringList({"addNode", _tmpNode, mockNode}, writer);
 
         QString mockSocket = bDict ? "dict" : "list";
 
-        QString dictlistName = dictlistIdx.data(ROLE_PARAM_NAME).toString();
         AddStringList({"addNodeOutput", mockNode, outSock}, writer);
 
         //add link from source output node    to    mockNode(ExtractDict).
@@ -114,6 +119,12 @@ static void getOptStr(const QString& sockType, QVariant& defl, QString& opStr)
     }
 }
 
+static QString subnetDefKey(const QString& subgName, bool bView)
+{
+    //the body of a subgraph only depends on whether its views are enabled.
+    return bView ? subgName + ":VIEW" : subgName;
+}
+
 static void serializeGraph(IGraphsModel* pGraphsModel, const QModelIndex& subgIdx, QString const &graphIdPrefix, bool bView, RAPIDJSON_WRITER& writer, LAUNCH_PARAM launchParam, bool bNestedSubg = true)
 {
     ZASSERT_EXIT(pGraphsModel && subgIdx.isValid());
@@ -176,12 +187,11 @@ static void serializeGraph(IGraphsModel* pGraphsModel, const QModelIndex& subgId
             }
             else
             {
-                AddStringList({"addSubnetNode", name, ident}, writer);
-                AddStringList({"pushSubnetScope", ident}, writer);
-                const QString& prefix = nameMangling(graphIdPrefix, idx.data(ROLE_OBJID).toString());
+                //the body has been sent once by serializeSubnetDefs, the core instantiates
+                //it under the prefix, giving the same idents as an inlined body.
                 bool _bView = bView && (idx.data(ROLE_OPTIONS).toInt() & OPT_VIEW);
-                serializeGraph(pGraphsModel, pGraphsModel->index(name), prefix, _bView, writer, launchParam, true);
-                AddStringList({"popSubnetScope", ident}, writer);
+                const QString& prefix = nameMangling(graphIdPrefix, idx.data(ROLE_OBJID).toString());
+                AddStringList({"addSubnetInstance", subnetDefKey(name, _bView), ident, prefix}, writer);
             }
         }
 
@@ -273,8 +283,7 @@ static void serializeGraph(IGraphsModel* pGraphsModel, const QModelIndex& subgId
                             {
                                 //create dict or list as a middle node to connect each other.
                                 QString _tmpNode = bDict ? "MakeDict" : "MakeList";
-                                mockDictList = UiHelper::generateUuid(_tmpNode);
-                                mockDictList = nameMangling(graphIdPrefix, mockDictList);
+                                mockDictList = ident + ":" + inputName + ":" + _tmpNode;
                                 AddStringList({ "addNode", _tmpNode, mockDictList }, writer);
                             }
                             if (!bDict)
@@ -442,11 +451,243 @@ static void serializeGraph(IGraphsModel* pGraphsModel, const QModelIndex& subgId
     }
 }
 
+static void serializeSubnetDefs(IGraphsModel* pGraphsModel, const QModelIndex& subgIdx, bool bView, RAPIDJSON_WRITER& writer, LAUNCH_PARAM launchParam, QSet<QString>& defined)
+{
+    for (int i = 0; i < pGraphsModel->itemCount(subgIdx); i++)
+    {
+        const QModelIndex& idx = pGraphsModel->index(i, subgIdx);
+        const QString& name = idx.data(ROLE_OBJNAME).toString();
+        if (name == "Blackboard" || name == "Group" || NO_VERSION_NODE == idx.data(ROLE_NODETYPE))
+            continue;
+
+        int opts = idx.data(ROLE_OPTIONS).toInt();
+        if ((opts & OPT_MUTE) || !pGraphsModel->IsSubGraphNode(idx))
+            continue;
+
+        bool _bView = bView && (opts & OPT_VIEW);
+        const QString& key = subnetDefKey(name, _bView);
+        if (defined.contains(key))
+            continue;
+        defined.insert(key);
+
+        //the definitions instantiated by this one have to be known before.
+        const QModelIndex& defIdx = pGraphsModel->index(name);
+        serializeSubnetDefs(pGraphsModel, defIdx, _bView, writer, launchParam, defined);
+        AddStringList({"defineSubnet", key}, writer);
+        serializeGraph(pGraphsModel, defIdx, "", _bView, writer, launchParam, true);
+        AddStringList({"endSubnet", key}, writer);
+    }
+}
+
 void serializeScene(IGraphsModel* pModel, RAPIDJSON_WRITER& writer, LAUNCH_PARAM param)
 {
+    QSet<QString> defined;
+    serializeSubnetDefs(pModel, pModel->index("main"), true, writer, param, defined);
     serializeGraph(pModel, pModel->index("main"), "", true, writer, param, true);
 }
 
+namespace {
+
+struct SerializedNode {
+    std::vector<std::string> scope;     //idents of the subnet nodes enclosing this node.
+    std::string ident;
+    std::string instanceOf;             //subnet definition used by addSubnetInstance.
+    std::vector<std::string> creation;  //addNode, addSubnetNode, addSubnetInstance, addNodeOutput, cacheToDisk.
+    std::vector<std::string> commands;  //inputs, params, links and completeNode.
+};
+
+struct SerializedDef {
+    std::vector<std::string> commands;  //including defineSubnet and endSubnet.
+    std::set<std::string> uses;         //definitions instantiated in the body.
+};
+
+struct SerializedScene {
+    std::vector<std::string> globals;
+    std::vector<std::string> defOrder;
+    std::map<std::string, SerializedDef> defs;
+    std::vector<std::string> order;
+    std::map<std::string, SerializedNode> nodes;
+};
+
+static std::string dumpCommand(const rapidjson::Value& cmd)
+{
+    rapidjson::StringBuffer s;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(s);
+    cmd.Accept(writer);
+    return std::string(s.GetString(), s.GetLength());
+}
+
+static std::string dumpString(const std::string& str)
+{
+    rapidjson::StringBuffer s;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(s);
+    writer.String(str.c_str(), str.size());
+    return std::string(s.GetString(), s.GetLength());
+}
+
+static std::string scopeKey(const std::vector<std::string>& scope, const std::string& ident)
+{
+    std::string key;
+    for (const auto& subnet : scope) {
+        key += subnet;
+        key += '\x1f';
+    }
+    return key + ident;
+}
+
+static bool parseSerializedScene(const std::string& json, SerializedScene& scene)
+{
+    rapidjson::Document doc;
+    doc.Parse(json.c_str(), json.size());
+    if (!doc.IsArray())
+        return false;
+
+    std::vector<std::string> scope;
+    SerializedDef* pDef = nullptr;
+    for (const auto& cmd : doc.GetArray())
+    {
+        if (!cmd.IsArray() || cmd.Empty() || !cmd[0].IsString())
+            return false;
+        const std::string name = cmd[0].GetString();
+        if (pDef) {
+            //definitions are compared as a whole.
+            pDef->commands.push_back(dumpCommand(cmd));
+            if (name == "addSubnetInstance")
+                pDef->uses.insert(cmd[1].GetString());
+            else if (name == "endSubnet")
+                pDef = nullptr;
+            continue;
+        }
+        if (name == "defineSubnet") {
+            const std::string key = cmd[1].GetString();
+            scene.defOrder.push_back(key);
+            pDef = &scene.defs[key];
+            pDef->commands = {dumpCommand(cmd)};
+            continue;
+        } else if (name == "pushSubnetScope") {
+            scope.push_back(cmd[1].GetString());
+            continue;
+        } else if (name == "popSubnetScope") {
+            if (scope.empty())
+                return false;
+            scope.pop_back();
+            continue;
+        }
+
+        bool bInstance = name == "addSubnetInstance";
+        bool bCreation = name == "addNode" || name == "addSubnetNode" || bInstance || name == "addNodeOutput" || name == "cacheToDisk";
+        int identPos = (name == "addNode" || name == "addSubnetNode" || bInstance) ? 2 : 1;
+        if (cmd.Size() <= identPos || !cmd[identPos].IsString()) {
+            scene.globals.push_back(dumpCommand(cmd));
+            continue;
+        }
+
+        const std::string ident = cmd[identPos].GetString();
+        const std::string key = scopeKey(scope, ident);
+        auto [it, bNew] = scene.nodes.try_emplace(key);
+        if (bNew) {
+            it->second.scope = scope;
+            it->second.ident = ident;
+            scene.order.push_back(key);
+        }
+        if (bInstance)
+            it->second.instanceOf = cmd[1].GetString();
+        (bCreation ? it->second.creation : it->second.commands).push_back(dumpCommand(cmd));
+    }
+    return scope.empty() && !pDef;
+}
+
+static void appendScoped(std::string& res, const std::vector<std::string>& scope, const std::vector<std::string>& cmds)
+{
+    auto append = [&](const std::string& cmd) {
+        if (res.size() > 1)
+            res += ',';
+        res += cmd;
+    };
+    for (const auto& subnet : scope)
+        append("[\"pushSubnetScope\"," + dumpString(subnet) + "]");
+    for (const auto& cmd : cmds)
+        append(cmd);
+    for (auto it = scope.rbegin(); it != scope.rend(); it++)
+        append("[\"popSubnetScope\"," + dumpString(*it) + "]");
+}
+
+}
+
+std::string diffSerializedScene(const std::string& oldJson, const std::string& newJson)
+{
+    SerializedScene oldScene, newScene;
+    if (!parseSerializedScene(oldJson, oldScene) || !parseSerializedScene(newJson, newScene))
+        return {};
+
+    //a definition changes with its body or with any definition it instantiates.
+    std::set<std::string> changedDefs;
+    for (const auto& key : newScene.defOrder) {
+        auto it = oldScene.defs.find(key);
+        if (it == oldScene.defs.end() || it->second.commands != newScene.defs[key].commands)
+            changedDefs.insert(key);
+    }
+    for (bool bGrow = true; bGrow;) {
+        bGrow = false;
+        for (const auto& key : newScene.defOrder) {
+            if (changedDefs.count(key))
+                continue;
+            for (const auto& used : newScene.defs[key].uses) {
+                if (changedDefs.count(used)) {
+                    changedDefs.insert(key);
+                    bGrow = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    //nodes whose class or structure changed are removed and added again,
+    //which also throws away everything that lived inside a subnet.
+    std::set<std::string> recreated;
+    for (const auto& key : oldScene.order) {
+        auto it = newScene.nodes.find(key);
+        if (it == newScene.nodes.end() || it->second.creation != oldScene.nodes[key].creation ||
+            changedDefs.count(it->second.instanceOf))
+            recreated.insert(key);
+    }
+    auto insideRecreated = [&](const SerializedNode& node) {
+        for (size_t i = 0; i < node.scope.size(); i++) {
+            std::vector<std::string> parent(node.scope.begin(), node.scope.begin() + i);
+            if (recreated.count(scopeKey(parent, node.scope[i])))
+                return true;
+        }
+        return false;
+    };
+
+    std::string res = "[";
+    appendScoped(res, {}, newScene.globals);
+    for (const auto& key : newScene.defOrder) {
+        if (changedDefs.count(key))
+            appendScoped(res, {}, newScene.defs[key].commands);
+    }
+    for (const auto& key : oldScene.order) {
+        const auto& node = oldScene.nodes[key];
+        if (recreated.count(key) && !insideRecreated(node))
+            appendScoped(res, node.scope, {"[\"removeNode\"," + dumpString(node.ident) + "]"});
+    }
+    for (const auto& key : newScene.order) {
+        const auto& node = newScene.nodes[key];
+        auto oldIt = oldScene.nodes.find(key);
+        if (oldIt == oldScene.nodes.end() || recreated.count(key) || insideRecreated(node)) {
+            std::vector<std::string> cmds = node.creation;
+            cmds.insert(cmds.end(), node.commands.begin(), node.commands.end());
+            appendScoped(res, node.scope, cmds);
+        } else if (oldIt->second.commands != node.commands) {
+            std::vector<std::string> cmds = {"[\"clearNodeInputs\"," + dumpString(node.ident) + "]"};
+            cmds.insert(cmds.end(), node.commands.begin(), node.commands.end());
+            appendScoped(res, node.scope, cmds);
+        }
+    }
+    res += "]";
+    return res;
+}
+
 static void serializeSceneOneGraph(IGraphsModel* pModel, RAPIDJSON_WRITER& writer, QString subgName)
 {
     LAUNCH_PARAM param;
@@ -3,6 +3,7 @@
 
 #include <QtWidgets>
 #include <QString>
+#include <string>
 #include <zenomodel/include/jsonhelper.h>
 #include "corelaunch.h"
 
@@ -10,5 +11,7 @@ class IGraphsModel;
 
 void serializeScene(IGraphsModel* pModel, RAPIDJSON_WRITER& writer, LAUNCH_PARAM param);
 QString serializeSceneCpp(IGraphsModel* pModel);
+//commands turning the graph loaded from oldJson into the one of newJson, empty if either can't be parsed.
+std::string diffSerializedScene(const std::string& oldJson, const std::string& newJson);
 
 #endif
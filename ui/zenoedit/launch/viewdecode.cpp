@@ -22,20 +22,11 @@
 #include "launch/corelaunch.h"
 #include "settings/zsettings.h"
 #include "launch/ztcpserver.h"
+#include "launch/runnerprotocol.h"
 
 namespace {
 
-struct Header {
-    size_t total_size;
-    size_t info_size;
-    size_t magicnum;
-    size_t checksum;
-
-    bool isValid() const {
-        if (magicnum != 314159265) return false;
-        return (total_size ^ info_size ^ magicnum ^ checksum) == 0;
-    }
-};
+using Header = RunnerPacketHeader;
 
 struct PacketProc {
     int globalCommNeedClean = 0;
@@ -178,6 +169,12 @@ struct PacketProc {
                 }
             }
 
+        } else if (action == "runFinished") {
+            //sent by the persistent runner, which stays alive after the run.
+            ZTcpServer* pServer = zenoApp->getServer();
+            if (pServer)
+                pServer->onRunFinished(objKey != "0");
+
         } else if (action == "reportStatus") {
             std::string statJson{buf, len};
             zeno::getSession().globalStatus->fromJson(statJson);
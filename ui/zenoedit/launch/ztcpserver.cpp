@@ -21,6 +21,8 @@
 #include "common.h"
 #include <zenomodel/include/uihelper.h>
 #include "util/apphelper.h"
+#include "launch/serialize.h"
+#include "launch/runnerprotocol.h"
 
 ZTcpServer::ZTcpServer(QObject *parent)
     : QObject(parent)
@@ -28,6 +30,8 @@ ZTcpServer::ZTcpServer(QObject *parent)
     , m_optixServer(nullptr)
     , m_port(0)
     , m_tcpSocket(nullptr)
+    , m_bPersistent(false)
+    , m_bRunning(false)
 {
 }
 
@@ -69,7 +73,7 @@ void ZTcpServer::init(const QHostAddress& address)
 void ZTcpServer::startProc(const std::string& progJson, LAUNCH_PARAM param)
 {
     ZASSERT_EXIT(m_tcpServer);
-    if (m_proc && m_proc->isOpen())
+    if (m_proc && m_proc->isOpen() && (!m_bPersistent || m_bRunning))
     {
         zeno::log_info("background process already running");
         return;
@@ -78,10 +82,6 @@ void ZTcpServer::startProc(const std::string& progJson, LAUNCH_PARAM param)
     zeno::log_info("launching program...");
     zeno::log_debug("program JSON: {}", progJson);
 
-    m_proc = std::make_unique<QProcess>();
-    m_proc->setInputChannelMode(QProcess::InputChannelMode::ManagedInputChannel);
-    m_proc->setReadChannel(QProcess::ProcessChannel::StandardOutput);
-    m_proc->setProcessChannelMode(QProcess::ProcessChannelMode::ForwardedErrorChannel);
     int sessionid = zeno::getSession().globalState->sessionid;
 
     QString cachedir;
@@ -117,34 +117,75 @@ void ZTcpServer::startProc(const std::string& progJson, LAUNCH_PARAM param)
         param.zsgPath = pGraphsMgr->zsgDir();
     }
 
+    //cache options may change between runs, they go with each request instead of the args.
+    bool bPersistent = param.generator.isEmpty();
     QStringList args = {
         "--runner", "1",
-        "--sessionid", QString::number(sessionid),
         "--port", QString::number(m_port),
-        "--enablecache", QString::number(param.enableCache && QFileInfo(cachedir).isDir() && param.cacheNum),
-        "--cachenum", QString::number(param.cacheNum),
-        "--cachedir", cachedir,
-        "--cacheLightCameraOnly", QString::number(param.applyLightAndCameraOnly),
-        "--cacheMaterialOnly", QString::number(param.applyMaterialOnly),
-        "--cacheautorm", QString::number(param.autoRmCurcache),
         "--zsg", param.zsgPath,
         "--projectFps", QString::number(param.projectFps),
         "--objcachedir", zenoApp->cacheMgr()->objCachePath(),
-        "--generator", param.generator
+        "--generator", param.generator,
+        "--persistent", QString::number(bPersistent),
     };
 
-    m_proc->start(QCoreApplication::applicationFilePath(), args);
-
-    if (!m_proc->waitForStarted(-1)) {
-        zeno::log_warn("process failed to get started, giving up");
-        return;
+    if (m_proc && m_bPersistent && bPersistent && args == m_procArgs)
+    {
+        //reuse the idle runner, only send what has been changed since the last run.
+        std::string patch;
+        if (!m_lastProgJson.empty())
+            patch = diffSerializedScene(m_lastProgJson, progJson);
+        zeno::log_info("patching the running program...");
+        viewDecodeClear();
+        if (patch.empty())
+            sendRunRequest("load", progJson, sessionid, param, cachedir);
+        else
+            sendRunRequest("patch", patch, sessionid, param, cachedir);
     }
+    else
+    {
+        if (m_proc)
+        {
+            //an idle runner started with other args.
+            disconnect(m_proc.get(), SIGNAL(finished(int, QProcess::ExitStatus)), this, SLOT(onProcFinished(int, QProcess::ExitStatus)));
+            disconnect(m_proc.get(), SIGNAL(readyRead()), this, SLOT(onProcPipeReady()));
+            killProc();
+        }
 
-    m_proc->write(progJson.data(), progJson.size());
-    m_proc->closeWriteChannel();
+        m_proc = std::make_unique<QProcess>();
+        m_proc->setInputChannelMode(QProcess::InputChannelMode::ManagedInputChannel);
+        m_proc->setReadChannel(QProcess::ProcessChannel::StandardOutput);
+        m_proc->setProcessChannelMode(QProcess::ProcessChannelMode::ForwardedErrorChannel);
+        m_proc->start(QCoreApplication::applicationFilePath(), args + QStringList{
+            "--sessionid", QString::number(sessionid),
+            "--enablecache", QString::number(param.enableCache && QFileInfo(cachedir).isDir() && param.cacheNum),
+            "--cachenum", QString::number(param.cacheNum),
+            "--cachedir", cachedir,
+            "--cacheLightCameraOnly", QString::number(param.applyLightAndCameraOnly),
+            "--cacheMaterialOnly", QString::number(param.applyMaterialOnly),
+            "--cacheautorm", QString::number(param.autoRmCurcache),
+        });
+
+        if (!m_proc->waitForStarted(-1)) {
+            zeno::log_warn("process failed to get started, giving up");
+            return;
+        }
+
+        m_bPersistent = bPersistent;
+        m_procArgs = args;
+        if (bPersistent) {
+            sendRunRequest("load", progJson, sessionid, param, cachedir);
+        } else {
+            m_proc->write(progJson.data(), progJson.size());
+            m_proc->closeWriteChannel();
+        }
+
+        connect(m_proc.get(), SIGNAL(finished(int, QProcess::ExitStatus)), this, SLOT(onProcFinished(int, QProcess::ExitStatus)));
+        connect(m_proc.get(), SIGNAL(readyRead()), this, SLOT(onProcPipeReady()));
+    }
+    m_bRunning = true;
+    m_lastProgJson = progJson;
 
-    connect(m_proc.get(), SIGNAL(finished(int, QProcess::ExitStatus)), this, SLOT(onProcFinished(int, QProcess::ExitStatus)));
-    connect(m_proc.get(), SIGNAL(readyRead()), this, SLOT(onProcPipeReady()));
     if (ZenoMainWindow* mainwin = zenoApp->getMainWindow())
         emit zenoApp->getMainWindow()->runStarted();
 #ifdef ZENO_OPTIX_PROC
@@ -153,6 +194,41 @@ void ZTcpServer::startProc(const std::string& progJson, LAUNCH_PARAM param)
 #endif
 }
 
+void ZTcpServer::sendRunRequest(const std::string& action, const std::string& progJson, int sessionid, const LAUNCH_PARAM& param, const QString& cachedir)
+{
+    ZASSERT_EXIT(m_proc);
+    RunRequest req;
+    req.action = action;
+    req.sessionid = sessionid;
+    req.enableCache = param.enableCache && QFileInfo(cachedir).isDir() && param.cacheNum;
+    req.cacheNum = param.cacheNum;
+    req.cacheDir = cachedir.toStdString();
+    req.applyLightAndCameraOnly = param.applyLightAndCameraOnly;
+    req.applyMaterialOnly = param.applyMaterialOnly;
+    req.autoRmCurcache = param.autoRmCurcache;
+
+    std::string request = encodeRunRequest(req, progJson);
+    m_proc->write(request.data(), request.size());
+}
+
+void ZTcpServer::onRunFinished(bool bFailed)
+{
+    //the persistent runner is still alive, only the current run is over.
+    m_bRunning = false;
+    if (bFailed)
+    {
+        m_lastProgJson.clear();
+        emit runnerError();
+    }
+    viewDecodeFinish();
+
+    auto mainWin = zenoApp->getMainWindow();
+    if (mainWin)
+        emit mainWin->runFinished();
+    else
+        emit runFinished();
+}
+
 void ZTcpServer::startOptixCmd(const ZENO_RECORD_RUN_INITPARAM& param)
 {
     zeno::log_info("launching optix program...");
@@ -348,6 +424,8 @@ void ZTcpServer::killProc()
         m_proc->kill();
         m_proc = nullptr;
     }
+    m_bRunning = false;
+    m_lastProgJson.clear();
 }
 
 void ZTcpServer::onNewConnection()
@@ -420,6 +498,8 @@ void ZTcpServer::onDisconnect()
 
 void ZTcpServer::onProcFinished(int exitCode, QProcess::ExitStatus exitStatus)
 {
+    m_bRunning = false;
+    m_lastProgJson.clear();
     if (exitStatus == QProcess::NormalExit)
     {
         if (m_proc)
@@ -24,6 +24,7 @@ public:
     void onFrameFinished(const QString& action, const QString& keyObj);
     void onInitFrameRange(const QString& action, int frameStart, int frameEnd);
     void onClearFrameState();
+    void onRunFinished(bool bFailed);
 
 signals:
     void runFinished();
@@ -41,12 +42,17 @@ private:
     void sendCacheRenderInfoToOptix(const QString& finalCachePath, int cacheNum, bool applyLightAndCameraOnly, bool applyMaterialOnly);
     void dispatchPacketToOptix(const QString& info);
     void initializeNewOptixProc();
+    void sendRunRequest(const std::string& action, const std::string& progJson, int sessionid, const LAUNCH_PARAM& param, const QString& cachedir);
 
     QTcpServer* m_tcpServer;
     QTcpSocket* m_tcpSocket;
     QLocalServer* m_optixServer;
     QVector<QLocalSocket*> m_optixSockets;
     std::unique_ptr<QProcess> m_proc;
+    QStringList m_procArgs;         //args of the persistent runner, a different set needs a new process.
+    std::string m_lastProgJson;     //graph currently loaded in the persistent runner.
+    bool m_bPersistent;
+    bool m_bRunning;
 
     std::vector<std::unique_ptr<QProcess>> m_optixProcs;
     int m_port;
@@ -0,0 +1,194 @@
+// stress test of zeno::ConcurrentCache under contention, exits non-zero on failure,
+// usage: zeno_concurrentcache_stress [threads] [seconds per phase]
+#include <zeno/utils/concurrent_cache.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Blob {
+    int key;
+    std::size_t bytes;
+};
+
+using Cache = zeno::ConcurrentCache<int, Blob>;
+
+int g_failures = 0;
+
+void check(bool ok, char const *what) {
+    printf("  %-56s %s\n", what, ok ? "ok" : "FAILED");
+    if (!ok)
+        g_failures++;
+}
+
+std::size_t bytesOf(int key) {
+    return 1 + key % 7;
+}
+
+template <class F>
+void runThreads(int nthreads, F const &body) {
+    std::vector<std::thread> threads;
+    for (int t = 0; t < nthreads; t++)
+        threads.emplace_back(body, t);
+    for (auto &th: threads)
+        th.join();
+}
+
+// many threads asking for the same few keys at once: each is computed exactly once
+// and everyone gets that one value
+void computeOnce(int nthreads) {
+    printf("compute once under contention\n");
+    constexpr int nkeys = 64;
+    Cache cache;
+    std::vector<std::atomic<int>> computes(nkeys);
+    std::atomic<int> wrong{0};
+    std::vector<std::atomic<Blob *>> seen(nkeys);
+    runThreads(nthreads, [&] (int t) {
+        std::mt19937 rng(t);
+        for (int i = 0; i < 20000; i++) {
+            int key = rng() % nkeys;
+            auto value = cache.get_or_compute(key, [&] {
+                computes[key]++;
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+                return std::make_shared<Blob>(Blob{key, bytesOf(key)});
+            });
+            Blob *expected = nullptr;
+            if (value->key != key || (!seen[key].compare_exchange_strong(expected, value.get()) && expected != value.get()))
+                wrong++;
+        }
+    });
+    check(std::all_of(computes.begin(), computes.end(), [] (auto const &n) { return n == 1; }),
+          "every key computed exactly once");
+    check(wrong == 0, "all callers got the same value of their key");
+    check(cache.size() == nkeys && cache.total_cost() == nkeys, "size and cost of the full cache");
+}
+
+// a cache far smaller than the key set, evicting all the time while slow computes
+// are in flight: an entry being computed is never evicted, otherwise another
+// caller would start a second computation of the same key alongside it
+void noEvictionDuringCompute(int nthreads, double seconds) {
+    printf("eviction pressure with computes in flight\n");
+    constexpr int nkeys = 256;
+    Cache cache(8);
+    std::vector<std::atomic<int>> inflight(nkeys);
+    std::atomic<int> overlaps{0}, wrong{0};
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(seconds);
+    runThreads(nthreads, [&] (int t) {
+        std::mt19937 rng(t);
+        while (std::chrono::steady_clock::now() < deadline) {
+            int key = rng() % nkeys;
+            auto value = cache.get_or_compute(key, [&] {
+                if (inflight[key]++ != 0)
+                    overlaps++;
+                std::this_thread::sleep_for(std::chrono::microseconds(rng() % 300));
+                inflight[key]--;
+                return std::make_shared<Blob>(Blob{key, bytesOf(key)});
+            });
+            if (value->key != key)
+                wrong++;
+        }
+    });
+    check(overlaps == 0, "no key computed twice at the same time");
+    check(wrong == 0, "values match their keys");
+    // the last inserts may have skipped eviction while another thread was at it,
+    // one more insert from a quiet cache brings it back under capacity
+    cache.get_or_compute(nkeys, [] { return std::make_shared<Blob>(Blob{nkeys, 1}); });
+    check(cache.total_cost() <= 8 && cache.size() <= 8, "back within capacity once quiet");
+}
+
+// get_or_compute, find, erase and clear all at once on a cost-bounded cache, once
+// quiet the accounted cost is the sum of the costs of what is left
+void mixedOperations(int nthreads, double seconds) {
+    printf("mixed get_or_compute / find / erase / clear\n");
+    constexpr int nkeys = 512;
+    constexpr std::size_t capacity = 600;
+    Cache cache(capacity, [] (Blob const &b) { return b.bytes; });
+    std::atomic<int> wrong{0}, failures{0};
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(seconds);
+    runThreads(nthreads, [&] (int t) {
+        std::mt19937 rng(t);
+        while (std::chrono::steady_clock::now() < deadline) {
+            int key = rng() % nkeys;
+            int op = rng() % 1000;
+            if (op < 600) {
+                try {
+                    auto value = cache.get_or_compute(key, [&] () -> std::shared_ptr<Blob> {
+                        // failed computes must leave nothing behind
+                        if (rng() % 50 == 0)
+                            throw std::runtime_error("compute failed");
+                        if (rng() % 50 == 0)
+                            return nullptr;
+                        return std::make_shared<Blob>(Blob{key, bytesOf(key)});
+                    });
+                    if (value && value->key != key)
+                        wrong++;
+                } catch (std::runtime_error const &) {
+                    failures++;
+                }
+            } else if (op < 900) {
+                if (auto value = cache.find(key); value && value->key != key)
+                    wrong++;
+            } else if (op < 999) {
+                cache.erase(key);
+            } else {
+                cache.clear();
+            }
+        }
+    });
+    check(wrong == 0, "values match their keys");
+    check(failures > 0, "failing computes were exercised");
+    std::size_t cost = 0;
+    for (int key = 0; key < nkeys; key++) {
+        if (auto value = cache.find(key))
+            cost += value->bytes;
+    }
+    check(cache.total_cost() == cost, "accounted cost equals the cost of the entries left");
+    cache.get_or_compute(nkeys, [] { return std::make_shared<Blob>(Blob{nkeys, 1}); });
+    check(cache.total_cost() <= capacity, "back within capacity once quiet");
+    cache.clear();
+    check(cache.size() == 0 && cache.total_cost() == 0, "nothing left after clear");
+}
+
+// single threaded, so the order is known: the least recently used entry goes first,
+// and find counts as a use
+void lruOrder() {
+    printf("least recently used order\n");
+    Cache cache(3);
+    auto make = [&] (int key) {
+        return cache.get_or_compute(key, [&] { return std::make_shared<Blob>(Blob{key, 1}); });
+    };
+    make(0), make(1), make(2);
+    cache.find(0);
+    make(3);
+    check(cache.find(0) && !cache.find(1) && cache.find(2) && cache.find(3), "evicts the least recently used");
+    make(2);
+    make(4);
+    check(!cache.find(0) && cache.find(2) && cache.find(3) && cache.find(4), "a hit counts as a use");
+    auto held = cache.find(3);
+    cache.erase(3);
+    check(held && held->key == 3 && !cache.find(3), "erased values live on while held");
+    check(cache.total_cost() == 2 && cache.size() == 2, "cost follows erase");
+}
+
+}
+
+int main(int argc, char **argv) {
+    int nthreads = argc > 1 ? std::atoi(argv[1]) : std::max(4u, std::thread::hardware_concurrency());
+    double seconds = argc > 2 ? std::atof(argv[2]) : 2.0;
+    printf("threads: %d, %g s per timed phase\n", nthreads, seconds);
+
+    lruOrder();
+    computeOnce(nthreads);
+    noEvictionDuringCompute(nthreads, seconds);
+    mixedOperations(nthreads, seconds);
+
+    printf(g_failures ? "%d check(s) FAILED\n" : "all checks passed\n", g_failures);
+    return g_failures ? 1 : 0;
+}
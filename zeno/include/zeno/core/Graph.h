@@ -18,9 +18,19 @@ struct Session;
 struct SubgraphNode;
 struct DirtyChecker;
 struct INode;
+struct SubnetDefinition;
 
 struct Context {
     std::set<std::string> visited;
+    Context const *parent = nullptr;  // nodes visited in enclosing scopes count as visited here too
+
+    inline bool isVisited(std::string const &id) const {
+        for (auto c = this; c; c = c->parent) {
+            if (c->visited.find(id) != c->visited.end())
+                return true;
+        }
+        return false;
+    }
 
     inline void mergeVisited(Context const &other) {
         visited.insert(other.visited.begin(), other.visited.end());
@@ -43,6 +53,7 @@ struct Graph : std::enable_shared_from_this<Graph> {
     std::map<std::string, zany> portals;
     std::map<std::string, std::string> subInputNodes;
     std::map<std::string, std::string> subOutputNodes;
+    std::map<std::string, std::shared_ptr<SubnetDefinition>> subnetDefs;  // only used by the root graph
 
     std::unique_ptr<Context> ctx;
     std::unique_ptr<DirtyChecker> dirtyChecker;
@@ -60,12 +71,15 @@ struct Graph : std::enable_shared_from_this<Graph> {
     ZENO_API void applyNodesToExec();
     ZENO_API void applyNodes(std::set<std::string> const &ids);
     ZENO_API void addNode(std::string const &cls, std::string const &id);
+    ZENO_API void removeNode(std::string const &id);
     ZENO_API Graph *addSubnetNode(std::string const &id);
     ZENO_API Graph *getSubnetGraph(std::string const &id) const;
     ZENO_API bool applyNode(std::string const &id);
     ZENO_API void completeNode(std::string const &id);
     ZENO_API void bindNodeInput(std::string const &dn, std::string const &ds,
         std::string const &sn, std::string const &ss);
+    ZENO_API void unbindNodeInput(std::string const &dn, std::string const &ds);
+    ZENO_API void clearNodeInputs(std::string const &id);
     ZENO_API void setNodeInput(std::string const &id, std::string const &par,
         zany const &val);
     ZENO_API void setKeyFrame(std::string const &id, std::string const &par, zany const &val);
@@ -74,6 +88,8 @@ struct Graph : std::enable_shared_from_this<Graph> {
     ZENO_API zany const &getNodeOutput(std::string const &sn, std::string const &ss) const;
     ZENO_API zany getNodeInput(std::string const &sn, std::string const &ss) const;
     ZENO_API void loadGraph(const char *json);
+    ZENO_API void patchGraph(const char *json);
+    ZENO_API void markDirtyDownstream(std::set<std::string> const &ids);
     ZENO_API void setNodeParam(std::string const &id, std::string const &par,
         std::variant<int, float, std::string, zany> const &val);  /* to be deprecated */
     ZENO_API std::map<std::string, zany> callSubnetNode(std::string const &id,
@@ -16,7 +16,9 @@ struct ContextManagedNode : INode {
         assert(!m_ctx);
         m_ctx = std::move(graph->ctx);
         if (m_ctx) {
-            graph->ctx = std::make_unique<Context>(*m_ctx);
+            // a scope on top of the outer context rather than a copy of its visited set
+            graph->ctx = std::make_unique<Context>();
+            graph->ctx->parent = m_ctx.get();
         }
         else {
             // Context may be another subgraph, which has been cleared,
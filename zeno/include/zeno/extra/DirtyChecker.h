@@ -17,6 +17,10 @@ struct DirtyChecker {
         dirts.insert(std::move(ident));
     }
 
+    void clear() {
+        dirts.clear();
+    }
+
     bool amIDirty(std::string const &ident) const {
         return dirts.find(ident) != dirts.end();
     }
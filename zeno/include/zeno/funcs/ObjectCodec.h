@@ -4,10 +4,80 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <cstring>
+#include <unordered_map>
+#include <mutex>
 
 namespace zeno {
 
 ZENO_API std::shared_ptr<IObject> decodeObject(const char *buf, size_t len);
 ZENO_API bool encodeObject(IObject const *object, std::vector<char> &buf);
 
+// encodes independent objects in parallel into one buffer appended to buf, object i
+// takes bytes [offsets[i], offsets[i + 1]), an empty range if it cannot be encoded
+ZENO_API void encodeObjects(IObject const *const *objects, size_t count, std::vector<char> &buf, std::vector<size_t> &offsets);
+
+namespace _implObjectCodec {
+
+// bytes an encoder has to build from an object (e.g. a serialized material), made
+// once by the measuring pass and reused by the writing one, shared by all threads
+// of one encode
+struct EncodeMemo {
+    std::mutex mtx;
+    std::unordered_map<void const *, std::vector<char>> blobs;
+
+    template <class F>
+    std::vector<char> const &get(void const *key, F const &make) {
+        {
+            std::lock_guard lck(mtx);
+            if (auto it = blobs.find(key); it != blobs.end())
+                return it->second;
+        }
+        auto blob = make();
+        std::lock_guard lck(mtx);
+        return blobs.try_emplace(key, std::move(blob)).first->second;
+    }
+};
+
+// encoders run twice over the same object: without a buffer to measure the exact
+// size, then again to memcpy into the buffer presized from that measurement
+struct EncodeSink {
+    char *base = nullptr;
+    size_t pos = 0;
+    EncodeMemo *memo = nullptr;
+
+    bool measuring() const {
+        return !base;
+    }
+
+    void write(void const *data, size_t size);
+
+    template <class T>
+    void write_value(T const &value) {
+        write(&value, sizeof(T));
+    }
+
+    // writes the bytes make() builds for key, built only once per encode when there is a memo
+    template <class F>
+    void write_memoized(void const *key, F const &make) {
+        if (memo) {
+            auto const &blob = memo->get(key, make);
+            write(blob.data(), blob.size());
+        } else {
+            auto blob = make();
+            write(blob.data(), blob.size());
+        }
+    }
+
+    template <class T>
+    void patch_value(size_t at, T const &value) {
+        if (base)
+            std::memcpy(base + at, &value, sizeof(T));
+    }
+};
+
+bool encodeObjectTo(IObject const *object, EncodeSink &sink);
+
+}
+
 }
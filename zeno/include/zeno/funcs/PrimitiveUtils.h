@@ -38,6 +38,9 @@ ZENO_API void prim_set_faceset(PrimitiveObject* prim, std::string faceset_name);
 
 ZENO_API void primFilterVerts(PrimitiveObject *prim, std::string tagAttr, int tagValue, bool isInversed = false, std::string revampAttrO = {}, std::string method = "verts");
 
+// connected components over lines, tris, quads and polys; labels are 0..count-1 in
+// order of each island's first vertex, the same for any thread count
+ZENO_API int primIslandLabels(PrimitiveObject const *prim, std::vector<int> &labels);
 ZENO_API void primMarkIsland(PrimitiveObject *prim, std::string tagAttr);
 ZENO_API std::vector<std::shared_ptr<PrimitiveObject>> primUnmergeVerts(PrimitiveObject *prim, std::string tagAttr);
 ZENO_API std::vector<std::shared_ptr<PrimitiveObject>> primUnmergeFaces(PrimitiveObject *prim, std::string tagAttr);
@@ -50,10 +53,16 @@ ZENO_API void primScale(PrimitiveObject *prim, vec3f const &scale);
 
 ZENO_API std::pair<vec3f, vec3f> primBoundingBox(PrimitiveObject *prim);
 
+// tet of tetPrim->quads containing each point (the lowest one on shared faces) and its
+// barycentric weights, -1 when none does; with fitting such points take the nearest
+// tet instead, weights clamped onto it; looked up through a grid over the tets' boxes
+ZENO_API void primTetEmbed(PrimitiveObject const *tetPrim, std::vector<vec3f> const &points,
+                           std::vector<int> &tetIds, std::vector<vec4f> &weights, bool fitting = false);
+
 ZENO_API void primRandomize(PrimitiveObject *prim, std::string attr, std::string dirAttr, std::string seedAttr, std::string randType, float base, float scale, int seed);
 ZENO_API void primPerlinNoise(PrimitiveObject *prim, std::string inAttr, std::string outAttr, std::string outType, float scale, float detail, float roughness, float disortion, vec3f offset, float average, float strength);
 
 ZENO_API std::shared_ptr<PrimitiveObject> primScatter(
-    PrimitiveObject *prim, std::string type, std::string denAttr, float density, float minRadius, bool interpAttrs, int seed);
+    PrimitiveObject *prim, std::string type, std::string denAttr, float density, float minRadius, bool interpAttrs, int seed, std::string radAttr = {});
 
 }
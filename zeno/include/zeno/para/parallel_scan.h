@@ -32,7 +32,7 @@ Value parallel_exclusive_scan(Index first, Index last, OutputIt dest,
             counter_iterator<Index>(first), counter_iterator<Index>(last),
             dest, initVal, reduceFn, transformFn);
     if (first != last)
-        return reduceFn(*std::prev(endp), transformFn(*std::prev(last)));
+        return reduceFn(*std::prev(endp), transformFn(*std::prev(counter_iterator<Index>(last))));
     else
         return initVal;
 }
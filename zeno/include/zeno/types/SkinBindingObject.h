@@ -0,0 +1,50 @@
+#pragma once
+
+#include <zeno/core/IObject.h>
+#include <zeno/utils/api.h>
+#include <zeno/utils/vec.h>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include <array>
+
+namespace zeno {
+
+// joint influences of a mesh packed for deformation, built once and reused for every
+// frame: each vertex owns the same number of slots, heaviest influence first and
+// weights summing to one; unused slots (and all slots of an unbound vertex) point at
+// joint 0 with weight 0
+struct SkinBindingObject : IObjectClone<SkinBindingObject> {
+    // rows of the upper 3x4 block of an affine bone transform
+    using Matrix = std::array<vec4f, 3>;
+
+    int width = 0;
+    int numJoints = 0;
+    std::vector<int> joints;        // size() * width
+    std::vector<float> weights;     // size() * width
+
+    std::size_t size() const {
+        return width ? weights.size() / width : 0;
+    }
+
+    bool isBound(std::size_t vert) const {
+        return width && weights[vert * width] > 0;
+    }
+};
+
+// binds per-vertex influence lists given as CSR (offsets has one entry per vertex plus
+// one), non-positive weights are dropped, and only the maxInfluences heaviest are kept
+// unless it is 0
+ZENO_API std::shared_ptr<SkinBindingObject> skinBind(std::vector<int> const &offsets,
+                                                     std::vector<int> const &joints,
+                                                     std::vector<float> const &weights,
+                                                     int maxInfluences = 0);
+
+// moves the bound vertices of pos (and nrm when given) in place by the bones, blending
+// matrices (LBS) or, with dualQuat, the rigid part of each bone as dual quaternions
+// (DQS); unbound vertices are left as they are
+ZENO_API void skinDeform(SkinBindingObject const &binding,
+                         std::vector<SkinBindingObject::Matrix> const &bones,
+                         bool dualQuat, vec3f *pos, vec3f *nrm = nullptr);
+
+}
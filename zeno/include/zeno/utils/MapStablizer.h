@@ -64,6 +64,16 @@ struct MapStablizer {
         m_curr.clear();
     }
 
+    // direct edits, for callers that know what changed and skip the insert pass
+    template <class ...Args>
+    auto try_emplace(key_type const &key, Args &&...args) {
+        return m_curr.try_emplace(key, std::forward<Args>(args)...);
+    }
+
+    std::size_t erase(key_type const &key) {
+        return m_curr.erase(key);
+    }
+
     struct InsertPass : scope_finalizer<InsertPass> {
         MapStablizer &that;
 
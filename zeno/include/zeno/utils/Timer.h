@@ -20,7 +20,7 @@ public:
     };
 
 private:
-    static Timer *current;
+    static thread_local Timer *current;  // timers nest per thread, loop bodies may run on workers
     static std::vector<Record> records;
 
     Timer *parent = nullptr;
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <zeno/utils/disable_copy.h>
+#include <unordered_map>
+#include <functional>
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <atomic>
+#include <memory>
+#include <limits>
+#include <vector>
+#include <mutex>
+#include <tuple>
+
+namespace zeno {
+
+// a cache shared by all threads running nodes, in place of ad-hoc map members and
+// static maps behind one mutex: keys are spread over independently locked shards,
+// each entry is computed once (concurrent callers of the same key wait for that
+// one computation, different keys compute in parallel) and values are handed out
+// as shared_ptr, so an evicted value lives on until its last user lets go of it;
+// entries carry a cost (1 each by default, or e.g. bytes through the cost
+// function), least recently used ones are evicted once the total exceeds capacity
+template <class Key, class Value, class Hash = std::hash<Key>, std::size_t NShards = 16>
+struct ConcurrentCache : disable_copy {
+    using value_ptr = std::shared_ptr<Value>;
+    using cost_function = std::function<std::size_t(Value const &)>;
+
+private:
+    struct Entry {
+        std::mutex mtx;                     // held while the value is computed
+        value_ptr value;
+        std::size_t cost = 0;
+        std::atomic<bool> ready{false};
+        bool failed = false;
+        std::atomic<std::uint64_t> lastUse{0};
+    };
+
+    struct alignas(64) Shard {
+        std::mutex mtx;
+        std::unordered_map<Key, std::shared_ptr<Entry>, Hash> map;
+    };
+
+    Shard m_shards[NShards];
+    std::size_t m_capacity;
+    cost_function m_costFn;
+    std::atomic<std::size_t> m_totalCost{0};
+    std::atomic<std::uint64_t> m_clock{0};
+    std::mutex m_evictMtx;
+
+    Shard &shard_of(Key const &key) {
+        // the maps buckets by the low bits of the same hash, take the shard from the high ones
+        return m_shards[(std::uint64_t(Hash{}(key)) * 0x9e3779b97f4a7c15ull >> 40) % NShards];
+    }
+
+    // drop the entry of key if it is still the given one
+    std::size_t erase_entry(Shard &shard, Key const &key, Entry const *entry) {
+        std::lock_guard lck(shard.mtx);
+        auto it = shard.map.find(key);
+        if (it == shard.map.end() || it->second.get() != entry)
+            return 0;
+        std::size_t cost = entry->ready.load(std::memory_order_acquire) ? entry->cost : 0;
+        shard.map.erase(it);
+        return cost;
+    }
+
+    void evict(Entry const *keep) {
+        // one evicting thread is enough, the others go on with their own work
+        std::unique_lock elck(m_evictMtx, std::try_to_lock);
+        if (!elck.owns_lock())
+            return;
+        std::vector<std::tuple<std::uint64_t, Shard *, Key, Entry const *>> candidates;
+        for (auto &shard: m_shards) {
+            std::lock_guard lck(shard.mtx);
+            for (auto const &[key, entry]: shard.map) {
+                if (entry.get() != keep && entry->ready.load(std::memory_order_acquire))
+                    candidates.emplace_back(entry->lastUse.load(std::memory_order_relaxed), &shard, key, entry.get());
+            }
+        }
+        std::sort(candidates.begin(), candidates.end(), [] (auto const &a, auto const &b) {
+            return std::get<0>(a) < std::get<0>(b);
+        });
+        for (auto const &[lastUse, shard, key, entry]: candidates) {
+            if (m_totalCost.load() <= m_capacity)
+                break;
+            m_totalCost -= erase_entry(*shard, key, entry);
+        }
+    }
+
+public:
+    // capacity is in units of the cost function, the number of entries without one
+    explicit ConcurrentCache(std::size_t capacity = std::numeric_limits<std::size_t>::max(), cost_function costFn = {})
+        : m_capacity(capacity), m_costFn(std::move(costFn)) {
+    }
+
+    // value of key, computed by compute() (returning a value_ptr) when not cached yet;
+    // if compute() throws or returns null nothing is kept, and any caller waiting on
+    // the same key retries the computation itself
+    template <class F>
+    value_ptr get_or_compute(Key const &key, F &&compute) {
+        auto &shard = shard_of(key);
+        while (true) {
+            std::shared_ptr<Entry> entry;
+            {
+                std::lock_guard lck(shard.mtx);
+                auto &slot = shard.map[key];
+                if (!slot)
+                    slot = std::make_shared<Entry>();
+                entry = slot;
+            }
+            entry->lastUse.store(++m_clock, std::memory_order_relaxed);
+            if (entry->ready.load(std::memory_order_acquire))
+                return entry->value;
+
+            std::unique_lock elck(entry->mtx);
+            if (entry->ready.load(std::memory_order_acquire))
+                return entry->value;
+            if (entry->failed)
+                continue;
+            value_ptr value;
+            try {
+                value = compute();
+            } catch (...) {
+                entry->failed = true;
+                erase_entry(shard, key, entry.get());
+                throw;
+            }
+            if (!value) {
+                entry->failed = true;
+                erase_entry(shard, key, entry.get());
+                return value;
+            }
+            entry->value = value;
+            entry->cost = m_costFn ? m_costFn(*value) : 1;
+            bool counted = false;
+            {
+                // an entry is counted while it is ready and in the map, both change under the shard lock
+                std::lock_guard lck(shard.mtx);
+                entry->ready.store(true, std::memory_order_release);
+                if (auto it = shard.map.find(key); it != shard.map.end() && it->second == entry) {
+                    m_totalCost += entry->cost;
+                    counted = true;
+                }
+            }
+            elck.unlock();
+
+            if (counted && m_totalCost.load() > m_capacity)
+                evict(entry.get());
+            return value;
+        }
+    }
+
+    // cached value of key, null when absent or still being computed
+    value_ptr find(Key const &key) {
+        auto &shard = shard_of(key);
+        std::lock_guard lck(shard.mtx);
+        auto it = shard.map.find(key);
+        if (it == shard.map.end() || !it->second->ready.load(std::memory_order_acquire))
+            return nullptr;
+        it->second->lastUse.store(++m_clock, std::memory_order_relaxed);
+        return it->second->value;
+    }
+
+    void erase(Key const &key) {
+        auto &shard = shard_of(key);
+        std::lock_guard lck(shard.mtx);
+        auto it = shard.map.find(key);
+        if (it == shard.map.end())
+            return;
+        if (it->second->ready.load(std::memory_order_acquire))
+            m_totalCost -= it->second->cost;
+        shard.map.erase(it);
+    }
+
+    void clear() {
+        for (auto &shard: m_shards) {
+            std::lock_guard lck(shard.mtx);
+            for (auto const &[key, entry]: shard.map) {
+                if (entry->ready.load(std::memory_order_acquire))
+                    m_totalCost -= entry->cost;
+            }
+            shard.map.clear();
+        }
+    }
+
+    std::size_t size() {
+        std::size_t n = 0;
+        for (auto &shard: m_shards) {
+            std::lock_guard lck(shard.mtx);
+            n += shard.map.size();
+        }
+        return n;
+    }
+
+    std::size_t total_cost() const {
+        return m_totalCost.load();
+    }
+};
+
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <zeno/utils/disable_copy.h>
+#include <filesystem>
+#include <string>
+#include <cstddef>
+#ifdef _WIN32
+#include <zeno/utils/fuck_win.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace zeno {
+
+// read-only memory mapping of a whole file, pages are faulted in on access,
+// so huge inputs can be scanned without copying them into a std::vector first
+struct mapped_file : disable_copy {
+private:
+    char const *m_data = nullptr;
+    std::size_t m_size = 0;
+#ifdef _WIN32
+    HANDLE m_file = INVALID_HANDLE_VALUE;
+    HANDLE m_mapping = nullptr;
+#endif
+
+public:
+    mapped_file() = default;
+
+    explicit mapped_file(std::string const &path) {
+        open(path);
+    }
+
+    ~mapped_file() {
+        close();
+    }
+
+    bool open(std::string const &path) {
+        close();
+#ifdef _WIN32
+        auto native_path = std::filesystem::u8path(path).wstring();
+        m_file = CreateFileW(native_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                             OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (m_file == INVALID_HANDLE_VALUE)
+            return false;
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(m_file, &size)) {
+            close();
+            return false;
+        }
+        m_size = (std::size_t)size.QuadPart;
+        if (m_size == 0)
+            return true;
+        m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!m_mapping) {
+            close();
+            return false;
+        }
+        m_data = (char const *)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!m_data) {
+            close();
+            return false;
+        }
+#else
+        auto native_path = std::filesystem::u8path(path).string();
+        int fd = ::open(native_path.c_str(), O_RDONLY);
+        if (fd == -1)
+            return false;
+        struct stat st;
+        if (::fstat(fd, &st) == -1) {
+            ::close(fd);
+            return false;
+        }
+        m_size = (std::size_t)st.st_size;
+        if (m_size == 0) {
+            ::close(fd);
+            return true;
+        }
+        void *p = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) {
+            m_size = 0;
+            return false;
+        }
+        ::madvise(p, m_size, MADV_SEQUENTIAL);
+        m_data = (char const *)p;
+#endif
+        return true;
+    }
+
+    void close() {
+#ifdef _WIN32
+        if (m_data)
+            UnmapViewOfFile(m_data);
+        if (m_mapping)
+            CloseHandle(m_mapping);
+        if (m_file != INVALID_HANDLE_VALUE)
+            CloseHandle(m_file);
+        m_mapping = nullptr;
+        m_file = INVALID_HANDLE_VALUE;
+#else
+        if (m_data)
+            ::munmap((void *)m_data, m_size);
+#endif
+        m_data = nullptr;
+        m_size = 0;
+    }
+
+    char const *data() const {
+        return m_data;
+    }
+
+    std::size_t size() const {
+        return m_size;
+    }
+
+    bool empty() const {
+        return m_size == 0;
+    }
+};
+
+}
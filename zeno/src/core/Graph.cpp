@@ -15,6 +15,7 @@
 #include <zeno/utils/Error.h>
 #include <zeno/utils/log.h>
 #include <iostream>
+#include <vector>
 
 namespace zeno {
 
@@ -23,6 +24,7 @@ ZENO_API Context::~Context() = default;
 
 ZENO_API Context::Context(Context const &other)
     : visited(other.visited)
+    , parent(other.parent)
 {}
 
 ZENO_API Graph::Graph() = default;
@@ -56,6 +58,24 @@ ZENO_API void Graph::addNode(std::string const &cls, std::string const &id) {
     nodes[id] = std::move(node);
 }
 
+ZENO_API void Graph::removeNode(std::string const &id) {
+    auto it = nodes.find(id);
+    if (it == nodes.end())
+        return;
+    nodesToExec.erase(id);
+    for (auto *m: {&subInputNodes, &subOutputNodes, &portalIns}) {
+        for (auto mit = m->begin(); mit != m->end();) {
+            if (mit->second == id)
+                mit = m->erase(mit);
+            else
+                ++mit;
+        }
+    }
+    if (dirtyChecker)
+        dirtyChecker->dirts.erase(id);
+    nodes.erase(it);
+}
+
 ZENO_API Graph *Graph::addSubnetNode(std::string const &id) {
     auto subcl = std::make_unique<ImplSubnetNodeClass>();
     auto node = subcl->new_instance();
@@ -80,7 +100,7 @@ ZENO_API void Graph::completeNode(std::string const &id) {
 }
 
 ZENO_API bool Graph::applyNode(std::string const &id) {
-    if (ctx->visited.find(id) != ctx->visited.end()) {
+    if (ctx->isVisited(id)) {
         return false;
     }
     ctx->visited.insert(id);
@@ -116,6 +136,22 @@ ZENO_API void Graph::bindNodeInput(std::string const &dn, std::string const &ds,
     safe_at(nodes, dn, "node name")->inputBounds[ds] = std::pair(sn, ss);
 }
 
+ZENO_API void Graph::unbindNodeInput(std::string const &dn, std::string const &ds) {
+    auto node = safe_at(nodes, dn, "node name").get();
+    node->inputBounds.erase(ds);
+    node->inputs.erase(ds);
+}
+
+ZENO_API void Graph::clearNodeInputs(std::string const &id) {
+    // forget everything the previous commands told this node, so that a patch
+    // can resend its full input list without leaving stale sockets behind
+    auto node = safe_at(nodes, id, "node name").get();
+    node->inputBounds.clear();
+    node->inputs.clear();
+    node->kframes.clear();
+    node->formulas.clear();
+}
+
 ZENO_API void Graph::setNodeInput(std::string const &id, std::string const &par,
         zany const &val) {
     safe_at(nodes, id, "node name")->inputs[par] = val;
@@ -178,6 +214,28 @@ ZENO_API void Graph::setNodeParam(std::string const &id, std::string const &par,
     }, val);
 }
 
+ZENO_API void Graph::markDirtyDownstream(std::set<std::string> const &ids) {
+    std::map<std::string, std::vector<std::string>> consumers;
+    for (auto const &[id, node]: nodes) {
+        for (auto const &[ds, bound]: node->inputBounds) {
+            consumers[bound.first].push_back(id);
+        }
+    }
+
+    auto &dc = getDirtyChecker();
+    std::set<std::string> visited;
+    std::vector<std::string> stack(ids.begin(), ids.end());
+    while (!stack.empty()) {
+        auto id = std::move(stack.back());
+        stack.pop_back();
+        if (!visited.insert(id).second)
+            continue;
+        dc.taintThisNode(id);
+        if (auto it = consumers.find(id); it != consumers.end())
+            stack.insert(stack.end(), it->second.begin(), it->second.end());
+    }
+}
+
 ZENO_API DirtyChecker &Graph::getDirtyChecker() {
     if (!dirtyChecker)
         dirtyChecker = std::make_unique<DirtyChecker>();
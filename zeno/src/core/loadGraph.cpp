@@ -5,11 +5,17 @@
 #include <zeno/funcs/ParseObjectFromUi.h>
 #include <zeno/extra/GraphException.h>
 #include <zeno/extra/DirtyChecker.h>
+#include <zeno/extra/SubnetNode.h>
 #include <zeno/utils/logger.h>
+#include <zeno/utils/safe_at.h>
 #include <zeno/utils/vec.h>
 #include <zeno/utils/zeno_p.h>
 #include <zeno/zeno.h>
+#include <algorithm>
+#include <vector>
 #include <stack>
+#include <set>
+#include <map>
 
 namespace zeno {
 
@@ -67,68 +73,235 @@ static T generic_get(Value const &x) {
     }
 }
 
-ZENO_API void Graph::loadGraph(const char *json) {
-    Document d;
-    d.Parse(json);
+struct SubnetDefinition {
+    Document commands;
+};
 
-    if (!d.IsArray()) {
-        throw GraphException { "None", nullptr };
+namespace {
+
+// what a patch touched, so that only those nodes and their downstream get
+// tainted instead of the whole graph
+struct PatchRecord {
+    std::map<Graph *, std::set<std::string>> touched;
+    std::map<Graph *, std::pair<Graph *, std::string>> parents;
+    std::map<Graph *, int> depths;
+
+    void touch(Graph *g, std::string const &ident) {
+        touched[g].insert(ident);
     }
 
-    Graph *g = this;
+    void enterScope(Graph *parent, Graph *g, std::string const &ident) {
+        parents.try_emplace(g, parent, ident);
+        depths[g] = depths[parent] + 1;
+    }
+
+    void forgetSubgraphs(Graph *g, std::string const &ident) {
+        // the subnet is about to be destroyed, drop any reference to its graphs
+        auto it = g->nodes.find(ident);
+        if (it == g->nodes.end())
+            return;
+        auto subnode = dynamic_cast<SubnetNode *>(it->second.get());
+        if (!subnode)
+            return;
+        auto subg = subnode->subgraph.get();
+        for (auto const &[subid, _]: subg->nodes)
+            forgetSubgraphs(subg, subid);
+        touched.erase(subg);
+        parents.erase(subg);
+        depths.erase(subg);
+    }
+
+    static void taintSubnetInputs(Graph *g) {
+        if (!g->dirtyChecker)
+            return;
+        for (auto const &[id, node]: g->nodes) {
+            if (!g->dirtyChecker->amIDirty(id))
+                continue;
+            if (auto subnode = dynamic_cast<SubnetNode *>(node.get())) {
+                auto subg = subnode->subgraph.get();
+                std::set<std::string> seeds;
+                for (auto const &[key, nodeid]: subg->subInputNodes)
+                    seeds.insert(nodeid);
+                subg->markDirtyDownstream(seeds);
+                taintSubnetInputs(subg);
+            }
+        }
+    }
+
+    void apply(Graph *root) {
+        // inner changes bubble up through their subnet nodes first (deepest
+        // scope first), then dirty subnet nodes flow down into their inputs
+        std::vector<std::pair<int, Graph *>> order;
+        for (auto const &[g, depth]: depths)
+            order.emplace_back(depth, g);
+        if (!depths.count(root))
+            order.emplace_back(0, root);
+        std::sort(order.begin(), order.end(), [] (auto const &a, auto const &b) {
+            return a.first > b.first;
+        });
+        for (auto const &[depth, g]: order) {
+            auto it = touched.find(g);
+            if (it == touched.end())
+                continue;
+            std::set<std::string> seeds;
+            for (auto const &id: it->second) {
+                if (g->nodes.count(id))
+                    seeds.insert(id);
+            }
+            g->markDirtyDownstream(seeds);
+            // removed nodes are gone, but whoever consumed them still changed
+            for (auto const &[id, node]: g->nodes) {
+                for (auto const &[ds, bound]: node->inputBounds) {
+                    if (it->second.count(bound.first) && !g->nodes.count(bound.first))
+                        g->markDirtyDownstream({id});
+                }
+            }
+            if (auto pit = parents.find(g); pit != parents.end())
+                touched[pit->second.first].insert(pit->second.second);
+        }
+        taintSubnetInputs(root);
+    }
+};
+
+void clearDirty(Graph *g) {
+    if (g->dirtyChecker)
+        g->dirtyChecker->clear();
+    for (auto const &[id, node]: g->nodes) {
+        if (auto subnode = dynamic_cast<SubnetNode *>(node.get()))
+            clearDirty(subnode->subgraph.get());
+    }
+}
+
+std::string mangleIdent(std::string const &prefix, const char *ident) {
+    if (prefix.empty())
+        return ident;
+    return prefix + "/" + ident;
+}
+
+void runGraphCommands(Graph *root, Graph *g, Value const &d, std::string const &prefix, PatchRecord *patch) {
     std::stack<Graph *> gStack;
 
     for (int i = 0; i < d.Size(); i++) {
         Value const &di = d[i];
         std::string cmd = di[0].GetString();
-        const char *maybeNodeName = cmd == "addNode" ? di[2].GetString() : (
-            di.Size() >= 1 && di[1].IsString() ? di[1].GetString() : "(not a node)");
+
+        if (cmd == "defineSubnet") {
+            // keep the body aside, it is replayed once per addSubnetInstance
+            auto def = std::make_shared<SubnetDefinition>();
+            def->commands.SetArray();
+            auto &alloc = def->commands.GetAllocator();
+            int depth = 1;
+            for (i++; i < d.Size(); i++) {
+                std::string subcmd = d[i][0].GetString();
+                if (subcmd == "defineSubnet") {
+                    depth++;
+                } else if (subcmd == "endSubnet" && --depth == 0) {
+                    break;
+                }
+                def->commands.PushBack(Value(d[i], alloc), alloc);
+            }
+            root->subnetDefs[di[1].GetString()] = std::move(def);
+            continue;
+        }
+
+        // idents inside a subnet definition are relative to the instance
+        auto ident = [&] (int k) {
+            return mangleIdent(prefix, di[k].GetString());
+        };
+        std::string maybeNodeName = cmd == "addNode" || cmd == "addSubnetInstance" ? ident(2) : (
+            di.Size() >= 1 && di[1].IsString() ? ident(1) : "(not a node)");
         //ZENO_P(cmd);
         //ZENO_P(maybeNodeName);
         GraphException::translated([&] {
             if (0) {
             } else if (cmd == "addNode") {
-                g->addNode(di[1].GetString(), di[2].GetString());
+                g->addNode(di[1].GetString(), ident(2));
+            } else if (cmd == "removeNode") {
+                if (patch)
+                    patch->forgetSubgraphs(g, ident(1));
+                g->removeNode(ident(1));
             } else if (cmd == "setNodeInput") {
-                g->setNodeInput(di[1].GetString(), di[2].GetString(), generic_get<zany>(di[3]));
+                g->setNodeInput(ident(1), di[2].GetString(), generic_get<zany>(di[3]));
             } else if (cmd == "setKeyFrame") {
-                g->setKeyFrame(di[1].GetString(), di[2].GetString(), generic_get<zany>(di[3]));
+                g->setKeyFrame(ident(1), di[2].GetString(), generic_get<zany>(di[3]));
             } else if (cmd == "setFormula") {
-                g->setFormula(di[1].GetString(), di[2].GetString(), generic_get<zany>(di[3]));
+                g->setFormula(ident(1), di[2].GetString(), generic_get<zany>(di[3]));
             } else if (cmd == "setNodeParam") {
-                g->setNodeParam(di[1].GetString(), di[2].GetString(), generic_get<std::variant<int, float, std::string, zany>, false>(di[3]));
+                g->setNodeParam(ident(1), di[2].GetString(), generic_get<std::variant<int, float, std::string, zany>, false>(di[3]));
             } else if (cmd == "bindNodeInput") {
-                g->bindNodeInput(di[1].GetString(), di[2].GetString(), di[3].GetString(), di[4].GetString());
+                g->bindNodeInput(ident(1), di[2].GetString(), ident(3), di[4].GetString());
+            } else if (cmd == "unbindNodeInput") {
+                g->unbindNodeInput(ident(1), di[2].GetString());
+            } else if (cmd == "clearNodeInputs") {
+                g->clearNodeInputs(ident(1));
             } else if (cmd == "completeNode") {
-                g->completeNode(di[1].GetString());
+                g->completeNode(ident(1));
             } else if (cmd == "addSubnetNode") {
-                auto newG = g->addSubnetNode(/*di[1].GetString(), */di[2].GetString());
+                auto newG = g->addSubnetNode(/*di[1].GetString(), */ident(2));
+            } else if (cmd == "addSubnetInstance") {
+                auto const &def = safe_at(root->subnetDefs, di[1].GetString(), "subnet definition");
+                auto newG = g->addSubnetNode(ident(2));
+                if (patch)
+                    patch->enterScope(g, newG, ident(2));
+                runGraphCommands(root, newG, def->commands, mangleIdent(prefix, di[3].GetString()), patch);
             } else if (cmd == "addNodeOutput") {
-                g->addNodeOutput(di[1].GetString(), di[2].GetString());
+                g->addNodeOutput(ident(1), di[2].GetString());
             } else if (cmd == "pushSubnetScope") {
                 gStack.push(g);
-                g = g->getSubnetGraph(di[1].GetString());
+                g = g->getSubnetGraph(ident(1));
+                if (patch)
+                    patch->enterScope(gStack.top(), g, ident(1));
             } else if (cmd == "popSubnetScope") {
                 g = gStack.top();
                 gStack.pop();
             } else if (cmd == "setBeginFrameNumber") {
-                this->beginFrameNumber = di[1].GetInt();
+                root->beginFrameNumber = di[1].GetInt();
             } else if (cmd == "setEndFrameNumber") {
-                this->endFrameNumber = di[1].GetInt();
+                root->endFrameNumber = di[1].GetInt();
             } else if (cmd == "setNodeOption") {
                 // skip this for compatibility
             } else if (cmd == "markNodeChanged") {
-                auto ident = di[1].GetString();
                 auto &dc = g->getDirtyChecker();
-                dc.taintThisNode(ident);
+                dc.taintThisNode(ident(1));
                 //todo: mark node data change.
             } else if (cmd == "cacheToDisk") {
-                g->setTempCache(di[1].GetString());
+                g->setTempCache(ident(1));
             } else {
                 log_warn("got unexpected command: {}", cmd);
             }
+            if (patch && di.Size() >= 2 && di[1].IsString() && cmd != "pushSubnetScope") {
+                patch->touch(g, cmd == "addNode" || cmd == "addSubnetNode" || cmd == "addSubnetInstance"
+                             ? ident(2) : ident(1));
+            }
         }, maybeNodeName);
     }
 }
 
+void runGraphCommands(Graph *root, const char *json, PatchRecord *patch) {
+    Document d;
+    d.Parse(json);
+
+    if (!d.IsArray()) {
+        throw GraphException { "None", nullptr };
+    }
+
+    runGraphCommands(root, root, d, {}, patch);
+}
+
+}
+
+ZENO_API void Graph::loadGraph(const char *json) {
+    runGraphCommands(this, json, nullptr);
+}
+
+// apply a diff (same command set as loadGraph, plus removeNode, unbindNodeInput
+// and clearNodeInputs) onto an already loaded graph; only the touched nodes and
+// everything downstream of them are marked dirty, the rest keep their caches
+ZENO_API void Graph::patchGraph(const char *json) {
+    clearDirty(this);
+    PatchRecord patch;
+    runGraphCommands(this, json, &patch);
+    patch.apply(this);
+}
+
 }
@@ -35,59 +35,48 @@ void GlobalComm::toDisk(std::string cachedir, int frameid, GlobalComm::ViewObjec
     std::vector<std::vector<char>> bufCaches(3);
     std::vector<std::vector<size_t>> poses(3);
     std::vector<std::string> keys(3);
+    std::vector<std::vector<std::string const *>> catKeys(3);
+    std::vector<std::vector<IObject const *>> catObjs(3);
     for (auto const &[key, obj]: objs) {
 
-        size_t bufsize =0;
         std::string nodeName = key.substr(key.find("-") + 1, key.find(":") - key.find("-") -1);
+        auto addTo = [&, &key = key, &obj = obj] (int i) {
+            catKeys[i].push_back(&key);
+            catObjs[i].push_back(obj.get());
+        };
         if (cacheLightCameraOnly && (lightCameraNodes.count(nodeName) || obj->userData().get2<int>("isL", 0) || std::dynamic_pointer_cast<CameraObject>(obj)))
         {
-            bufsize = bufCaches[0].size();
-            if (encodeObject(obj.get(), bufCaches[0]))
-            {
-                keys[0].push_back('\a');
-                keys[0].append(key);
-                poses[0].push_back(bufsize);
-            }
+            addTo(0);
         }
         if (cacheMaterialOnly && (matNodeNames.count(nodeName)>0 || std::dynamic_pointer_cast<MaterialObject>(obj)))
         {
-            bufsize = bufCaches[1].size();
-            if (encodeObject(obj.get(), bufCaches[1]))
-            {
-                keys[1].push_back('\a');
-                keys[1].append(key);
-                poses[1].push_back(bufsize);
-            }
+            addTo(1);
         }
         if (!cacheLightCameraOnly && !cacheMaterialOnly)
         {
             if (lightCameraNodes.count(nodeName) || obj->userData().get2<int>("isL", 0) || std::dynamic_pointer_cast<CameraObject>(obj)) {
-                bufsize = bufCaches[0].size();
-                if (encodeObject(obj.get(), bufCaches[0]))
-                {
-                    keys[0].push_back('\a');
-                    keys[0].append(key);
-                    poses[0].push_back(bufsize);
-                }
+                addTo(0);
             } else if (matNodeNames.count(nodeName)>0 || std::dynamic_pointer_cast<MaterialObject>(obj)) {
-                bufsize = bufCaches[1].size();
-                if (encodeObject(obj.get(), bufCaches[1]))
-                {
-                    keys[1].push_back('\a');
-                    keys[1].append(key);
-                    poses[1].push_back(bufsize);
-                }
+                addTo(1);
             } else {
-                bufsize = bufCaches[2].size();
-                if (encodeObject(obj.get(), bufCaches[2]))
-                {
-                    keys[2].push_back('\a');
-                    keys[2].append(key);
-                    poses[2].push_back(bufsize);
-                }
+                addTo(2);
             }
         }
     }
+    // the objects of a frame are independent, encode each category in one parallel batch
+    for (int i = 0; i < 3; i++)
+    {
+        std::vector<size_t> offsets;
+        encodeObjects(catObjs[i].data(), catObjs[i].size(), bufCaches[i], offsets);
+        for (size_t k = 0; k < catObjs[i].size(); k++)
+        {
+            if (offsets[k] == offsets[k + 1])
+                continue;
+            keys[i].push_back('\a');
+            keys[i].append(*catKeys[i][k]);
+            poses[i].push_back(offsets[k]);
+        }
+    }
 
     if (fileName == "")
     {
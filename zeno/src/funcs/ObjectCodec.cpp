@@ -39,7 +39,7 @@ namespace _implObjectCodec {
 
 #define _PER_OBJECT_TYPE(TypeName, ...) \
 std::shared_ptr<TypeName> decode##TypeName(const char *it); \
-bool encode##TypeName(TypeName const *obj, std::back_insert_iterator<std::vector<char>> it);
+bool encode##TypeName(TypeName const *obj, EncodeSink &sink);
 ZENO_XMACRO_IObject(_PER_OBJECT_TYPE)
 #undef _PER_OBJECT_TYPE
 
@@ -100,50 +100,110 @@ std::shared_ptr<IObject> decodeObject(const char *buf, size_t len) {
     return object;
 }
 
-static bool _encodeObjectImpl(IObject const *object, std::vector<char> &buf) {
-    auto it = std::back_inserter(buf);
+namespace _implObjectCodec {
+
+void EncodeSink::write(void const *data, size_t size) {
+    if (base) {
+        // big attribute arrays are copied by all threads, small writes stay inline
+        constexpr size_t kParallelCopy = size_t(1) << 24, kCopyChunk = size_t(1) << 20;
+        if (size >= kParallelCopy) {
+            auto dst = base + pos;
+            auto src = (char const *)data;
+            std::ptrdiff_t nchunks = (size + kCopyChunk - 1) / kCopyChunk;
+#pragma omp parallel for
+            for (std::ptrdiff_t c = 0; c < nchunks; c++) {
+                size_t b = c * kCopyChunk;
+                std::memcpy(dst + b, src + b, std::min(kCopyChunk, size - b));
+            }
+        } else {
+            std::memcpy(base + pos, data, size);
+        }
+    }
+    pos += size;
+}
+
+bool encodeObjectTo(IObject const *object, EncodeSink &sink) {
+    size_t start = sink.pos;
     ObjectHeader header;
     header.magicNumber = ObjectHeader::kMagicNumber;
+    header.numUserData = 0;
+    header.beginUserData = 0;
 
+    bool succ = false;
     if (0) {
 
 #define _PER_OBJECT_TYPE(TypeName, ...) \
     } else if (auto obj = dynamic_cast<TypeName const *>(object)) { \
         header.type = ObjectType::TypeName; \
-        it = std::copy_n((char *)&header, sizeof(ObjectHeader), it); \
-        return encode##TypeName(obj, it);
+        sink.write_value(header); \
+        succ = encode##TypeName(obj, sink);
 ZENO_XMACRO_IObject(_PER_OBJECT_TYPE)
 #undef _PER_OBJECT_TYPE
 
     } else {
         log_error("invalid object type to encode `{}`", cppdemangle(typeid(*object)));
+    }
+    if (!succ) {
+        sink.pos = start;
         return false;
     }
+
+    // each entry: size_t entry size, size_t key size, key, encoded value
+    header.beginUserData = sink.pos - start;
+    for (auto const &[key, val]: object->userData()) {
+        size_t entry = sink.pos;
+        sink.pos += sizeof(size_t);
+        size_t keysize = key.size();
+        sink.write_value(keysize);
+        sink.write(key.data(), keysize);
+        if (encodeObjectTo(val.get(), sink)) {
+            sink.patch_value(entry, size_t(sink.pos - entry - sizeof(size_t)));
+            header.numUserData++;
+        } else {
+            sink.pos = entry;
+        }
+    }
+    sink.patch_value(start, header);
+    return true;
+}
+
 }
 
 bool encodeObject(IObject const *object, std::vector<char> &buf) {
-    auto oldsize = buf.size();
-    if (!_encodeObjectImpl(object, buf))
+    EncodeMemo memo;
+    EncodeSink measure{nullptr, 0, &memo};
+    if (!encodeObjectTo(object, measure))
         return false;
 
-    std::vector<std::vector<char>> valbufs;
-    for (auto const &[key, val]: object->userData()) {
-        std::vector<char> valbuf;
-        size_t keysize = key.size();
-        valbuf.insert(valbuf.end(), (char *)&keysize, (char *)(&keysize + 1));
-        valbuf.insert(valbuf.end(), key.begin(), key.end());
-        if (encodeObject(val.get(), valbuf))
-            valbufs.push_back(std::move(valbuf));
+    auto oldsize = buf.size();
+    buf.resize(oldsize + measure.pos);
+    EncodeSink sink{buf.data(), oldsize, &memo};
+    encodeObjectTo(object, sink);
+    return true;
+}
+
+void encodeObjects(IObject const *const *objects, size_t count, std::vector<char> &buf, std::vector<size_t> &offsets) {
+    std::vector<size_t> sizes(count);
+    EncodeMemo memo;
+#pragma omp parallel for schedule(dynamic)
+    for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)count; i++) {
+        EncodeSink measure{nullptr, 0, &memo};
+        sizes[i] = encodeObjectTo(objects[i], measure) ? measure.pos : 0;
     }
-    auto &header = *(ObjectHeader *)(buf.data() + oldsize);
-    header.numUserData = valbufs.size();
-    header.beginUserData = buf.size() - oldsize;
-    for (auto const &valbuf: valbufs) {
-        size_t valbufsize = valbuf.size();
-        buf.insert(buf.end(), (char *)&valbufsize, (char *)(&valbufsize + 1));
-        buf.insert(buf.end(), valbuf.begin(), valbuf.end());
+
+    offsets.resize(count + 1);
+    offsets[0] = buf.size();
+    for (size_t i = 0; i < count; i++)
+        offsets[i + 1] = offsets[i] + sizes[i];
+    buf.resize(offsets[count]);
+
+#pragma omp parallel for schedule(dynamic)
+    for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)count; i++) {
+        if (!sizes[i])
+            continue;
+        EncodeSink sink{buf.data(), offsets[i], &memo};
+        encodeObjectTo(objects[i], sink);
     }
-    return true;
 }
 
 }
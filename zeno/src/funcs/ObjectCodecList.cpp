@@ -29,28 +29,38 @@ std::shared_ptr<ListObject> decodeListObject(const char *it) {
     return obj;
 }
 
-bool encodeListObject(ListObject const *obj, std::back_insert_iterator<std::vector<char>> it);
-bool encodeListObject(ListObject const *obj, std::back_insert_iterator<std::vector<char>> it) {
+bool encodeListObject(ListObject const *obj, EncodeSink &sink);
+bool encodeListObject(ListObject const *obj, EncodeSink &sink) {
     size_t size = obj->arr.size();
-    std::copy_n((char const *)&size, sizeof(size), it);
+    sink.write_value(size);
 
-    std::vector<char> buf;
-    std::vector<char> fin;
+    // elements are independent: measure them all, then write each at its own offset
     std::vector<size_t> tab(size * 2);
+    std::vector<char> succ(size);
+#pragma omp parallel for schedule(dynamic)
+    for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)size; i++) {
+        EncodeSink measure{nullptr, 0, sink.memo};
+        succ[i] = encodeObjectTo(obj->arr[i].get(), measure);
+        tab[i * 2 + 1] = measure.pos;
+    }
     size_t base = 0;
     for (size_t i = 0; i < size; i++) {
-        auto const *elm = obj->arr[i].get();
-        if (!encodeObject(elm, buf))
+        if (!succ[i])
             return false;
-        size_t len = buf.size();
-        fin.insert(fin.end(), buf.begin(), buf.end());
-        buf.clear();
         tab[i * 2] = base;
-        tab[i * 2 + 1] = len;
-        base += len;
+        base += tab[i * 2 + 1];
+    }
+    sink.write(tab.data(), tab.size() * sizeof(size_t));
+
+    size_t begin = sink.pos;
+    if (!sink.measuring()) {
+#pragma omp parallel for schedule(dynamic)
+        for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)size; i++) {
+            EncodeSink elm{sink.base, begin + tab[i * 2], sink.memo};
+            encodeObjectTo(obj->arr[i].get(), elm);
+        }
     }
-    std::copy_n(tab.data(), tab.size() * sizeof(size_t), it);
-    std::copy(fin.begin(), fin.end(), it);
+    sink.pos = begin + base;
 
     return true;
 }
@@ -27,13 +27,12 @@ std::shared_ptr<NumericObject> decodeNumericObject(const char *it) {
     return succ ? obj : nullptr;
 }
 
-bool encodeNumericObject(NumericObject const *obj, std::back_insert_iterator<std::vector<char>> it);
-bool encodeNumericObject(NumericObject const *obj, std::back_insert_iterator<std::vector<char>> it) {
+bool encodeNumericObject(NumericObject const *obj, EncodeSink &sink);
+bool encodeNumericObject(NumericObject const *obj, EncodeSink &sink) {
     size_t index = obj->value.index();
-    it = std::copy_n((char const *)&index, sizeof(index), it);
+    sink.write_value(index);
     std::visit([&] (auto const &val) {
-        using T = std::decay_t<decltype(val)>;
-        it = std::copy_n((char const *)&val, sizeof(val), it);
+        sink.write_value(val);
     }, obj->value);
     return true;
 }
@@ -47,12 +46,11 @@ std::shared_ptr<StringObject> decodeStringObject(const char *it) {
     return obj;
 }
 
-bool encodeStringObject(StringObject const *obj, std::back_insert_iterator<std::vector<char>> it);
-bool encodeStringObject(StringObject const *obj, std::back_insert_iterator<std::vector<char>> it) {
+bool encodeStringObject(StringObject const *obj, EncodeSink &sink);
+bool encodeStringObject(StringObject const *obj, EncodeSink &sink) {
     size_t size = obj->value.size();
-    char const *data = obj->value.data();
-    it = std::copy_n((char const *)&size, sizeof(size), it);
-    it = std::copy_n(data, size, it);
+    sink.write_value(size);
+    sink.write(obj->value.data(), size);
     return true;
 }
 
@@ -50,13 +50,13 @@ void decodeAttrVector(AttrVector<T0> &arr, It &it) {
     arr.update();
 }
 
-template <class T0, class It>
-void encodeAttrVector(AttrVector<T0> const &arr, It &it) {
+template <class T0>
+void encodeAttrVector(AttrVector<T0> const &arr, EncodeSink &sink) {
     AttrVectorHeader header;
     header.size = arr.size();
     header.nattrs = arr.template num_attrs<AttrAcceptAll>();
-    it = std::copy_n((char const *)&header, sizeof(header), it);
-    it = std::copy_n((char const *)arr.data(), sizeof(T0) * arr.size(), it);
+    sink.write_value(header);
+    sink.write(arr.data(), sizeof(T0) * arr.size());
 
     arr.template foreach_attr<AttrAcceptAll>([&] (auto const &key, auto const &attr) {
         AttributeHeader h;
@@ -65,8 +65,8 @@ void encodeAttrVector(AttrVector<T0> const &arr, It &it) {
         h.size = attr.size();
         h.namelen = key.size();
         std::strncpy(h.name, key.c_str(), sizeof(h.name));
-        it = std::copy_n((char const *)&h, sizeof(h), it);
-        it = std::copy_n((char const *)attr.data(), sizeof(T) * attr.size(), it);
+        sink.write_value(h);
+        sink.write(attr.data(), sizeof(T) * attr.size());
     });
 }
 
@@ -91,23 +91,22 @@ std::shared_ptr<PrimitiveObject> decodePrimitiveObject(const char *it) {
     return obj;
 }
 
-bool encodePrimitiveObject(PrimitiveObject const *obj, std::back_insert_iterator<std::vector<char>> it);
-bool encodePrimitiveObject(PrimitiveObject const *obj, std::back_insert_iterator<std::vector<char>> it) {
-    encodeAttrVector(obj->verts, it);
-    encodeAttrVector(obj->points, it);
-    encodeAttrVector(obj->lines, it);
-    encodeAttrVector(obj->tris, it);
-    encodeAttrVector(obj->quads, it);
-    encodeAttrVector(obj->loops, it);
-    encodeAttrVector(obj->polys, it);
-    encodeAttrVector(obj->edges, it);
-    encodeAttrVector(obj->uvs, it);
+bool encodePrimitiveObject(PrimitiveObject const *obj, EncodeSink &sink);
+bool encodePrimitiveObject(PrimitiveObject const *obj, EncodeSink &sink) {
+    encodeAttrVector(obj->verts, sink);
+    encodeAttrVector(obj->points, sink);
+    encodeAttrVector(obj->lines, sink);
+    encodeAttrVector(obj->tris, sink);
+    encodeAttrVector(obj->quads, sink);
+    encodeAttrVector(obj->loops, sink);
+    encodeAttrVector(obj->polys, sink);
+    encodeAttrVector(obj->edges, sink);
+    encodeAttrVector(obj->uvs, sink);
     if (obj->mtl) {
-        *it++ = '1';
-        for (char c: obj->mtl->serialize())
-            *it++ = c;
+        sink.write("1", 1);
+        sink.write_memoized(obj->mtl.get(), [&] { return obj->mtl->serialize(); });
     } else {
-        *it++ = '0';
+        sink.write("0", 1);
     }
     return true;
 }
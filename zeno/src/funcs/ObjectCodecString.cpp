@@ -16,10 +16,9 @@ std::shared_ptr<MaterialObject> decodeMaterialObject(const char *it) {
     return mtl;
 }
 
-bool encodeMaterialObject(MaterialObject const *obj, std::back_insert_iterator<std::vector<char>> it);
-bool encodeMaterialObject(MaterialObject const *obj, std::back_insert_iterator<std::vector<char>> it) {
-    auto v = obj->serialize();
-    std::copy(v.begin(), v.end(), it);
+bool encodeMaterialObject(MaterialObject const *obj, EncodeSink &sink);
+bool encodeMaterialObject(MaterialObject const *obj, EncodeSink &sink) {
+    sink.write_memoized(obj, [&] { return obj->serialize(); });
     return true;
 }
 
@@ -28,8 +27,8 @@ std::shared_ptr<DummyObject> decodeDummyObject(const char *it) {
     return std::make_shared<DummyObject>();
 }
 
-bool encodeDummyObject(DummyObject const *obj, std::back_insert_iterator<std::vector<char>> it);
-bool encodeDummyObject(DummyObject const *obj, std::back_insert_iterator<std::vector<char>> it) {
+bool encodeDummyObject(DummyObject const *obj, EncodeSink &sink);
+bool encodeDummyObject(DummyObject const *obj, EncodeSink &sink) {
     return true;
 }
 
@@ -4,26 +4,23 @@
 #include <zeno/types/StringObject.h>
 #include <zeno/types/ConditionObject.h>
 #include <zeno/extra/evaluate_condition.h>
+#include <zeno/utils/concurrent_cache.h>
 #include <zeno/core/Graph.h>
 
 
 namespace zeno {
 
 struct CachedByKey : zeno::INode {
-    std::map<std::string, std::shared_ptr<IObject>> cache;
+    ConcurrentCache<std::string, IObject> cache;
 
     virtual void preApply() override {
         requireInput("key");
         auto key = get_input<zeno::StringObject>("key")->get();
-        if (auto it = cache.find(key); it != cache.end()) {
-            auto value = it->second;
-            set_output("output", std::move(value));
-        } else {
+        auto value = cache.get_or_compute(key, [&] {
             requireInput("input");
-            auto value = get_input("input");
-            cache[key] = value;
-            set_output("output", std::move(value));
-        }
+            return get_input("input");
+        });
+        set_output("output", std::move(value));
     }
 
     virtual void apply() override {}
@@ -4,7 +4,17 @@
 #include <zeno/types/DummyObject.h>
 #include <zeno/extra/ContextManaged.h>
 #include <zeno/extra/evaluate_condition.h>
+#include <zeno/extra/SubnetNode.h>
+#include <zeno/extra/DirtyChecker.h>
+#include <zeno/core/Session.h>
 #include <zeno/utils/safe_at.h>
+#include <zeno/utils/log.h>
+#include <functional>
+#include <string>
+#include <exception>
+#include <vector>
+#include <map>
+#include <set>
 
 namespace zeno {
 
@@ -170,10 +180,255 @@ ZENDEFNODE(BeginForEach, {
     {"control"},
 });
 
+// stands in a parallel loop worker for a node evaluated once before the loop, copies
+// its outputs when an iteration first asks for them, so that iterations modifying
+// their inputs in place don't race on the same object, and then marks itself visited
+// in the worker's base context so that the later iterations of that worker share it
+struct ForEachOuterNode : zeno::INode {
+    INode const *source = nullptr;
+    Context *shared = nullptr;
+
+    static zany copyOf(zany const &obj) {
+        auto copy = obj ? obj->clone() : nullptr;
+        return copy ? copy : obj;  // not clonable, shared as is
+    }
+
+    virtual void apply() override {
+        for (auto const &[key, obj]: source->outputs)
+            outputs[key] = copyOf(obj);
+        muted_output = copyOf(source->muted_output);
+        shared->visited.insert(myname);
+    }
+};
+
 struct EndForEach : EndFor {
     std::vector<zany> result;
     std::vector<zany> dropped_result;
 
+    // collect the loop body (nodes between BeginForEach and us) and the outer
+    // nodes it reads from, fails with the reason in why when the body can't be
+    // copied per worker; outer nodes not visited yet are re-evaluated every
+    // iteration in serial mode, so they are taken into the body as well
+    bool collectBody(std::string const &sn, std::set<std::string> &body, std::set<std::string> &outer, std::string &why) const {
+        std::map<std::string, bool> memo;
+        std::function<bool(std::string const &)> visit = [&] (std::string const &id) {
+            if (id == sn)
+                return true;
+            if (auto it = memo.find(id); it != memo.end())
+                return it->second;
+            memo[id] = false;
+            bool dep = false;
+            for (auto const &[ds, bound]: safe_at(graph->nodes, id, "node name")->inputBounds) {
+                dep = visit(bound.first) || dep;
+            }
+            memo[id] = dep;
+            if (dep)
+                body.insert(id);
+            return dep;
+        };
+        for (auto const &[ds, bound]: inputBounds) {
+            if (ds != "FOR")
+                visit(bound.first);
+        }
+
+        // nested loops started outside still keep per-iteration state, copy them too
+        auto perIteration = [&] (std::string const &id) {
+            return !graph->ctx->isVisited(id) ||
+                dynamic_cast<IBeginFor *>(graph->nodes.at(id).get());
+        };
+        for (auto const &[ds, bound]: inputBounds) {
+            if (ds != "FOR" && bound.first != sn && perIteration(bound.first))
+                body.insert(bound.first);
+        }
+        for (bool grown = true; grown;) {
+            grown = false;
+            for (auto const &id: std::vector<std::string>(body.begin(), body.end())) {
+                for (auto const &[ds, bound]: graph->nodes.at(id)->inputBounds) {
+                    if (bound.first != sn && !body.count(bound.first) && perIteration(bound.first)) {
+                        body.insert(bound.first);
+                        grown = true;
+                    }
+                }
+            }
+        }
+
+        auto const &classes = graph->session->nodeClasses;
+        for (auto const &id: body) {
+            auto node = graph->nodes.at(id).get();
+            if (dynamic_cast<SubnetNode *>(node)) {
+                why = "subnet " + id + " inside";
+                return false;
+            }
+            if (dynamic_cast<BreakFor *>(node)) {
+                why = "BreakFor " + id + " inside";
+                return false;
+            }
+            for (auto name: {"PortalIn", "PortalOut"}) {
+                if (auto it = classes.find(name); it != classes.end() && it->second.get() == node->nodeClass) {
+                    why = std::string(name) + " " + id + " inside";
+                    return false;
+                }
+            }
+            for (auto const &[ds, bound]: node->inputBounds) {
+                if (bound.first != sn && !body.count(bound.first))
+                    outer.insert(bound.first);
+            }
+        }
+        for (auto const &[ds, bound]: inputBounds) {
+            if (ds != "FOR" && bound.first != sn && !body.count(bound.first))
+                outer.insert(bound.first);
+        }
+        return true;
+    }
+
+    // run the iterations concurrently, every worker evaluates them in its own
+    // copy of the loop body, results are gathered back in index order; this
+    // matches serial mode except that objects from outside the loop are copied
+    // once per worker, so in-place changes to them only carry over to the later
+    // iterations run by the same worker; fails with the reason in why when the
+    // loop has to run serially
+    bool parallelApply(std::string &why) {
+        auto [sn, ss] = safe_at(inputBounds, "FOR", "input socket of EndForEach");
+        auto fore = dynamic_cast<BeginForEach *>(graph->nodes.at(sn).get());
+        if (!fore) {
+            why = "FOR is not connected to a BeginForEach";
+            return false;
+        }
+        if (inputBounds.count("accumate")) {
+            why = "accumate is connected";
+            return false;
+        }
+        if (!graph->ctx) {
+            why = "no evaluation context";
+            return false;
+        }
+        graph->applyNode(sn);
+        std::set<std::string> body, outer;
+        if (!collectBody(sn, body, outer, why))
+            return false;
+
+        auto &dc = graph->getDirtyChecker();
+        bool dirty = dc.amIDirty(sn);
+        for (auto const &id: outer) {
+            dirty = graph->applyNode(id) || dirty;
+        }
+        for (auto const &id: body) {
+            dirty = dirty || dc.amIDirty(id);
+        }
+        if (dirty)
+            dc.taintThisNode(myname);
+
+        auto const &arr = fore->m_list->arr;
+        int n = arr.size();
+        bool hasObject = inputBounds.count("object");
+        bool hasList = inputBounds.count("list");
+        bool hasAccept = inputBounds.count("accept");
+        std::vector<zany> objects(n);
+        std::vector<std::vector<zany>> lists(n);
+        std::vector<char> accepts(n, 1);
+        std::vector<std::exception_ptr> errors(n);
+
+        if (n > 0) {
+#pragma omp parallel
+            {
+                auto wg = std::make_shared<Graph>();
+                wg->session = graph->session;
+                Context base;
+                INode *begin = nullptr;
+                int lastIndex = -1;
+                // kept per worker, reported by every iteration it would have run
+                std::exception_ptr setupError;
+                try {
+                    for (auto const &id: outer) {
+                        auto node = std::make_unique<ForEachOuterNode>();
+                        node->graph = wg.get();
+                        node->myname = id;
+                        node->source = graph->nodes.at(id).get();
+                        node->shared = &base;
+                        wg->nodes[id] = std::move(node);
+                    }
+                    {
+                        auto node = std::make_unique<ForEachOuterNode>();
+                        node->graph = wg.get();
+                        node->myname = sn;
+                        node->outputs = fore->outputs;
+                        base.visited.insert(sn);
+                        begin = node.get();
+                        wg->nodes[sn] = std::move(node);
+                    }
+                    for (auto const &id: body) {
+                        auto const &src = graph->nodes.at(id);
+                        auto node = src->nodeClass->new_instance();
+                        node->graph = wg.get();
+                        node->nodeClass = src->nodeClass;
+                        node->myname = id;
+                        node->inputBounds = src->inputBounds;
+                        node->inputs = src->inputs;
+                        node->outputs = src->outputs;
+                        node->kframes = src->kframes;
+                        node->formulas = src->formulas;
+                        node->muted_output = src->muted_output;
+                        wg->nodes[id] = std::move(node);
+                    }
+                } catch (...) {
+                    setupError = std::current_exception();
+                }
+
+#pragma omp for schedule(dynamic)
+                for (int i = 0; i < n; i++) {
+                    if (setupError) {
+                        errors[i] = setupError;
+                        continue;
+                    }
+                    try {
+                        auto index = std::make_shared<NumericObject>();
+                        index->set(i);
+                        begin->outputs["index"] = std::move(index);
+                        begin->outputs["object"] = arr[i];
+                        wg->ctx = std::make_unique<Context>();
+                        wg->ctx->parent = &base;
+                        auto fetch = [&] (std::string const &ds) {
+                            auto const &[bn, bs] = inputBounds.at(ds);
+                            wg->applyNode(bn);
+                            return wg->getNodeOutput(bn, bs);
+                        };
+                        if (hasAccept)
+                            accepts[i] = evaluate_condition(fetch("accept").get());
+                        if (hasObject)
+                            objects[i] = fetch("object");
+                        if (hasList)
+                            lists[i] = safe_dynamic_cast<ListObject>(fetch("list"), "input socket `list` of EndForEach")->arr;
+                    } catch (...) {
+                        errors[i] = std::current_exception();
+                    }
+                    lastIndex = i;
+                }
+
+                // auto-valid the nodes in last iteration when refered from outside
+                if (lastIndex == n - 1 && !errors[n - 1]) {
+                    for (auto const &id: body)
+                        graph->nodes.at(id)->outputs = wg->nodes.at(id)->outputs;
+                }
+                wg->ctx = nullptr;
+            }
+        }
+        for (auto const &e: errors) {
+            if (e)
+                std::rethrow_exception(e);
+        }
+
+        for (auto const &id: body)
+            graph->ctx->visited.insert(id);
+        for (int i = 0; i < n; i++) {
+            auto &dst = accepts[i] ? result : dropped_result;
+            if (hasObject)
+                dst.push_back(std::move(objects[i]));
+            for (auto &obj: lists[i])
+                dst.push_back(std::move(obj));
+        }
+        return true;
+    }
+
     virtual void post_do_apply() override {
         bool accept = true;
         if (requireInput("accept")) {
@@ -210,7 +465,13 @@ struct EndForEach : EndFor {
     }
 
     virtual void preApply() override {
-        EndFor::preApply();
+        bool parallel = get_param<bool>("parallel");
+        std::string why;
+        if (!parallel || !parallelApply(why)) {
+            if (parallel)
+                log_warn("EndForEach {}: loop can't run in parallel ({}), running serially", myname, why);
+            EndFor::preApply();
+        }
         if (get_param<bool>("doConcat")) {
             decltype(result) newres;
             for (auto &xs: result) {
@@ -243,7 +504,7 @@ struct EndForEach : EndFor {
 ZENDEFNODE(EndForEach, {
     {"object", "list", "accumate", {"bool", "accept", "1"}, "FOR"},
     {"list", "droppedList", "accumate"},
-    {{"bool", "doConcat", "0"}},
+    {{"bool", "doConcat", "0"}, {"bool", "parallel", "0"}},
     {"control"},
 });
 
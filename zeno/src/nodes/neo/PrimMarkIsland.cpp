@@ -4,59 +4,102 @@
 #include <zeno/types/StringObject.h>
 #include <zeno/types/NumericObject.h>
 #include <zeno/utils/tuple_hash.h>
+#include <zeno/para/parallel_scan.h>
 #include <unordered_map>
+#include <atomic>
+#include <functional>
 
 namespace zeno {
 
-ZENO_API void primMarkIsland(PrimitiveObject *prim, std::string tagAttr) {
-    // Oh, I mean, Tesla was a great DJ
-    auto &tagVert = prim->add_attr<int>(tagAttr);
-    auto m = tagVert.size();
-    std::vector<int> found(m);
-    for (int i = 0; i < m; i++) {
-        found[i] = i;
-    }
-    auto find = [&] (int i) {
-        while (i != found[i])
-            i = found[i];
-        return i;
-    };
-    for (int i = 0; i < prim->lines.size(); i++) {
-        auto ind = prim->lines[i];
-        int e0 = find(ind[0]);
-        int e1 = find(ind[1]);
-        found[e1] = e0;
-    }
-    for (int i = 0; i < prim->tris.size(); i++) {
-        auto ind = prim->tris[i];
-        int e0 = find(ind[0]);
-        int e1 = find(ind[1]);
-        int e2 = find(ind[2]);
-        found[e1] = e0;
-        found[e2] = e0;
+namespace {
+
+// lock-free union-find that always hooks the larger root under the smaller one, so
+// parents only ever point downwards and every root ends up the smallest vertex of
+// its island, whatever order the threads ran the unions in
+struct ConcurrentUnionFind {
+    std::vector<std::atomic<int>> parent;
+
+    explicit ConcurrentUnionFind(int n) : parent(n) {
+#pragma omp parallel for
+        for (int i = 0; i < n; i++)
+            parent[i].store(i, std::memory_order_relaxed);
     }
-    for (int i = 0; i < prim->quads.size(); i++) {
-        auto ind = prim->quads[i];
-        int e0 = find(ind[0]);
-        int e1 = find(ind[1]);
-        int e2 = find(ind[2]);
-        int e3 = find(ind[3]);
-        found[e1] = e0;
-        found[e2] = e0;
-        found[e3] = e0;
+
+    int find(int i) {
+        while (true) {
+            int p = parent[i].load(std::memory_order_relaxed);
+            if (p == i)
+                return i;
+            int gp = parent[p].load(std::memory_order_relaxed);
+            if (gp != p)  // path halving, only ever moves i to an ancestor
+                parent[i].compare_exchange_weak(p, gp, std::memory_order_relaxed);
+            i = gp;
+        }
     }
-    for (int i = 0; i < prim->polys.size(); i++) {
-        auto [base, len] = prim->polys[i];
-        if (len <= 1) continue;
-        int e0 = find(prim->loops[base]);
-        for (int j = base + 1; j < base + len; j++) {
-            int ej = find(prim->loops[j]);
-            found[ej] = e0;
+
+    void unite(int a, int b) {
+        while (true) {
+            a = find(a);
+            b = find(b);
+            if (a == b)
+                return;
+            if (a < b)
+                std::swap(a, b);
+            int expected = a;
+            if (parent[a].compare_exchange_strong(expected, b, std::memory_order_relaxed))
+                return;
         }
     }
-    for (int i = 0; i < m; i++) {
-        tagVert[i] = find(i);
+};
+
+}
+
+ZENO_API int primIslandLabels(PrimitiveObject const *prim, std::vector<int> &labels) {
+    int n = prim->verts.size();
+    ConcurrentUnionFind uf(n);
+
+    auto uniteFaces = [&] (auto const &faces) {
+        using T = std::decay_t<decltype(faces[0])>;
+        int nfaces = faces.size();
+#pragma omp parallel for
+        for (int i = 0; i < nfaces; i++) {
+            auto const &ind = faces[i];
+            for (int j = 1; j < is_vec_n<T>; j++)
+                uf.unite(ind[0], ind[j]);
+        }
+    };
+    uniteFaces(prim->lines.values);
+    uniteFaces(prim->tris.values);
+    uniteFaces(prim->quads.values);
+    int npolys = prim->polys.size();
+#pragma omp parallel for
+    for (int i = 0; i < npolys; i++) {
+        auto [base, len] = prim->polys[i];
+        for (int j = base + 1; j < base + len; j++)
+            uf.unite(prim->loops[base], prim->loops[j]);
     }
+
+    // roots are the first vertex of each island, numbering them in vertex order
+    // gives compact labels in order of first occurrence
+    labels.resize(n);
+    std::vector<int> rootLabel(n);
+#pragma omp parallel for
+    for (int i = 0; i < n; i++)
+        labels[i] = uf.find(i);
+    int count = parallel_exclusive_scan(0, n, rootLabel.begin(), 0, std::plus<int>(), [&] (int i) {
+        return int(labels[i] == i);
+    });
+#pragma omp parallel for
+    for (int i = 0; i < n; i++)
+        labels[i] = rootLabel[labels[i]];
+    return count;
+}
+
+ZENO_API void primMarkIsland(PrimitiveObject *prim, std::string tagAttr) {
+    // Oh, I mean, Tesla was a great DJ
+    std::vector<int> labels;
+    primIslandLabels(prim, labels);
+    prim->verts.add_attr<int>(tagAttr) = std::move(labels);
 }
 
 namespace {
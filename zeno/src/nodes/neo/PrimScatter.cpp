@@ -5,13 +5,14 @@
 #include <zeno/types/NumericObject.h>
 #include <zeno/para/parallel_for.h>
 #include <zeno/para/parallel_scan.h>
+#include <zeno/para/parallel_reduce.h>
+#include <zeno/para/parallel_sort.h>
 #define ZENO_NOTICKTOCK
 #include <zeno/utils/ticktock.h>
 #include <zeno/utils/variantswitch.h>
 #include <zeno/utils/wangsrng.h>
-#include <zeno/utils/tuple_hash.h>
 #include <zeno/utils/log.h>
-#include <unordered_map>
+#include <algorithm>
 #include <random>
 #include <cmath>
 #ifndef M_PI
@@ -22,57 +23,135 @@ namespace zeno {
 
 template <class T>
 static void revamp_vector(std::vector<T> &arr, std::vector<int> const &revamp) {
-    std::vector<T> newarr(arr.size());
-    for (int i = 0; i < revamp.size(); i++) {
+    std::vector<T> newarr(revamp.size());
+#pragma omp parallel for
+    for (intptr_t i = 0; i < revamp.size(); i++) {
         newarr[i] = arr[revamp[i]];
     }
     std::swap(arr, newarr);
 }
 
-static void primPossionFilter(PrimitiveObject *prim, float minRadius) {
-    if (minRadius <= 0) return;
+// maximal poisson-disk pruning: verts are binned into cells no smaller than the largest
+// radius, so conflicts can only happen between 3x3x3 adjacent cells; cells are split into
+// 27 phases by (x%3, y%3, z%3), cells of one phase are never adjacent and are decided in
+// parallel, each in vertex order, seeing the final state of all earlier phases. the kept
+// set thus only depends on the input, not on the thread count. two verts conflict when
+// closer than the larger of their radii (radius[i] if given, else minRadius)
+static void primPossionFilter(PrimitiveObject *prim, float minRadius, std::vector<float> const &radius) {
+    size_t n = prim->verts.size();
+    bool hasRadius = !radius.empty();
+    float maxRadius = hasRadius ? parallel_reduce_max(radius.begin(), radius.end()) : minRadius;
+    if (maxRadius <= 0 || n == 0) return;
 
     TICK(possion);
-    float invRadius = 1.f / minRadius;
-    std::unordered_map<vec3i, std::vector<int>, tuple_hash, tuple_equal> lut;
-    for (int i = 0; i < prim->verts.size(); i++) {
-        vec3i ipos(prim->verts[i] * invRadius);
-        lut[ipos].push_back(i);
+    vec3f bmin, bmax;
+    std::tie(bmin, bmax) = primBoundingBox(prim);
+    // clamp the cell count to 2^19 per axis so that a cell key fits 57 bits,
+    // larger cells are still correct, just with more verts per cell
+    auto extent = bmax - bmin;
+    float cellSize = std::max(maxRadius, std::max({extent[0], extent[1], extent[2]}) * (1.f / (1 << 19)));
+    float invCell = 1.f / cellSize;
+    vec3i dim = vec3i(extent * invCell) + 1;
+    uint64_t ncells = (uint64_t)dim[0] * dim[1] * dim[2];
+
+    auto cellOf = [&] (vec3f const &pos) {
+        return zeno::min(zeno::max(vec3i((pos - bmin) * invCell), vec3i(0)), dim - 1);
+    };
+    // phase-major, then cell-major key, so each phase is a contiguous run of cells
+    auto keyOf = [&] (vec3i const &c) -> uint64_t {
+        uint64_t phase = c[0] % 3 + c[1] % 3 * 3 + c[2] % 3 * 9;
+        return phase * ncells + ((uint64_t)c[2] * dim[1] + c[1]) * dim[0] + c[0];
+    };
+
+    std::vector<std::pair<uint64_t, int>> order(n);
+#pragma omp parallel for
+    for (intptr_t i = 0; i < n; i++) {
+        order[i] = {keyOf(cellOf(prim->verts[i])), (int)i};
+    }
+    parallel_sort(order.begin(), order.end(), [] (auto const &a, auto const &b) {
+        return a < b;
+    });
+
+    // verts in sorted order for locality, cellStart[k]..cellStart[k+1] are the verts of cellKey[k]
+    std::vector<vec3f> spos(n);
+    std::vector<float> srad(hasRadius ? n : 0);
+#pragma omp parallel for
+    for (intptr_t k = 0; k < n; k++) {
+        spos[k] = prim->verts[order[k].second];
+        if (hasRadius) srad[k] = radius[order[k].second];
+    }
+    std::vector<uint64_t> cellKey;
+    std::vector<size_t> cellStart;
+    size_t phaseStart[28];
+    for (size_t k = 0; k < n; k++) {
+        if (k == 0 || order[k].first != order[k - 1].first) {
+            cellKey.push_back(order[k].first);
+            cellStart.push_back(k);
+        }
+    }
+    cellStart.push_back(n);
+    for (int p = 0; p <= 27; p++) {
+        phaseStart[p] = std::lower_bound(cellKey.begin(), cellKey.end(), p * ncells) - cellKey.begin();
     }
 
-    std::vector<uint8_t> erased(prim->verts.size());
-    for (int i = 0; i < prim->verts.size(); i++) {
-        if (erased[i])
-            continue;
-        vec3i ipos(prim->verts[i] * invRadius);
-        erased[i] = [&] {
+    std::vector<uint8_t> kept(n);
+    for (int p = 0; p < 27; p++) {
+#pragma omp parallel for schedule(dynamic, 64)
+        for (intptr_t c = phaseStart[p]; c < phaseStart[p + 1]; c++) {
+            vec3i cpos = cellOf(spos[cellStart[c]]);
+            size_t nbStart[27], nbEnd[27];
+            int nnb = 0;
             for (int dz = -1; dz <= 1; dz++) {
                 for (int dy = -1; dy <= 1; dy++) {
                     for (int dx = -1; dx <= 1; dx++) {
-                        auto it = lut.find(ipos + vec3i(dx, dy, dz));
-                        if (it != lut.end()) {
-                            for (int j: it->second) {
-                                if (j == i || erased[j])
-                                    continue;
-                                auto dis = prim->verts[i] - prim->verts[j];
-                                if (length(dis) < minRadius)
-                                    return true;
-                            }
-                        }
+                        vec3i npos = cpos + vec3i(dx, dy, dz);
+                        if (npos[0] < 0 || npos[1] < 0 || npos[2] < 0
+                            || npos[0] >= dim[0] || npos[1] >= dim[1] || npos[2] >= dim[2])
+                            continue;
+                        uint64_t nkey = keyOf(npos);
+                        auto it = std::lower_bound(cellKey.begin(), cellKey.end(), nkey);
+                        if (it == cellKey.end() || *it != nkey)
+                            continue;
+                        size_t nc = it - cellKey.begin();
+                        nbStart[nnb] = cellStart[nc];
+                        nbEnd[nnb] = cellStart[nc + 1];
+                        nnb++;
                     }
                 }
             }
-            return false;
-        }();
+            for (size_t k = cellStart[c]; k < cellStart[c + 1]; k++) {
+                float rk = hasRadius ? srad[k] : minRadius;
+                kept[k] = [&] {
+                    for (int b = 0; b < nnb; b++) {
+                        for (size_t j = nbStart[b]; j < nbEnd[b]; j++) {
+                            if (!kept[j])
+                                continue;
+                            float r = hasRadius ? std::max(rk, srad[j]) : rk;
+                            if (lengthSquared(spos[k] - spos[j]) < r * r)
+                                return false;
+                        }
+                    }
+                    return true;
+                }();
+            }
+        }
     }
 
-    std::vector<int> revamp(prim->verts.size());
-    int nrevamp = 0;
-    for (int i = 0; i < erased.size(); i++) {
-        if (!erased[i])
-            revamp[nrevamp++] = i;
+    std::vector<uint8_t> keep(n);
+#pragma omp parallel for
+    for (intptr_t k = 0; k < n; k++) {
+        keep[order[k].second] = kept[k];
+    }
+    std::vector<int> scanned(n);
+    size_t nrevamp = parallel_exclusive_scan_sum(keep.begin(), keep.end(), scanned.begin(), [] (uint8_t k) {
+        return (int)k;
+    });
+    std::vector<int> revamp(nrevamp);
+#pragma omp parallel for
+    for (intptr_t i = 0; i < n; i++) {
+        if (keep[i])
+            revamp[scanned[i]] = i;
     }
-    revamp.resize(nrevamp);
 
     prim->verts.forall_attr([&] (auto const &key, auto &arr) {
         revamp_vector(arr, revamp);
@@ -82,7 +161,7 @@ static void primPossionFilter(PrimitiveObject *prim, float minRadius) {
 }
 
 ZENO_API std::shared_ptr<PrimitiveObject> primScatter(
-    PrimitiveObject *prim, std::string type, std::string denAttr, float density, float minRadius, bool interpAttrs, int seed) {
+    PrimitiveObject *prim, std::string type, std::string denAttr, float density, float minRadius, bool interpAttrs, int seed, std::string radAttr) {
     auto retprim = std::make_shared<PrimitiveObject>();
 
     if (seed == -1) seed = std::random_device{}();
@@ -134,6 +213,11 @@ ZENO_API std::shared_ptr<PrimitiveObject> primScatter(
 
     retprim->verts.resize(npoints);
 
+    // per-point poisson radius, minRadius scaled by the interpolated radAttr
+    bool hasRadAttr = !radAttr.empty() && minRadius > 0;
+    std::vector<float> radius(hasRadAttr ? npoints : 0);
+    auto *radArr = hasRadAttr ? &prim->verts.attr<float>(radAttr) : nullptr;
+
     if (!prim->verts.num_attrs()) {
         interpAttrs = false;
     }
@@ -162,6 +246,10 @@ ZENO_API std::shared_ptr<PrimitiveObject> primScatter(
             auto w3 = r1 * r2;
             auto p = w1 * a + w2 * b + w3 * c;
             retprim->verts[i] = p;
+            if (hasRadAttr) {
+                auto &rad = *radArr;
+                radius[i] = minRadius * (w1 * rad[ind[0]] + w2 * rad[ind[1]] + w3 * rad[ind[2]]);
+            }
             if (interpAttrs) {
                 prim->verts.foreach_attr([&] (auto const &key, auto const &arr) {
                     using T = std::decay_t<decltype(arr[0])>;
@@ -187,6 +275,10 @@ ZENO_API std::shared_ptr<PrimitiveObject> primScatter(
             auto r1 = rng.next_float();
             auto p = a * (1 - r1) + b * r1;
             retprim->verts[i] = p;
+            if (hasRadAttr) {
+                auto &rad = *radArr;
+                radius[i] = minRadius * (rad[ind[0]] * (1 - r1) + rad[ind[1]] * r1);
+            }
             if (interpAttrs) {
                 prim->verts.foreach_attr([&] (auto const &key, auto const &arr) {
                     using T = std::decay_t<decltype(arr[0])>;
@@ -201,7 +293,7 @@ ZENO_API std::shared_ptr<PrimitiveObject> primScatter(
     }
 
     TOCK(scatter);
-    primPossionFilter(retprim.get(), minRadius);
+    primPossionFilter(retprim.get(), minRadius, radius);
 
     return retprim;
 }
@@ -217,7 +309,8 @@ struct PrimScatter : INode {
         auto minRadius = get_input2<float>("minRadius");
         auto interpAttrs = get_input2<bool>("interpAttrs");
         auto seed = get_input2<int>("seed");
-        auto retprim = primScatter(prim.get(), type, denAttr, density, minRadius, interpAttrs, seed);
+        auto radAttr = get_input2<std::string>("radAttr");
+        auto retprim = primScatter(prim.get(), type, denAttr, density, minRadius, interpAttrs, seed, radAttr);
         set_output("parsPrim", retprim);
     }
 };
@@ -229,6 +322,7 @@ ZENO_DEFNODE(PrimScatter)({
         {"string", "denAttr", ""},
         {"float", "density", "100"},
         {"float", "minRadius", "0"},
+        {"string", "radAttr", ""},
         {"bool", "interpAttrs", "1"},
         {"int", "seed", "-1"},
     },
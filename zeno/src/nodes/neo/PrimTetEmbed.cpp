@@ -0,0 +1,242 @@
+#include <zeno/zeno.h>
+#include <zeno/types/PrimitiveObject.h>
+#include <zeno/funcs/PrimitiveUtils.h>
+#include <zeno/para/parallel_scan.h>
+#include <zeno/utils/vec.h>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+namespace zeno {
+
+namespace {
+
+// uniform grid over the tets' bounding boxes, each cell lists (in ascending order)
+// the tets whose box overlaps it
+struct TetGrid {
+    vec3d origin;
+    double cellSize = 1;
+    vec3i res{1, 1, 1};
+    std::vector<int> cellStart;     // res[0] * res[1] * res[2] + 1
+    std::vector<int> cellTets;
+
+    vec3i cellOf(vec3d const &p) const {
+        vec3i c;
+        for (int d = 0; d < 3; d++)
+            c[d] = std::clamp((int)std::floor((p[d] - origin[d]) / cellSize), 0, res[d] - 1);
+        return c;
+    }
+
+    int linear(vec3i const &c) const {
+        return (c[2] * res[1] + c[1]) * res[0] + c[0];
+    }
+};
+
+struct TetMesh {
+    std::vector<vec3d> pos;
+    std::vector<vec4i> tets;
+
+    // barycentric weights of p in tet, false for a degenerate tet
+    bool barycentric(int tet, vec3d const &p, vec4d &w) const {
+        auto [i0, i1, i2, i3] = tets[tet];
+        vec3d e1 = pos[i1] - pos[i0], e2 = pos[i2] - pos[i0], e3 = pos[i3] - pos[i0], r = p - pos[i0];
+        double det = dot(e1, cross(e2, e3));
+        if (det == 0)
+            return false;
+        double w1 = dot(r, cross(e2, e3)) / det;
+        double w2 = dot(e1, cross(r, e3)) / det;
+        double w3 = dot(e1, cross(e2, r)) / det;
+        w = {1 - w1 - w2 - w3, w1, w2, w3};
+        return true;
+    }
+};
+
+vec3d closestPointOnTriangle(vec3d const &p, vec3d const &a, vec3d const &b, vec3d const &c) {
+    vec3d ab = b - a, ac = c - a, ap = p - a;
+    double d1 = dot(ab, ap), d2 = dot(ac, ap);
+    if (d1 <= 0 && d2 <= 0) return a;
+    vec3d bp = p - b;
+    double d3 = dot(ab, bp), d4 = dot(ac, bp);
+    if (d3 >= 0 && d4 <= d3) return b;
+    double vc = d1 * d4 - d3 * d2;
+    if (vc <= 0 && d1 >= 0 && d3 <= 0) return a + ab * (d1 / (d1 - d3));
+    vec3d cp = p - c;
+    double d5 = dot(ab, cp), d6 = dot(ac, cp);
+    if (d6 >= 0 && d5 <= d6) return c;
+    double vb = d5 * d2 - d1 * d6;
+    if (vb <= 0 && d2 >= 0 && d6 <= 0) return a + ac * (d2 / (d2 - d6));
+    double va = d3 * d6 - d5 * d4;
+    if (va <= 0 && d4 - d3 >= 0 && d5 - d6 >= 0) return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+    double denom = 1 / (va + vb + vc);
+    return a + ab * (vb * denom) + ac * (vc * denom);
+}
+
+double boxDistance(vec3d const &p, vec3d const &bmin, vec3d const &bmax) {
+    return length(zeno::max(zeno::max(bmin - p, p - bmax), vec3d(0)));
+}
+
+TetGrid buildTetGrid(TetMesh const &mesh) {
+    TetGrid grid;
+    std::size_t ntets = mesh.tets.size();
+    std::vector<vec3d> bmin(ntets), bmax(ntets);
+    double extentSum = 0;
+    vec3d gmin(std::numeric_limits<double>::max()), gmax(std::numeric_limits<double>::lowest());
+#pragma omp parallel
+    {
+        vec3d lmin(std::numeric_limits<double>::max()), lmax(std::numeric_limits<double>::lowest());
+#pragma omp for reduction(+: extentSum)
+        for (intptr_t t = 0; t < (intptr_t)ntets; t++) {
+            vec3d mi = mesh.pos[mesh.tets[t][0]], ma = mi;
+            for (int k = 1; k < 4; k++) {
+                mi = zeno::min(mi, mesh.pos[mesh.tets[t][k]]);
+                ma = zeno::max(ma, mesh.pos[mesh.tets[t][k]]);
+            }
+            bmin[t] = mi;
+            bmax[t] = ma;
+            extentSum += std::max({ma[0] - mi[0], ma[1] - mi[1], ma[2] - mi[2]});
+            lmin = zeno::min(lmin, mi);
+            lmax = zeno::max(lmax, ma);
+        }
+#pragma omp critical
+        {
+            gmin = zeno::min(gmin, lmin);
+            gmax = zeno::max(gmax, lmax);
+        }
+    }
+
+    // cells about as large as a tet, but never many more cells than tets
+    vec3d extent = zeno::max(gmax - gmin, vec3d(1e-12));
+    double cellSize = std::max(extentSum / ntets, 1e-12);
+    double maxCells = 4.0 * ntets + 64;
+    if (double n = extent[0] / cellSize * extent[1] / cellSize * extent[2] / cellSize; n > maxCells)
+        cellSize *= std::cbrt(n / maxCells);
+    grid.origin = gmin;
+    grid.cellSize = cellSize;
+    for (int d = 0; d < 3; d++)
+        grid.res[d] = std::max(1, (int)std::ceil(extent[d] / cellSize));
+
+    // (cell, tet) pairs in tet order, then counting sort by cell keeps each list ascending
+    std::vector<int> pairOffset(ntets + 1);
+    std::vector<vec3i> clo(ntets), chi(ntets);
+#pragma omp parallel for
+    for (intptr_t t = 0; t < (intptr_t)ntets; t++) {
+        clo[t] = grid.cellOf(bmin[t]);
+        chi[t] = grid.cellOf(bmax[t]);
+        vec3i n = chi[t] - clo[t] + 1;
+        pairOffset[t] = n[0] * n[1] * n[2];
+    }
+    parallel_exclusive_scan_sum(pairOffset.begin(), pairOffset.end(), pairOffset.begin(), [] (int n) { return n; });
+    std::vector<int> pairCell(pairOffset[ntets]);
+#pragma omp parallel for
+    for (intptr_t t = 0; t < (intptr_t)ntets; t++) {
+        int k = pairOffset[t];
+        for (int z = clo[t][2]; z <= chi[t][2]; z++)
+            for (int y = clo[t][1]; y <= chi[t][1]; y++)
+                for (int x = clo[t][0]; x <= chi[t][0]; x++)
+                    pairCell[k++] = grid.linear({x, y, z});
+    }
+
+    std::size_t ncells = (std::size_t)grid.res[0] * grid.res[1] * grid.res[2];
+    grid.cellStart.assign(ncells + 1, 0);
+    for (int c: pairCell)
+        grid.cellStart[c + 1]++;
+    for (std::size_t c = 0; c < ncells; c++)
+        grid.cellStart[c + 1] += grid.cellStart[c];
+    grid.cellTets.resize(pairCell.size());
+    std::vector<int> fill(grid.cellStart.begin(), grid.cellStart.end() - 1);
+    for (std::size_t t = 0; t < ntets; t++)
+        for (int k = pairOffset[t]; k < pairOffset[t + 1]; k++)
+            grid.cellTets[fill[pairCell[k]]++] = (int)t;
+    return grid;
+}
+
+// nearest tet by exact point-tet distance, searching rings of cells outwards until no
+// farther ring can hold anything closer
+int nearestTet(TetMesh const &mesh, TetGrid const &grid, vec3d const &p, vec4d &weights) {
+    vec3i c0 = grid.cellOf(p);
+    int maxRing = std::max({grid.res[0], grid.res[1], grid.res[2]});
+    double bestDist = std::numeric_limits<double>::max();
+    int best = -1;
+    for (int r = 0; r <= maxRing; r++) {
+        vec3i lo = c0 - r, hi = c0 + r;
+        for (int z = std::max(lo[2], 0); z <= std::min(hi[2], grid.res[2] - 1); z++)
+            for (int y = std::max(lo[1], 0); y <= std::min(hi[1], grid.res[1] - 1); y++)
+                for (int x = std::max(lo[0], 0); x <= std::min(hi[0], grid.res[0] - 1); x++) {
+                    if (std::max({std::abs(x - c0[0]), std::abs(y - c0[1]), std::abs(z - c0[2])}) != r)
+                        continue;
+                    vec3d cmin = grid.origin + vec3d(x, y, z) * grid.cellSize;
+                    if (boxDistance(p, cmin, cmin + grid.cellSize) > bestDist)
+                        continue;
+                    int c = grid.linear({x, y, z});
+                    for (int k = grid.cellStart[c]; k < grid.cellStart[c + 1]; k++) {
+                        int t = grid.cellTets[k];
+                        auto [i0, i1, i2, i3] = mesh.tets[t];
+                        auto const &v0 = mesh.pos[i0], &v1 = mesh.pos[i1], &v2 = mesh.pos[i2], &v3 = mesh.pos[i3];
+                        if (boxDistance(p, zeno::min(zeno::min(v0, v1), zeno::min(v2, v3)), zeno::max(zeno::max(v0, v1), zeno::max(v2, v3))) > bestDist)
+                            continue;
+                        vec4d w;
+                        if (!mesh.barycentric(t, p, w))
+                            continue;
+                        double dist = 0;
+                        if (w[0] < 0 || w[1] < 0 || w[2] < 0 || w[3] < 0) {
+                            dist = std::min({
+                                length(closestPointOnTriangle(p, v1, v2, v3) - p),
+                                length(closestPointOnTriangle(p, v0, v2, v3) - p),
+                                length(closestPointOnTriangle(p, v0, v1, v3) - p),
+                                length(closestPointOnTriangle(p, v0, v1, v2) - p),
+                            });
+                        }
+                        if (dist < bestDist || (dist == bestDist && t < best)) {
+                            bestDist = dist;
+                            best = t;
+                            weights = w;
+                        }
+                    }
+                }
+        if (best != -1 && bestDist <= r * grid.cellSize)
+            break;
+    }
+    return best;
+}
+
+}
+
+ZENO_API void primTetEmbed(PrimitiveObject const *tetPrim, std::vector<vec3f> const &points,
+                           std::vector<int> &tetIds, std::vector<vec4f> &weights, bool fitting) {
+    tetIds.assign(points.size(), -1);
+    weights.assign(points.size(), vec4f(0));
+    if (!tetPrim->quads.size())
+        return;
+
+    TetMesh mesh;
+    mesh.pos.resize(tetPrim->verts.size());
+    for (std::size_t i = 0; i < mesh.pos.size(); i++)
+        mesh.pos[i] = tetPrim->verts[i];
+    mesh.tets.assign(tetPrim->quads.begin(), tetPrim->quads.end());
+    TetGrid grid = buildTetGrid(mesh);
+
+#pragma omp parallel for schedule(dynamic, 256)
+    for (intptr_t i = 0; i < (intptr_t)points.size(); i++) {
+        vec3d p = points[i];
+        int c = grid.linear(grid.cellOf(p));
+        vec4d w;
+        // the lowest containing tet wins, points on shared faces are owned deterministically
+        for (int k = grid.cellStart[c]; k < grid.cellStart[c + 1]; k++) {
+            int t = grid.cellTets[k];
+            if (mesh.barycentric(t, p, w) && w[0] >= 0 && w[1] >= 0 && w[2] >= 0 && w[3] >= 0) {
+                tetIds[i] = t;
+                weights[i] = w;
+                break;
+            }
+        }
+        if (tetIds[i] != -1 || !fitting)
+            continue;
+        if (int t = nearestTet(mesh, grid, p, w); t != -1) {
+            w = zeno::max(w, vec4d(0));
+            tetIds[i] = t;
+            weights[i] = w / (w[0] + w[1] + w[2] + w[3]);
+        }
+    }
+}
+
+}
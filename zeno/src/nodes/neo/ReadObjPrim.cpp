@@ -4,6 +4,7 @@
 #include <zeno/types/StringObject.h>
 #include <zeno/utils/string.h>
 #include <zeno/utils/fileio.h>
+#include <zeno/utils/mapped_file.h>
 #include <zeno/utils/logger.h>
 #include <zeno/utils/vec.h>
 #include <string_view>
@@ -12,7 +13,8 @@
 #include <cstdlib>
 #include <cassert>
 #include <cstdio>
-#include <fstream>
+#include <charconv>
+#include <vector>
 
 namespace zeno {
 namespace {
@@ -28,94 +30,190 @@ static bool match_helper(char const *&it, char const *arr, std::index_sequence<I
 }
 
 template <std::size_t N>
-static bool match(char const *&it, char const (&arr)[N]) {
+static bool match(char const *&it, char const *nit, char const (&arr)[N]) {
+    if (nit - it < (std::ptrdiff_t)(N - 1))
+        return false;
     return match_helper(it, arr, std::make_index_sequence<N - 1>{});
 }
 
-static float takef(char const *&it) {
-    char *eptr;
-    float val = std::strtof(it, &eptr);
-    it = eptr;
-    return val;
+static bool is_blank(char c) {
+    return c == ' ' || c == '\t';
 }
 
-static int takeu(char const *&it) {
-    char *eptr;
-    int val(std::strtoul(it, &eptr, 10));
-    it = eptr;
-    return val;
+static void skip_blank(char const *&it, char const *eit) {
+    while (it != eit && is_blank(*it))
+        ++it;
 }
 
-// std::shared_ptr<PrimitiveObject> parse_obj(std::vector<char> &&bin) 
-PrimitiveObject* parse_obj(const char *binData, std::size_t binSize) {
-    /*bin.resize(bin.size() + 8, '\0');*/
+// std::from_chars is locale-independent and does not allocate, unlike strtof
+static float takef(char const *&it, char const *eit) {
+    skip_blank(it, eit);
+    if (it != eit && *it == '+')
+        ++it;
+    float val = 0;
+    auto [ptr, ec] = std::from_chars(it, eit, val);
+    if (ec != std::errc{}) {
+        while (it != eit && !is_blank(*it))
+            ++it;
+        return 0;
+    }
+    it = ptr;
+    return val;
+}
 
-    char const *it = binData;
-    char const *eit = binData + binSize;// - 8;
+static int takei(char const *&it, char const *eit) {
+    int val = 0;
+    auto [ptr, ec] = std::from_chars(it, eit, val);
+    it = ptr;
+    return val;
+}
 
-    // auto prim = std::make_shared<PrimitiveObject>();
-    auto prim = new PrimitiveObject;
-    std::vector<int> loop_uvs;
+// obj indices are 1-based, negative ones are relative to the elements seen so far
+static int fixup_index(int i, int count) {
+    return i < 0 ? count + i : i - 1;
+}
 
+template <class F>
+static void foreach_line(char const *it, char const *eit, F const &f) {
     while (it < eit) {
-        auto nit = std::find(it, eit, '\n');
-        auto nnit = nit + 1;
-        if (nit[-1] == '\r')
+        auto nnit = std::find(it, eit, '\n');
+        auto nit = nnit;
+        if (nit != it && nit[-1] == '\r')
             --nit;
+        f(it, nit);
+        it = nnit + 1;
+    }
+}
+
+template <class F>
+static void foreach_token(char const *it, char const *nit, F const &f) {
+    skip_blank(it, nit);
+    while (it != nit) {
+        auto tit = std::find_if(it, nit, is_blank);
+        f(it, tit);
+        it = tit;
+        skip_blank(it, nit);
+    }
+}
+
+struct ObjChunkCount {
+    int verts = 0;
+    int uvs = 0;
+    int polys = 0;
+    int loops = 0;
+    int loop_uvs = 0;
+    int lines = 0;
+};
 
-        if (match(it, "v ")) {
-            float x = takef(it);
-            float y = takef(it);
-            float z = takef(it);
-            prim->verts.emplace_back(x, y, z);
-
-        } else if (match(it, "vt ")) {
-            float x = takef(it);
-            float y = takef(it);
-            prim->uvs.emplace_back(x, y);
-
-        } else if (match(it, "f ")) {
-            int beg = prim->loops.size();
-            int cnt{};
-            while (it != nit) {
-                int x = takeu(it) - 1;
-                if (*it == '/' && it[1] != '/') {
-                    ++it;
-                    int xt = takeu(it) - 1;
-                    loop_uvs.push_back(xt);
+static void count_obj_chunk(char const *it, char const *eit, ObjChunkCount &cnt) {
+    foreach_line(it, eit, [&] (char const *it, char const *nit) {
+        if (match(it, nit, "v ")) {
+            cnt.verts++;
+        } else if (match(it, nit, "vt ")) {
+            cnt.uvs++;
+        } else if (match(it, nit, "f ")) {
+            cnt.polys++;
+            foreach_token(it, nit, [&] (char const *tit, char const *teit) {
+                cnt.loops++;
+                auto sit = std::find(tit, teit, '/');
+                if (sit != teit && sit + 1 != teit && sit[1] != '/')
+                    cnt.loop_uvs++;
+            });
+        } else if (match(it, nit, "l ")) {
+            cnt.lines++;
+        }
+    });
+}
+
+static void parse_obj_chunk(char const *it, char const *eit, PrimitiveObject *prim,
+                            ObjChunkCount const &base, int *loop_uvs) {
+    ObjChunkCount cur = base;
+    foreach_line(it, eit, [&] (char const *it, char const *nit) {
+        if (match(it, nit, "v ")) {
+            float x = takef(it, nit);
+            float y = takef(it, nit);
+            float z = takef(it, nit);
+            prim->verts[cur.verts++] = {x, y, z};
+
+        } else if (match(it, nit, "vt ")) {
+            float x = takef(it, nit);
+            float y = takef(it, nit);
+            prim->uvs[cur.uvs++] = {x, y};
+
+        } else if (match(it, nit, "f ")) {
+            int beg = cur.loops;
+            foreach_token(it, nit, [&] (char const *tit, char const *teit) {
+                int x = takei(tit, teit);
+                if (tit != teit && *tit == '/' && tit + 1 != teit && tit[1] != '/') {
+                    ++tit;
+                    int xt = takei(tit, teit);
+                    loop_uvs[cur.loop_uvs++] = fixup_index(xt, cur.uvs);
                 }
-                it = std::find(it, nit, ' ');
-                prim->loops.push_back(x);
-                ++cnt;
-                it = std::find_if(it, nit, [] (char c) { return c != ' '; });
-            }
-            prim->polys.emplace_back(beg, cnt);
-
-        } else if (match(it, "l ")) {
-            int x = takeu(it) - 1;
-            int y = takeu(it) - 1;
-            prim->lines.emplace_back(x, y);
+                prim->loops[cur.loops++] = fixup_index(x, cur.verts);
+            });
+            prim->polys[cur.polys++] = {beg, cur.loops - beg};
+
+        } else if (match(it, nit, "l ")) {
+            skip_blank(it, nit);
+            int x = takei(it, nit);
+            skip_blank(it, nit);
+            int y = takei(it, nit);
+            prim->lines[cur.lines++] = {fixup_index(x, cur.verts), fixup_index(y, cur.verts)};
 
         //} else if (match(it, "o ")) {
             // todo: support tag verts to be multi components of primitive
             //std::string_view o_name(it, nit - it);
 
         }
-        it = nnit;
+    });
+}
+
+// the input is cut into line-aligned chunks which are first counted, then
+// parsed in parallel straight into exactly sized arrays at their prefix offsets
+PrimitiveObject* parse_obj(const char *binData, std::size_t binSize) {
+    auto prim = new PrimitiveObject;
+    if (binSize == 0)
+        return prim;
+
+    char const *eit = binData + binSize;
+    constexpr std::size_t kChunkSize = 4 << 20;
+    std::vector<char const *> bounds{binData};
+    while (eit - bounds.back() > kChunkSize) {
+        auto cut = std::find(bounds.back() + kChunkSize, eit, '\n');
+        if (cut == eit)
+            break;
+        bounds.push_back(cut + 1);
     }
+    bounds.push_back(eit);
+    int nchunks = bounds.size() - 1;
 
-    {
-        int vert_count = prim->verts.size();
-        for (auto &i : prim->loops) {
-            if (i < 0) {
-                i += vert_count + 1;
-            }
-        }
-        for (auto &i : loop_uvs) {
-            if (i < 0) {
-                i += vert_count + 1;
-            }
-        }
+    std::vector<ObjChunkCount> counts(nchunks + 1);
+#pragma omp parallel for schedule(dynamic)
+    for (int c = 0; c < nchunks; c++) {
+        count_obj_chunk(bounds[c], bounds[c + 1], counts[c + 1]);
+    }
+    for (int c = 0; c < nchunks; c++) {
+        auto &next = counts[c + 1];
+        auto const &prev = counts[c];
+        next.verts += prev.verts;
+        next.uvs += prev.uvs;
+        next.polys += prev.polys;
+        next.loops += prev.loops;
+        next.loop_uvs += prev.loop_uvs;
+        next.lines += prev.lines;
+    }
+
+    auto const &total = counts.back();
+    prim->verts.resize(total.verts);
+    prim->uvs.resize(total.uvs);
+    prim->polys.resize(total.polys);
+    prim->loops.resize(total.loops);
+    prim->lines.resize(total.lines);
+    std::vector<int> loop_uvs(total.loop_uvs);
+
+#pragma omp parallel for schedule(dynamic)
+    for (int c = 0; c < nchunks; c++) {
+        parse_obj_chunk(bounds[c], bounds[c + 1], prim, counts[c], loop_uvs.data());
     }
 
     if (loop_uvs.size() == prim->loops.size()) {
@@ -128,12 +226,8 @@ PrimitiveObject* parse_obj(const char *binData, std::size_t binSize) {
 struct ReadObjPrim : INode {
     virtual void apply() override {
         auto path = get_input2<std::string>("path");
-        std::string native_path = std::filesystem::u8path(path).string();
-        std::ifstream file(native_path, std::ios::binary);
-        auto binary = std::vector<char>((std::istreambuf_iterator<char>(file)),
-                              std::istreambuf_iterator<char>());
-        // auto prim = parse_obj(std::move(binary));
-        auto prim = std::shared_ptr<PrimitiveObject>(parse_obj(binary.data(), binary.size()));
+        mapped_file file(path);
+        auto prim = std::shared_ptr<PrimitiveObject>(parse_obj(file.data(), file.size()));
         if (get_param<bool>("triangulate")) {
             primTriangulate(prim.get());
         }
@@ -155,12 +249,12 @@ ZENDEFNODE(ReadObjPrim,
 struct MustReadObjPrim : INode {
     virtual void apply() override {
         auto path = get_input2<std::string>("path");
-        auto binary = file_get_binary<std::vector<char>>(path);
-        if (binary.empty()) {
+        mapped_file file(path);
+        if (file.empty()) {
             auto s = zeno::format("can not find {}", path);
             throw zeno::makeError(s);
         }
-        auto prim = std::shared_ptr<PrimitiveObject>(parse_obj(binary.data(), binary.size()));
+        auto prim = std::shared_ptr<PrimitiveObject>(parse_obj(file.data(), file.size()));
         if (get_param<bool>("triangulate")) {
             primTriangulate(prim.get());
         }
@@ -0,0 +1,180 @@
+#include <zeno/zeno.h>
+#include <zeno/types/SkinBindingObject.h>
+#include <zeno/utils/format.h>
+#include <zeno/utils/vec.h>
+#include <algorithm>
+#include <utility>
+#include <tuple>
+#include <cmath>
+
+namespace zeno {
+
+namespace {
+
+// rotation (x, y, z, w) of the orthonormalized 3x3 block and translation of a bone,
+// as the real and dual parts of a unit dual quaternion
+std::pair<vec4f, vec4f> boneDualQuat(SkinBindingObject::Matrix const &m) {
+    float r[3][3];
+    for (int c = 0; c < 3; c++) {
+        float len = std::sqrt(m[0][c] * m[0][c] + m[1][c] * m[1][c] + m[2][c] * m[2][c]);
+        float inv = len > 0 ? 1 / len : 0;
+        for (int k = 0; k < 3; k++)
+            r[k][c] = m[k][c] * inv;
+    }
+    vec4f q;
+    float tr = r[0][0] + r[1][1] + r[2][2];
+    if (tr > 0) {
+        float s = std::sqrt(tr + 1) * 2;
+        q = {(r[2][1] - r[1][2]) / s, (r[0][2] - r[2][0]) / s, (r[1][0] - r[0][1]) / s, s / 4};
+    } else if (r[0][0] > r[1][1] && r[0][0] > r[2][2]) {
+        float s = std::sqrt(1 + r[0][0] - r[1][1] - r[2][2]) * 2;
+        q = {s / 4, (r[0][1] + r[1][0]) / s, (r[0][2] + r[2][0]) / s, (r[2][1] - r[1][2]) / s};
+    } else if (r[1][1] > r[2][2]) {
+        float s = std::sqrt(1 + r[1][1] - r[0][0] - r[2][2]) * 2;
+        q = {(r[0][1] + r[1][0]) / s, s / 4, (r[1][2] + r[2][1]) / s, (r[0][2] - r[2][0]) / s};
+    } else {
+        float s = std::sqrt(1 + r[2][2] - r[0][0] - r[1][1]) * 2;
+        q = {(r[0][2] + r[2][0]) / s, (r[1][2] + r[2][1]) / s, s / 4, (r[1][0] - r[0][1]) / s};
+    }
+    q = normalize(q);
+    vec3f v{q[0], q[1], q[2]}, t{m[0][3], m[1][3], m[2][3]};
+    vec3f de = (t * q[3] + cross(t, v)) * 0.5f;
+    return {q, {de[0], de[1], de[2], -0.5f * dot(t, v)}};
+}
+
+}
+
+ZENO_API std::shared_ptr<SkinBindingObject> skinBind(std::vector<int> const &offsets,
+                                                     std::vector<int> const &joints,
+                                                     std::vector<float> const &weights,
+                                                     int maxInfluences) {
+    auto binding = std::make_shared<SkinBindingObject>();
+    std::size_t nverts = offsets.empty() ? 0 : offsets.size() - 1;
+
+    auto influences = [&] (std::size_t i, std::vector<std::pair<float, int>> &infl) {
+        infl.clear();
+        for (int k = offsets[i]; k < offsets[i + 1]; k++) {
+            if (weights[k] > 0 && joints[k] >= 0)
+                infl.emplace_back(weights[k], joints[k]);
+        }
+        // heaviest first, ties by joint so that the packing is deterministic
+        std::sort(infl.begin(), infl.end(), [] (auto const &a, auto const &b) {
+            return a.first != b.first ? a.first > b.first : a.second < b.second;
+        });
+        if (maxInfluences > 0 && infl.size() > (std::size_t)maxInfluences)
+            infl.resize(maxInfluences);
+    };
+
+    int width = 0, numJoints = 0;
+#pragma omp parallel
+    {
+        std::vector<std::pair<float, int>> infl;
+#pragma omp for reduction(max: width, numJoints)
+        for (intptr_t i = 0; i < (intptr_t)nverts; i++) {
+            influences(i, infl);
+            width = std::max(width, (int)infl.size());
+            for (auto const &[w, j]: infl)
+                numJoints = std::max(numJoints, j + 1);
+        }
+    }
+    binding->width = width;
+    binding->numJoints = numJoints;
+    binding->joints.assign(nverts * width, 0);
+    binding->weights.assign(nverts * width, 0.f);
+
+#pragma omp parallel
+    {
+        std::vector<std::pair<float, int>> infl;
+#pragma omp for
+        for (intptr_t i = 0; i < (intptr_t)nverts; i++) {
+            influences(i, infl);
+            float sum = 0;
+            for (auto const &[w, j]: infl)
+                sum += w;
+            for (std::size_t k = 0; k < infl.size(); k++) {
+                binding->joints[i * width + k] = infl[k].second;
+                binding->weights[i * width + k] = infl[k].first / sum;
+            }
+        }
+    }
+    return binding;
+}
+
+ZENO_API void skinDeform(SkinBindingObject const &binding,
+                         std::vector<SkinBindingObject::Matrix> const &bones,
+                         bool dualQuat, vec3f *pos, vec3f *nrm) {
+    if (bones.size() < (std::size_t)binding.numJoints)
+        throw makeError(format("skinDeform: binding refers to {} joints, only {} bones given",
+                               binding.numJoints, bones.size()));
+    int width = binding.width;
+    std::size_t nverts = binding.size();
+    int const *joints = binding.joints.data();
+    float const *weights = binding.weights.data();
+
+    if (!dualQuat) {
+#pragma omp parallel for
+        for (intptr_t i = 0; i < (intptr_t)nverts; i++) {
+            if (weights[i * width] <= 0)
+                continue;
+            // blend the 3x4 matrices, a fixed stride of 12 floats the compiler can vectorize
+            float m[12] = {};
+            for (int k = 0; k < width; k++) {
+                float w = weights[i * width + k];
+                auto const &b = bones[joints[i * width + k]];
+                for (int r = 0; r < 3; r++)
+                    for (int c = 0; c < 4; c++)
+                        m[r * 4 + c] += w * b[r][c];
+            }
+            vec3f p = pos[i];
+            pos[i] = {m[0] * p[0] + m[1] * p[1] + m[2] * p[2] + m[3],
+                      m[4] * p[0] + m[5] * p[1] + m[6] * p[2] + m[7],
+                      m[8] * p[0] + m[9] * p[1] + m[10] * p[2] + m[11]};
+            if (nrm) {
+                // inverse transpose up to scale, through the cofactors of the columns
+                vec3f c0{m[0], m[4], m[8]}, c1{m[1], m[5], m[9]}, c2{m[2], m[6], m[10]};
+                vec3f x = cross(c1, c2), y = cross(c2, c0), z = cross(c0, c1);
+                vec3f n = x * nrm[i][0] + y * nrm[i][1] + z * nrm[i][2];
+                if (dot(c0, x) < 0)
+                    n = -n;
+                float len = length(n);
+                if (len > 0)
+                    nrm[i] = n / len;
+            }
+        }
+        return;
+    }
+
+    std::vector<vec4f> real(binding.numJoints), dual(binding.numJoints);
+    for (int j = 0; j < binding.numJoints; j++)
+        std::tie(real[j], dual[j]) = boneDualQuat(bones[j]);
+
+#pragma omp parallel for
+    for (intptr_t i = 0; i < (intptr_t)nverts; i++) {
+        if (weights[i * width] <= 0)
+            continue;
+        // quaternions of the other bones are taken on the hemisphere of the heaviest one
+        vec4f pivot = real[joints[i * width]];
+        vec4f b0(0), be(0);
+        for (int k = 0; k < width; k++) {
+            int j = joints[i * width + k];
+            float w = weights[i * width + k];
+            if (dot(real[j], pivot) < 0)
+                w = -w;
+            b0 += real[j] * w;
+            be += dual[j] * w;
+        }
+        float inv = 1 / length(b0);
+        b0 *= inv;
+        be *= inv;
+        vec3f d0{b0[0], b0[1], b0[2]}, de{be[0], be[1], be[2]};
+        float a0 = b0[3], ae = be[3];
+        vec3f p = pos[i];
+        pos[i] = p + 2.f * cross(d0, cross(d0, p) + a0 * p) + 2.f * (a0 * de - ae * d0 + cross(d0, de));
+        if (nrm) {
+            vec3f n = nrm[i];
+            nrm[i] = n + 2.f * cross(d0, cross(d0, n) + a0 * n);
+        }
+    }
+}
+
+}
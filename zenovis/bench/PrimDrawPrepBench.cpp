@@ -0,0 +1,62 @@
+// headless timing of the viewport mesh preparation, no GL context needed,
+// usage: zeno_primdrawprep_bench [grid resolution] [mesh count]
+#include <zenovis/bate/PrimDrawPrep.h>
+#include <zeno/types/PrimitiveObject.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+static std::shared_ptr<zeno::PrimitiveObject> makeGrid(int res) {
+    auto prim = std::make_shared<zeno::PrimitiveObject>();
+    prim->resize((size_t)res * res);
+    auto &pos = prim->attr<zeno::vec3f>("pos");
+    for (int y = 0; y < res; y++) {
+        for (int x = 0; x < res; x++) {
+            pos[y * res + x] = zeno::vec3f(x, 0.01f * ((x * 7 + y * 13) % 17), y);
+        }
+    }
+    prim->tris.resize((size_t)(res - 1) * (res - 1) * 2);
+    auto &uv0 = prim->tris.add_attr<zeno::vec3f>("uv0");
+    auto &uv1 = prim->tris.add_attr<zeno::vec3f>("uv1");
+    auto &uv2 = prim->tris.add_attr<zeno::vec3f>("uv2");
+    float inv = 1.0f / (res - 1);
+    for (int y = 0; y < res - 1; y++) {
+        for (int x = 0; x < res - 1; x++) {
+            size_t t = ((size_t)y * (res - 1) + x) * 2;
+            int v = y * res + x;
+            prim->tris[t] = zeno::vec3i(v, v + 1, v + res + 1);
+            prim->tris[t + 1] = zeno::vec3i(v, v + res + 1, v + res);
+            zeno::vec3f a(x * inv, y * inv, 0), b((x + 1) * inv, y * inv, 0);
+            zeno::vec3f c((x + 1) * inv, (y + 1) * inv, 0), d(x * inv, (y + 1) * inv, 0);
+            uv0[t] = a, uv1[t] = b, uv2[t] = c;
+            uv0[t + 1] = a, uv1[t + 1] = c, uv2[t + 1] = d;
+        }
+    }
+    return prim;
+}
+
+int main(int argc, char **argv) {
+    int res = argc > 1 ? std::atoi(argv[1]) : 512;
+    int meshes = argc > 2 ? std::atoi(argv[2]) : 32;
+    auto prim = makeGrid(res);
+    printf("meshes: %d x %zu verts, %zu tris\n", meshes, prim->verts.size(), prim->tris.size());
+
+    // unbounded, so that the second pass hits every mesh; the viewport cache is capped
+    zenovis::PrimDrawCache cache(std::size_t(-1), [](zenovis::PrimDrawData const &data) { return data.bytes(); });
+
+    for (int pass = 0; pass < 2; pass++) {
+        size_t bytes = 0;
+        auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < meshes; i++) {
+            // the key stands in for a view key, the second pass finds them all cached
+            auto key = "mesh" + std::to_string(i) + ":0:0";
+            auto data = cache.get_or_compute(key, [&] { return zenovis::preparePrimDraw(prim.get()); });
+            bytes += data->bytes();
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        printf("%s: %.3f ms, %.1f MiB prepared\n", pass ? "cached" : "prepare",
+               std::chrono::duration<double, std::milli>(t1 - t0).count(), bytes / 1048576.0);
+    }
+    return 0;
+}
@@ -5,12 +5,27 @@
 #include <zeno/utils/PolymorphicMap.h>
 #include <zeno/utils/disable_copy.h>
 #include <zeno/core/IObject.h>
+#include <unordered_map>
+#include <cstdint>
 #include <string>
+#include <vector>
 #include <memory>
 #include <map>
 
 namespace zenovis {
 
+// view object keys look like "<node><postfix>:<frameid|static>:<sessionid>", the
+// leading part names a slot, the trailing stamp changes whenever its content does
+struct ObjectsDelta {
+    std::vector<std::string> added;    // keys of slots that were not shown before
+    std::vector<std::string> changed;  // keys that replaced an older stamp of the same slot
+    std::vector<std::string> removed;  // keys no longer shown, older stamps of changed slots included
+
+    bool empty() const {
+        return added.empty() && changed.empty() && removed.empty();
+    }
+};
+
 struct ObjectsManager : zeno::disable_copy {
     zeno::MapStablizer<zeno::PolymorphicMap<std::map<
         std::string, std::shared_ptr<zeno::IObject>>>> objects;
@@ -18,6 +33,8 @@ struct ObjectsManager : zeno::disable_copy {
     std::map<std::string, std::shared_ptr<zeno::IObject>> lightObjects;
     bool needUpdateLight = true;
 
+    ObjectsDelta delta;  // what the last load_objects or clear_objects did
+
     template <class T = void>
     auto pairs() const {
         return objects.pairs<T>();
@@ -34,6 +51,30 @@ struct ObjectsManager : zeno::disable_copy {
     bool load_objects(std::map<std::string, std::shared_ptr<zeno::IObject>> const &objs);
 
     std::optional<zeno::IObject*> get(std::string nid);
+    std::uint64_t version(std::string const &key) const;
+
+    // bumped by every load_objects and clear_objects: a renderer that last synced at
+    // epoch() - 1 only has to apply delta, otherwise it has missed some and must
+    // compare against all the objects
+    std::size_t epoch() const {
+        return m_epoch;
+    }
+
+private:
+    struct Entry {
+        zeno::IObject *ptr{};
+        std::string slot;
+        std::size_t epoch{};
+    };
+
+    struct Slot {
+        std::string key;
+        std::uint64_t version{};
+    };
+
+    std::unordered_map<std::string, Entry> m_index;
+    std::unordered_map<std::string, Slot> m_slots;
+    std::size_t m_epoch{};
 };
 
 }
@@ -46,7 +46,7 @@ struct GraphicsManager {
             if (load_realtime_object(key, obj)) continue;
             if (ins.may_emplace(key)) {
                 zeno::log_debug("load_object: loading graphics [{}]", key);
-                auto ig = makeGraphic(scene, obj.get());
+                auto ig = makeGraphic(scene, obj.get(), key);
                 zeno::log_debug("load_object: loaded graphics to {}", ig.get());
                 ig->nameid = key;
                 ig->objholder = obj;
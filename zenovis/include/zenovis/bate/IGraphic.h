@@ -2,6 +2,7 @@
 
 #include <memory>
 #include <optional>
+#include <string>
 #include <vector>
 #include <zeno/core/IObject.h>
 #include <zeno/types/IObjectXMacro.h>
@@ -71,6 +72,7 @@ struct IPicker : IGraphicDraw {
 
 struct MakeGraphicVisitor {
     Scene *in_scene{};
+    std::string in_key;  // view object key, empty if the content may change under it
     std::unique_ptr<IGraphic> out_result;
 
 #define _ZENO_PER_XMACRO(TypeName, ...) \
@@ -79,7 +81,7 @@ ZENO_XMACRO_IObject(_ZENO_PER_XMACRO)
 #undef _ZENO_PER_XMACRO
 };
 
-std::unique_ptr<IGraphic> makeGraphic(Scene *scene, zeno::IObject *obj);
+std::unique_ptr<IGraphic> makeGraphic(Scene *scene, zeno::IObject *obj, std::string const &key = {});
 std::unique_ptr<IGraphicDraw> makeGraphicAxis(Scene *scene);
 std::unique_ptr<IGraphicDraw> makeGraphicGrid(Scene *scene);
 std::unique_ptr<IGraphicDraw> makeGraphicSelectBox(Scene *scene);
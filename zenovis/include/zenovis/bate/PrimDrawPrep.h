@@ -0,0 +1,50 @@
+#pragma once
+
+#include <zeno/types/PrimitiveObject.h>
+#include <zeno/utils/concurrent_cache.h>
+#include <zeno/utils/vec.h>
+#include <string>
+#include <vector>
+#include <memory>
+
+namespace zenovis {
+
+// CPU half of turning a primitive into draw buffers; makes no GL calls, so it can be
+// cached across loads and benchmarked headless
+struct PrimDrawData {
+    // the buffers drawn from the normalized primitive (pos/clr/nrm/uv/tang present,
+    // quads and polys triangulated), moved out of the working copy, none of its
+    // other attributes are kept
+    std::vector<zeno::vec3f> pos, clr, nrm, uv, tang;
+    std::vector<int> points;
+    std::vector<zeno::vec2i> lines;
+    std::vector<zeno::vec3i> tris;
+    bool is_image = false;
+    bool invisible = false;
+    bool custom_color = false;
+
+    // wireframe edges (vertex id pairs) of non-triangle polygons, and of their uvs
+    std::vector<int> polyEdges;
+    std::vector<int> polyUvEdges;
+    std::vector<zeno::vec3f> polyUvs;
+
+    // unwelded lines/tris carrying per-corner uvs, each vertex interleaved
+    // as kVertexStride vec3f: pos, clr, nrm, uv, tang
+    static constexpr int kVertexStride = 5;
+    std::vector<zeno::vec3f> lineVerts;
+    std::vector<zeno::vec2i> lineIndices;
+    std::vector<zeno::vec3f> triVerts;
+    std::vector<zeno::vec3i> triIndices;
+
+    std::size_t bytes() const;
+};
+
+std::shared_ptr<PrimDrawData const> preparePrimDraw(zeno::PrimitiveObject const *prim);
+
+// prepared data keyed by view object key, whose frame/session stamp changes with the
+// content, so scrubbing back to a loaded frame skips the preparation; LRU by bytes()
+using PrimDrawCache = zeno::ConcurrentCache<std::string, PrimDrawData const>;
+
+PrimDrawCache &getPrimDrawCache();
+
+} // namespace zenovis
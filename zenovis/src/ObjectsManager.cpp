@@ -10,48 +10,89 @@ namespace zenovis {
 ObjectsManager::ObjectsManager() = default;
 ObjectsManager::~ObjectsManager() = default;
 
+static std::string slot_of(std::string const &key) {
+    auto sess = key.rfind(':');
+    if (sess == std::string::npos || sess == 0)
+        return key;
+    auto stamp = key.rfind(':', sess - 1);
+    if (stamp == std::string::npos)
+        return key;
+    return key.substr(0, stamp);
+}
+
+static bool is_light_object(zeno::IObject *obj) {
+    if (auto prim_in = dynamic_cast<zeno::PrimitiveObject *>(obj)) {
+        return prim_in->userData().get2<int>("isRealTimeObject", 0);
+    }
+    return false;
+}
+
 bool ObjectsManager::load_objects(std::map<std::string, std::shared_ptr<zeno::IObject>> const &objs) {
-    bool inserted = false;
+    delta = {};
+    auto epoch = ++m_epoch;
     auto ins = objects.insertPass();
 
-    bool changed_light = false;
     for (auto const &[key, obj] : objs) {
-        if (ins.may_emplace(key)) {
-            changed_light = true;
+        if (auto it = m_index.find(key); it != m_index.end()) {
+            it->second.epoch = epoch;
+            ins.may_emplace(key);
+            continue;
         }
+        auto slot = slot_of(key);
+        auto &s = m_slots[slot];
+        if (s.version) {
+            // the old stamp of this slot is swept below, but its light must go now
+            lightObjects.erase(s.key);
+            delta.changed.push_back(key);
+        } else {
+            delta.added.push_back(key);
+        }
+        s.key = key;
+        s.version++;
+        if (is_light_object(obj.get())) {
+            lightObjects[key] = obj;
+        }
+        m_index.insert_or_assign(key, Entry{obj.get(), std::move(slot), epoch});
+        ins.try_emplace(key, obj);
     }
-    if(changed_light){
-        lightObjects.clear();
-    }
-    for (auto const &[key, obj] : objs) {
-        if (ins.may_emplace(key)) {
-            if (auto prim_in = dynamic_cast<zeno::PrimitiveObject *>(obj.get())) {
-                auto isRealTimeObject = prim_in->userData().get2<int>("isRealTimeObject", 0);
-                if(isRealTimeObject){
-                    //printf("loading light object %s\n", key.c_str());
-                    lightObjects[key] = obj;
-                }
-            }
-            ins.try_emplace(key, std::move(obj));
-            inserted = true;
+
+    for (auto it = m_index.begin(); it != m_index.end();) {
+        if (it->second.epoch == epoch) {
+            ++it;
+            continue;
         }
+        lightObjects.erase(it->first);
+        if (auto sit = m_slots.find(it->second.slot); sit != m_slots.end() && sit->second.key == it->first)
+            m_slots.erase(sit);
+        delta.removed.push_back(it->first);
+        it = m_index.erase(it);
     }
-    return inserted;
+
+    return !delta.added.empty() || !delta.changed.empty();
 }
 
 void ObjectsManager::clear_objects() {
+    delta = {};
+    ++m_epoch;
+    for (auto const &[key, entry] : m_index)
+        delta.removed.push_back(key);
     objects.clear();
+    lightObjects.clear();
+    m_index.clear();
+    m_slots.clear();
 }
 
 std::optional<zeno::IObject* > ObjectsManager::get(std::string nid) {
-    for (auto &[key, ptr]: this->pairs()) {
-        if (key != nid) {
-            continue;
-        }
-        return ptr;
-    }
-
+    if (auto it = m_index.find(nid); it != m_index.end())
+        return it->second.ptr;
     return std::nullopt;
 }
 
+std::uint64_t ObjectsManager::version(std::string const &key) const {
+    if (auto it = m_index.find(key); it != m_index.end())
+        if (auto sit = m_slots.find(it->second.slot); sit != m_slots.end())
+            return sit->second.version;
+    return 0;
+}
+
 }
@@ -31,9 +31,10 @@ int IGraphicHandler::handleHover(glm::vec3 ori, glm::vec3 dir)
     return hover_mode;
 }
 
-std::unique_ptr<IGraphic> makeGraphic(Scene *scene, zeno::IObject *obj) {
+std::unique_ptr<IGraphic> makeGraphic(Scene *scene, zeno::IObject *obj, std::string const &key) {
     MakeGraphicVisitor visitor;
     visitor.in_scene = scene;
+    visitor.in_key = key;
 
     if (0) {
 #define _ZENO_PER_XMACRO(TypeName, ...) \
@@ -0,0 +1,264 @@
+#include <zenovis/bate/PrimDrawPrep.h>
+#include <zeno/types/PrimitiveTools.h>
+#include <zeno/types/UserData.h>
+#include <zeno/extra/TempNode.h>
+#include <zeno/utils/logger.h>
+#include <algorithm>
+#include <numeric>
+
+namespace zenovis {
+
+namespace {
+
+constexpr std::size_t kPrimDrawCacheBytes = std::size_t(512) << 20;
+
+// emits the outline of every polygon with more than three corners, as id pairs
+// looked up through idOf(loop index); offsets are prefix-summed so polys fill in parallel
+template <class IdOf>
+std::vector<int> polyOutlines(zeno::PrimitiveObject const *prim, IdOf const &idOf) {
+    auto const &polys = prim->polys;
+    std::vector<std::size_t> offsets(polys.size() + 1, 0);
+    for (std::size_t p = 0; p < polys.size(); p++) {
+        int c = polys[p][1];
+        offsets[p + 1] = offsets[p] + (c > 2 ? 2 * c : 0);
+    }
+    std::vector<int> edges(offsets.back());
+#pragma omp parallel for
+    for (std::intptr_t p = 0; p < (std::intptr_t)polys.size(); p++) {
+        auto [b, c] = polys[p];
+        auto *out = edges.data() + offsets[p];
+        auto add_edge = [&](int a, int b) {
+            *out++ = idOf(a);
+            *out++ = idOf(b);
+        };
+        for (auto i = 2; i < c; i++) {
+            if (i == 2) {
+                add_edge(b, b + 1);
+            }
+            add_edge(b + i - 1, b + i);
+            if (i == c - 1) {
+                add_edge(b, b + i);
+            }
+        }
+    }
+    return edges;
+}
+
+void flattenLines(zeno::PrimitiveObject *prim, PrimDrawData &data) {
+    constexpr int S = PrimDrawData::kVertexStride;
+    auto const &pos = prim->attr<zeno::vec3f>("pos");
+    auto const &clr = prim->attr<zeno::vec3f>("clr");
+    auto const &nrm = prim->attr<zeno::vec3f>("nrm");
+    auto const &tang = prim->attr<zeno::vec3f>("tang");
+    auto const &lines = prim->lines;
+    auto const &uv0 = lines.attr<zeno::vec3f>("uv0");
+    auto const &uv1 = lines.attr<zeno::vec3f>("uv1");
+    std::intptr_t count = lines.size();
+
+    data.lineVerts.resize(count * 2 * S);
+    data.lineIndices.resize(count);
+#pragma omp parallel for
+    for (std::intptr_t i = 0; i < count; i++) {
+        zeno::vec3f const *uvs[2] = {&uv0[i], &uv1[i]};
+        for (int k = 0; k < 2; k++) {
+            auto v = lines[i][k];
+            auto *out = data.lineVerts.data() + (i * 2 + k) * S;
+            out[0] = pos[v];
+            out[1] = clr[v];
+            out[2] = nrm[v];
+            out[3] = *uvs[k];
+            out[4] = tang[v];
+        }
+        data.lineIndices[i] = zeno::vec2i(i * 2, i * 2 + 1);
+    }
+}
+
+// computes the per-triangle tangent into tris.attr("tang") in the same pass
+void flattenTriangles(zeno::PrimitiveObject *prim, PrimDrawData &data) {
+    constexpr int S = PrimDrawData::kVertexStride;
+    auto const &pos = prim->attr<zeno::vec3f>("pos");
+    auto const &clr = prim->attr<zeno::vec3f>("clr");
+    auto const &nrm = prim->attr<zeno::vec3f>("nrm");
+    auto const &tris = prim->tris;
+    auto &tang = prim->tris.add_attr<zeno::vec3f>("tang");
+    auto const &uv0 = tris.attr<zeno::vec3f>("uv0");
+    auto const &uv1 = tris.attr<zeno::vec3f>("uv1");
+    auto const &uv2 = tris.attr<zeno::vec3f>("uv2");
+    std::intptr_t count = tris.size();
+
+    data.triVerts.resize(count * 3 * S);
+    data.triIndices.resize(count);
+#pragma omp parallel for
+    for (std::intptr_t i = 0; i < count; i++) {
+        auto const &pos0 = pos[tris[i][0]];
+        auto const &pos1 = pos[tris[i][1]];
+        auto const &pos2 = pos[tris[i][2]];
+
+        auto edge0 = pos1 - pos0;
+        auto edge1 = pos2 - pos0;
+        auto deltaUV0 = uv1[i] - uv0[i];
+        auto deltaUV1 = uv2[i] - uv0[i];
+
+        auto f = 1.0f / (deltaUV0[0] * deltaUV1[1] -
+                         deltaUV1[0] * deltaUV0[1] + 1e-5);
+
+        zeno::vec3f tangent;
+        tangent[0] = f * (deltaUV1[1] * edge0[0] - deltaUV0[1] * edge1[0]);
+        tangent[1] = f * (deltaUV1[1] * edge0[1] - deltaUV0[1] * edge1[1]);
+        tangent[2] = f * (deltaUV1[1] * edge0[2] - deltaUV0[1] * edge1[2]);
+        tang[i] = tangent;
+
+        zeno::vec3f const *uvs[3] = {&uv0[i], &uv1[i], &uv2[i]};
+        for (int k = 0; k < 3; k++) {
+            auto v = tris[i][k];
+            auto *out = data.triVerts.data() + (i * 3 + k) * S;
+            out[0] = pos[v];
+            out[1] = clr[v];
+            out[2] = nrm[v];
+            out[3] = *uvs[k];
+            out[4] = tangent;
+        }
+        data.triIndices[i] = zeno::vec3i(i * 3, i * 3 + 1, i * 3 + 2);
+    }
+}
+
+template <class Func>
+void fillVec3Attr(zeno::PrimitiveObject *prim, const char *name, Func const &func) {
+    auto &attr = prim->add_attr<zeno::vec3f>(name);
+#pragma omp parallel for
+    for (std::intptr_t i = 0; i < (std::intptr_t)attr.size(); i++) {
+        attr[i] = func(i);
+    }
+}
+
+}
+
+std::size_t PrimDrawData::bytes() const {
+    auto vecBytes = [](auto const &v) { return v.size() * sizeof(v[0]); };
+    std::size_t n = sizeof(*this);
+    n += vecBytes(pos) + vecBytes(clr) + vecBytes(nrm) + vecBytes(uv) + vecBytes(tang);
+    n += vecBytes(points) + vecBytes(lines) + vecBytes(tris);
+    n += vecBytes(polyEdges) + vecBytes(polyUvEdges) + vecBytes(polyUvs);
+    n += vecBytes(lineVerts) + vecBytes(lineIndices) + vecBytes(triVerts) + vecBytes(triIndices);
+    return n;
+}
+
+std::shared_ptr<PrimDrawData const> preparePrimDraw(zeno::PrimitiveObject const *primArg) {
+    auto data = std::make_shared<PrimDrawData>();
+    // normalized in a working copy, which is dropped once its buffers are moved out
+    auto work = std::make_shared<zeno::PrimitiveObject>(*primArg);
+    auto *prim = work.get();
+    data->invisible = prim->userData().get2<bool>("invisible", 0);
+    zeno::log_trace("preparing primitive size {}", prim->size());
+
+    bool any_not_triangle = std::any_of(prim->polys.begin(), prim->polys.end(),
+                                        [](auto const &poly) { return poly[1] > 3; });
+    if (any_not_triangle) {
+        auto const &loops = prim->loops;
+        data->polyEdges = polyOutlines(prim, [&](int l) { return loops[l]; });
+        if (prim->loops.attr_is<int>("uvs")) {
+            auto const &uvs = prim->loops.attr<int>("uvs");
+            data->polyUvEdges = polyOutlines(prim, [&](int l) { return uvs[l]; });
+            data->polyUvs.resize(prim->uvs.size());
+#pragma omp parallel for
+            for (std::intptr_t i = 0; i < (std::intptr_t)prim->uvs.size(); i++) {
+                data->polyUvs[i] = zeno::vec3f(prim->uvs[i][0], prim->uvs[i][1], 0);
+            }
+        }
+    }
+
+    if (!prim->attr_is<zeno::vec3f>("pos")) {
+        float step = 1.0f / (prim->size() - 1);
+        fillVec3Attr(prim, "pos", [&](std::intptr_t i) { return zeno::vec3f(i * step, 0, 0); });
+    }
+    data->custom_color = prim->attr_is<zeno::vec3f>("clr");
+    if (!prim->attr_is<zeno::vec3f>("clr")) {
+        zeno::vec3f clr0(1.0f);
+        if (!prim->tris.size() && !prim->quads.size() && !prim->polys.size()) {
+            if (prim->lines.size())
+                clr0 = {1.0f, 0.6f, 0.2f};
+            else
+                clr0 = {0.2f, 0.6f, 1.0f};
+        }
+        auto &clr = prim->add_attr<zeno::vec3f>("clr");
+        std::fill(clr.begin(), clr.end(), clr0);
+    }
+
+    bool primNormalCorrect =
+        prim->attr_is<zeno::vec3f>("nrm") &&
+        (!prim->attr<zeno::vec3f>("nrm").size() ||
+         length(prim->attr<zeno::vec3f>("nrm")[0]) > 1e-5);
+    bool need_computeNormal =
+        !primNormalCorrect || !(prim->attr_is<zeno::vec3f>("nrm"));
+    bool thePrmHasFaces = !(!prim->tris.size() && !prim->quads.size() && !prim->polys.size());
+    if (thePrmHasFaces && need_computeNormal) {
+        zeno::log_trace("computing normal");
+        zeno::primCalcNormal(prim, 1);
+    }
+    if (int subdlevs = prim->userData().get2<int>("delayedSubdivLevels", 0)) {
+        // todo: zhxx, should comp normal after subd or before?
+        zeno::log_trace("computing subdiv {}", subdlevs);
+        (void)zeno::TempNodeSimpleCaller("OSDPrimSubdiv")
+            .set("prim", work)
+            .set2<int>("levels", subdlevs)
+            .set2<std::string>("edgeCreaseAttr", "")
+            .set2<bool>("triangulate", false)
+            .set2<bool>("asQuadFaces", true)
+            .set2<bool>("hasLoopUVs", true)
+            .set2<bool>("delayTillIpc", false)
+            .call();  // will inplace subdiv prim
+        prim->userData().del("delayedSubdivLevels");
+    }
+    if (thePrmHasFaces) {
+        zeno::log_trace("demoting faces");
+        zeno::primTriangulateQuads(prim);
+        zeno::primTriangulate(prim);//will further loop.attr("uv") to tris.attr("uv0")...
+    }
+
+    // point clouds pack radius and opacity into the normal slot
+    if (!thePrmHasFaces) {
+        auto const *rad = prim->attr_is<float>("rad") ? prim->attr<float>("rad").data() : nullptr;
+        auto const *opa = prim->attr_is<float>("opa") ? prim->attr<float>("opa").data() : nullptr;
+        fillVec3Attr(prim, "nrm", [&](std::intptr_t i) {
+            return zeno::vec3f(rad ? rad[i] : 1.0f, opa ? opa[i] : 0.0f, 0.0f);
+        });
+    }
+    if (!prim->attr_is<zeno::vec3f>("nrm")) {
+        auto &nrm = prim->add_attr<zeno::vec3f>("nrm");
+        std::fill(nrm.begin(), nrm.end(), zeno::vec3f(1.0f, 0.0f, 0.0f));
+    }
+    if (!prim->attr_is<zeno::vec3f>("uv")) {
+        auto &uv = prim->add_attr<zeno::vec3f>("uv");
+        std::fill(uv.begin(), uv.end(), zeno::vec3f(0.0f));
+    }
+    if (!prim->attr_is<zeno::vec3f>("tang")) {
+        auto &tang = prim->add_attr<zeno::vec3f>("tang");
+        std::fill(tang.begin(), tang.end(), zeno::vec3f(0.0f));
+    }
+
+    if (prim->lines.size() && prim->lines.has_attr("uv0") && prim->lines.has_attr("uv1")) {
+        flattenLines(prim, *data);
+    }
+    if (prim->tris.size() && prim->tris.has_attr("uv0") && prim->tris.has_attr("uv1") &&
+        prim->tris.has_attr("uv2")) {
+        flattenTriangles(prim, *data);
+    }
+
+    data->pos = std::move(prim->attr<zeno::vec3f>("pos"));
+    data->clr = std::move(prim->attr<zeno::vec3f>("clr"));
+    data->nrm = std::move(prim->attr<zeno::vec3f>("nrm"));
+    data->uv = std::move(prim->attr<zeno::vec3f>("uv"));
+    data->tang = std::move(prim->attr<zeno::vec3f>("tang"));
+    data->points = std::move(prim->points.values);
+    data->lines = std::move(prim->lines.values);
+    data->tris = std::move(prim->tris.values);
+    data->is_image = prim->userData().get2<int>("isImage", 0);
+    return data;
+}
+
+PrimDrawCache &getPrimDrawCache() {
+    static PrimDrawCache cache(kPrimDrawCacheBytes, [](PrimDrawData const &data) { return data.bytes(); });
+    return cache;
+}
+
+} // namespace zenovis
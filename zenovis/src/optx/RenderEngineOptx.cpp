@@ -504,7 +504,6 @@ struct GraphicsManager {
     };
 
     zeno::MapStablizer<std::map<std::string, std::unique_ptr<ZxxGraphic>>> graphics;
-    std::map<std::string, int> objOrder;
 
     explicit GraphicsManager(Scene *scene) : scene(scene) {
     }
@@ -707,30 +706,6 @@ struct GraphicsManager {
         return sky_found;
     }
 
-    bool need_update_light(std::vector<std::pair<std::string, zeno::IObject *>> const &objs) {
-        auto ins = graphics.insertPass();
-
-        bool changelight = false;
-        for (auto const &[key, obj] : objs) {
-            if(ins.may_emplace(key)) {
-                changelight = true;
-            }
-        }
-        {   //when turn off last node in always mode
-            static int objsNum = 0;
-            if (objsNum > objs.size() && !changelight)
-                changelight = true;
-            objsNum = objs.size();
-            if (scene->drawOptions->updateMatlOnly)
-                changelight = false;
-        }
-
-        auto &ud = zeno::getSession().userData();
-        bool show_background = ud.get2<bool>("optix_show_background", false);
-        xinxinoptix::show_background(show_background);
-
-        return changelight;
-    }
     bool load_light_objects(std::map<std::string, std::shared_ptr<zeno::IObject>> objs){
         xinxinoptix::unload_light();
         bool sky_found = false;
@@ -761,86 +736,88 @@ struct GraphicsManager {
         return true;
     }
 
-    bool load_static_objects(std::vector<std::pair<std::string, zeno::IObject *>> const &objs) {
-        auto ins = graphics.insertPass();
+    // graphics changes of one update, as flags for the parts of the scene they touch
+    struct SyncResult {
+        bool light = false;
+        bool statics = false;
+        bool meshes = false;
+    };
 
-        bool changed = false;
+    std::size_t syncedEpoch = 0;  // ObjectsManager::epoch() the graphics last matched
 
+    // what turns the graphics into the current objects, for when some deltas were missed
+    zenovis::ObjectsDelta diff_objects(std::vector<std::pair<std::string, zeno::IObject *>> const &objs) const {
+        zenovis::ObjectsDelta delta;
+        auto git = graphics.begin();
         for (auto const &[key, obj] : objs) {
-            if (ins.may_emplace(key) && key.find(":static:")!=key.npos) {
-                zeno::log_info("load_static_object: loading graphics [{}]", key);
-                changed = true;
-
-                if (auto cam = dynamic_cast<zeno::CameraObject *>(obj))
-                {
-                    scene->camera->setCamera(cam->get());     // pyb fix
-                    auto &ud = cam->userData();
-                    if (ud.has("aces")) {
-                        scene->camera->setPhysicalCamera(
-                            ud.get2<float>("aperture"),
-                            ud.get2<float>("shutter_speed"),
-                            ud.get2<float>("iso"),
-                            ud.get2<bool>("aces"),
-                            ud.get2<bool>("exposure")
-                        );
-                    }
-                }
-
-                auto ig = std::make_unique<ZxxGraphic>(key, obj);
+            for (; git != graphics.end() && git->first < key; ++git)
+                delta.removed.push_back(git->first);
+            if (git != graphics.end() && git->first == key)
+                ++git;
+            else
+                delta.added.push_back(key);
+        }
+        for (; git != graphics.end(); ++git)
+            delta.removed.push_back(git->first);
+        return delta;
+    }
 
-                zeno::log_info("load_static_object: loaded graphics to {}", ig.get());
-                ins.try_emplace(key, std::move(ig));
+    void load_object(std::string const &key, zeno::IObject *obj, bool setCamera) {
+        if (auto cam = setCamera ? dynamic_cast<zeno::CameraObject *>(obj) : nullptr) {
+            scene->camera->setCamera(cam->get());     // pyb fix
+            auto &ud = cam->userData();
+            if (ud.has("aces")) {
+                scene->camera->setPhysicalCamera(
+                    ud.get2<float>("aperture"),
+                    ud.get2<float>("shutter_speed"),
+                    ud.get2<float>("iso"),
+                    ud.get2<bool>("aces"),
+                    ud.get2<bool>("exposure")
+                );
             }
         }
-        // return ins.has_changed();
-        return changed;
+        auto ig = std::make_unique<ZxxGraphic>(key, obj);
+        zeno::log_info("load_object: loaded graphics [{}] to {}", key, ig.get());
+        graphics.try_emplace(key, std::move(ig));
     }
-    bool load_objects(std::vector<std::pair<std::string, zeno::IObject *>> const &objs) {
-        auto ins = graphics.insertPass();
-        objOrder.clear();
-        bool changed = false;
-        size_t idx = 0;
-        for (auto const &[key, obj] : objs) {
-            objOrder[key] = idx;
-            idx++;
+
+    // brings the graphics up to date with the objects manager, only touching the keys
+    // of its delta when the last sync was one epoch ago
+    SyncResult sync_objects(ObjectsManager &objsMan) {
+        SyncResult res;
+        auto epoch = objsMan.epoch();
+        if (epoch == syncedEpoch)
+            return res;
+        zenovis::ObjectsDelta diff;
+        if (epoch != syncedEpoch + 1)
+            diff = diff_objects(objsMan.pairs());
+        auto const &delta = epoch == syncedEpoch + 1 ? objsMan.delta : diff;
+        syncedEpoch = epoch;
+
+        for (auto const &key : delta.removed) {
+            if (graphics.erase(key))
+                res.light = res.meshes = true;
         }
-        for (auto const &[key, obj] : objs) {
-            //auto ikey = key + ':' + std::string(std::to_string(idx));
-            if (ins.may_emplace(key) && key.find(":static:")==key.npos) {
-
-                zeno::log_info("load_object: loading graphics [{}]", key);
-                changed = true;
-
-                if (!scene->drawOptions->updateMatlOnly) {
-                    if (auto cam = dynamic_cast<zeno::CameraObject *>(obj)) {
-                        scene->camera->setCamera(cam->get()); // pyb fix
-                        auto &ud = cam->userData();
-                        if (ud.has("aces")) {
-                            scene->camera->setPhysicalCamera(
-                                ud.get2<float>("aperture"),
-                                ud.get2<float>("shutter_speed"),
-                                ud.get2<float>("iso"),
-                                ud.get2<bool>("aces"),
-                                ud.get2<bool>("exposure")
-                            );
-                        }
-                    }
+        // statics first, and the later ones may override their camera
+        for (int pass = 0; pass < 2; pass++) {
+            for (auto const *keys : {&delta.added, &delta.changed}) {
+                for (auto const &key : *keys) {
+                    bool isStatic = key.find(":static:") != key.npos;
+                    if (isStatic != (pass == 0) || graphics.find(key) != graphics.end())
+                        continue;
+                    auto obj = objsMan.get(key);
+                    if (!obj)
+                        continue;
+                    res.light = true;
+                    (isStatic ? res.statics : res.meshes) = true;
+                    // no camera moves when only the materials are updated
+                    load_object(key, *obj, isStatic || !scene->drawOptions->updateMatlOnly);
                 }
-
-                auto ig = std::make_unique<ZxxGraphic>(key, obj);
-
-                zeno::log_info("load_object: loaded graphics to {}", ig.get());
-                ins.try_emplace(key, std::move(ig));
             }
         }
-        {   //when turn off last node in always mode
-            static int objsNum = 0;
-            if (objsNum > objs.size() && !changed)
-                changed = true;
-            objsNum = objs.size();
-        }
-        // return ins.has_changed();
-        return changed;
+        if (scene->drawOptions->updateMatlOnly)
+            res.light = false;
+        return res;
     }
 };
 
@@ -882,9 +859,11 @@ struct RenderEngineOptx : RenderEngine, zeno::disable_copy {
     }
 
     void update() override {
+        auto &ud = zeno::getSession().userData();
+        xinxinoptix::show_background(ud.get2<bool>("optix_show_background", false));
 
-        if(graphicsMan->need_update_light(scene->objectsMan->pairs())
-            || scene->objectsMan->needUpdateLight)
+        auto changes = graphicsMan->sync_objects(*scene->objectsMan);
+        if (changes.light || scene->objectsMan->needUpdateLight)
         {
             graphicsMan->load_light_objects(scene->objectsMan->lightObjects);
             lightNeedUpdate = true;
@@ -892,10 +871,10 @@ struct RenderEngineOptx : RenderEngine, zeno::disable_copy {
             scene->drawOptions->needRefresh = true;
         }
 
-        if (graphicsMan->load_static_objects(scene->objectsMan->pairs())) {
+        if (changes.statics) {
             staticNeedUpdate = true;
         }
-        if (graphicsMan->load_objects(scene->objectsMan->pairs()))
+        if (changes.meshes)
         {
             meshNeedUpdate = matNeedUpdate = true;
             if (scene->drawOptions->updateMatlOnly)
@@ -909,7 +888,8 @@ struct RenderEngineOptx : RenderEngine, zeno::disable_copy {
                 matNeedUpdate = meshNeedUpdate = false;
             }
         }
-        graphicsMan->load_shader_uniforms(scene->objectsMan->pairs());
+        if (changes.statics || changes.meshes)
+            graphicsMan->load_shader_uniforms(scene->objectsMan->pairs());
     }
 
 #define MY_CAM_ID(cam) cam.m_nx, cam.m_ny, cam.m_lodup, cam.m_lodfront, cam.m_lodcenter, cam.m_fov, cam.focalPlaneDistance, cam.m_aperture
@@ -1114,25 +1094,10 @@ struct RenderEngineOptx : RenderEngine, zeno::disable_copy {
 
             //first pass, remove duplicated mat and keep the later
             std::map<std::string, GraphicsManager::DetMaterial*> matMap;
-            std::map<std::string, int> order;
+            // graphics are ordered by key, so the first one of each material wins
             for (auto const &[key, obj]: graphicsMan->graphics){
                 if (auto mtldet = std::get_if<GraphicsManager::DetMaterial>(&obj->det)) {
-                    auto matkey = mtldet->mtlidkey;
-                    if(matMap.find(matkey)!=matMap.end())
-                    {
-                        auto idx = order[matkey];
-                        auto curr_idx = graphicsMan->objOrder[key];
-                        if(curr_idx < idx) {
-                            matMap[matkey] = mtldet;
-                            order[matkey] = curr_idx;
-                        }
-                    }
-                    else
-                    {
-                        matMap.insert({matkey, mtldet});
-                        auto curr_idx = graphicsMan->objOrder[key];
-                        order[matkey] = curr_idx;
-                    }
+                    matMap.try_emplace(mtldet->mtlidkey, mtldet);
                 }
             }
 
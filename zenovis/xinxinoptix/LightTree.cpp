@@ -2,96 +2,277 @@
 #include "Sampling.h"
 #include "optixPathTracer.h"
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_group.h>
+
 #include <algorithm>
+#include <atomic>
 
 namespace pbrt {
+
+namespace {
+
+constexpr int nBuckets = 12;
+
+// nodes bigger than this are binned in parallel, smaller subtrees stay on a single task;
+// either way the result is the one a serial build gets, whatever the scheduling
+constexpr int kParallelBinSize = 1 << 16;
+constexpr int kBinChunkSize = 1 << 14;
+constexpr int kTaskSize = 1 << 12;
+
+// refit gives up once the tree is this much looser than when it was built
+constexpr float kMaxRefitCostGrowth = 1.5f;
+
+struct RangeBounds {
+    Bounds3f bounds, centroidBounds;
+};
+
+struct BucketBounds {
+    LightBounds lb[3][nBuckets];
+};
+
+// only for merges that are exact in any grouping, like the min/max of boxes; the
+// union of direction cones and the float sum of power are not
+template <class T, class Func, class Merge>
+T ChunkedReduce(int start, int end, Func const &func, Merge const &merge) {
+    if (end - start <= kParallelBinSize)
+        return func(start, end);
+    int nChunks = (end - start + kBinChunkSize - 1) / kBinChunkSize;
+    std::vector<T> parts(nChunks);
+    tbb::parallel_for(0, nChunks, [&](int c) {
+        int b = start + c * kBinChunkSize;
+        parts[c] = func(b, std::min(end, b + kBinChunkSize));
+    });
+    for (int c = 1; c < nChunks; ++c)
+        merge(parts[0], parts[c]);
+    return std::move(parts[0]);
+}
+
+// lights are bounded and sampled by type and shape, refit keeps a tree only while these hold
+inline uint16_t LightKind(const GenericLight &light) {
+    return uint16_t(light.type) << 8 | uint16_t(light.shape);
+}
+
+inline int BucketOf(const Bounds3f &centroidBounds, const Vector3f &pc, int dim) {
+    int b = nBuckets * ((pc[dim] - centroidBounds.pMin[dim]) /
+                        (centroidBounds.pMax[dim] - centroidBounds.pMin[dim]));
+    return std::clamp(b, 0, nBuckets - 1);
+}
+
+}
+
 // BVHLightSampler Method Definitions
 LightTreeSampler::LightTreeSampler(std::vector<GenericLight> &lights) {
 
     lightBitTrails.resize(lights.size(), 0u);
-    nodes.reserve(lights.size());
+    lightKinds.resize(lights.size());
+
+    std::vector<LightBounds> allBounds(lights.size());
+    tbb::parallel_for(size_t(0), lights.size(), [&](size_t i) {
+        allBounds[i] = lights[i].bounds();
+        lightKinds[i] = LightKind(lights[i]);
+    });
 
-    std::vector<std::pair<int, LightBounds>> bvhLights{};
-    bvhLights.reserve(lights.size() * 2);
+    std::vector<BuildLight> bvhLights{};
+    bvhLights.reserve(lights.size());
 
     for (size_t i = 0; i < lights.size(); ++i) {
-        
-        auto& light = lights[i];
-        LightBounds lightBounds = light.bounds();
+
+        const LightBounds &lightBounds = allBounds[i];
 
         if (lightBounds.phi > 0) {
-            bvhLights.push_back(std::make_pair(i, lightBounds));
+            bvhLights.push_back({(int)i, lightBounds, lightBounds.centroid()});
             rootBounds = Union(rootBounds, lightBounds.bounds);
         }
     }
-    if (!bvhLights.empty())
-        buildTree(bvhLights, 0, bvhLights.size(), 0, 0);
+    if (bvhLights.empty())
+        return;
+
+    leafCount = bvhLights.size();
+    nodes.resize(2 * bvhLights.size() - 1);
+    auto [lb, cost] = buildTree(bvhLights, 0, bvhLights.size(), 0, 0, 0);
+    float rootMeasure = EvaluateMeasure(lb);
+    relativeCost = rootMeasure > 0 ? cost / rootMeasure : 0;
+}
+
+bool LightTreeSampler::refit(std::vector<GenericLight> &lights) {
+
+    if (nodes.empty() || lights.size() != lightKinds.size())
+        return false;
+    // same count isn't the same lights, a light changing type or shape needs a rebuild
+    for (size_t i = 0; i < lights.size(); ++i) {
+        if (LightKind(lights[i]) != lightKinds[i])
+            return false;
+    }
+
+    std::vector<LightBounds> allBounds(lights.size());
+    tbb::parallel_for(size_t(0), lights.size(), [&](size_t i) {
+        allBounds[i] = lights[i].bounds();
+    });
+
+    // the tree only holds lights with positive power, that set must be unchanged
+    Bounds3f newRootBounds;
+    uint32_t nLit = 0;
+    for (auto const &lb : allBounds) {
+        if (lb.phi > 0) {
+            newRootBounds = Union(newRootBounds, lb.bounds);
+            ++nLit;
+        }
+    }
+    if (nLit != leafCount)
+        return false;
+    for (auto const &node : nodes) {
+        if (node.meta.isLeaf && !(allBounds[node.meta.childOrLightIndex].phi > 0))
+            return false;
+    }
+
+    rootBounds = newRootBounds;
+    auto [lb, cost] = refitTree(allBounds, 0, nodes.size());
+    float rootMeasure = EvaluateMeasure(lb);
+    float newRelativeCost = rootMeasure > 0 ? cost / rootMeasure : 0;
+    return newRelativeCost <= relativeCost * kMaxRefitCostGrowth;
+}
+
+std::pair<LightBounds, float> LightTreeSampler::refitTree(
+            std::vector<LightBounds> const &lightBounds, int nodeIndex, int nodeCount) {
+
+    LightTreeNode &node = nodes[nodeIndex];
+    if (node.meta.isLeaf) {
+        unsigned int lightIndex = node.meta.childOrLightIndex;
+        const LightBounds &lb = lightBounds[lightIndex];
+        node = LightTreeNode::MakeLeaf(lightIndex, CompactLightBounds(lb, rootBounds));
+        return {lb, 0.0f};
+    }
+
+    int child1Index = node.meta.childOrLightIndex;
+    int count0 = child1Index - nodeIndex - 1;
+    int count1 = nodeCount - 1 - count0;
+
+    std::pair<LightBounds, float> child0, child1;
+    if (nodeCount > 2 * kTaskSize) {
+        tbb::task_group tg;
+        tg.run([&] { child0 = refitTree(lightBounds, nodeIndex + 1, count0); });
+        child1 = refitTree(lightBounds, child1Index, count1);
+        tg.wait();
+    } else {
+        child0 = refitTree(lightBounds, nodeIndex + 1, count0);
+        child1 = refitTree(lightBounds, child1Index, count1);
+    }
+
+    LightBounds lb = Union(child0.first, child1.first);
+    node = LightTreeNode::MakeInterior(child1Index, CompactLightBounds(lb, rootBounds));
+    return {lb, child0.second + child1.second + EvaluateMeasure(lb)};
 }
 
-std::pair<int, LightBounds> LightTreeSampler::buildTree(
-            std::vector<std::pair<int, LightBounds>> &bvhLights, 
-            int start, int end, uint32_t bitTrail, int depth) {
-        
+std::pair<LightBounds, float> LightTreeSampler::buildTree(
+            std::vector<BuildLight> &bvhLights,
+            int start, int end, int nodeIndex, uint32_t bitTrail, int depth) {
+
     DCHECK(start < end);
     // Initialize leaf node if only a single light remains
     if (end - start == 1) {
-        int nodeIndex = nodes.size();
-        CompactLightBounds cb(bvhLights[start].second, rootBounds);
-        int lightIndex = bvhLights[start].first;
-        nodes.push_back(LightTreeNode::MakeLeaf(lightIndex, cb));
+        const BuildLight &light = bvhLights[start];
+        CompactLightBounds cb(light.lb, rootBounds);
+        nodes[nodeIndex] = LightTreeNode::MakeLeaf(light.index, cb);
 
-        lightBitTrails.at(lightIndex) = bitTrail;
-        return {nodeIndex, bvhLights[start].second};
+        lightBitTrails[light.index] = bitTrail;
+        return {light.lb, 0.0f};
     }
 
     // Choose split dimension and position using modified SAH
     // Compute bounds and centroid bounds for lights
-    Bounds3f bounds, centroidBounds;
-    for (int i = start; i < end; ++i) {
-        const LightBounds &lb = bvhLights[i].second;
-        bounds = Union(bounds, lb.bounds);
-        centroidBounds = Union(centroidBounds, lb.centroid());
-    }
+    RangeBounds range = ChunkedReduce<RangeBounds>(start, end,
+        [&](int b, int e) {
+            RangeBounds r;
+            for (int i = b; i < e; ++i) {
+                r.bounds = Union(r.bounds, bvhLights[i].lb.bounds);
+                r.centroidBounds = Union(r.centroidBounds, bvhLights[i].centroid);
+            }
+            return r;
+        },
+        [](RangeBounds &a, RangeBounds const &b) {
+            a.bounds = Union(a.bounds, b.bounds);
+            a.centroidBounds = Union(a.centroidBounds, b.centroidBounds);
+        });
+    const Bounds3f &bounds = range.bounds;
+    const Bounds3f &centroidBounds = range.centroidBounds;
+
+    bool splittable[3];
+    for (int dim = 0; dim < 3; ++dim)
+        splittable[dim] = centroidBounds.pMax[dim] != centroidBounds.pMin[dim];
 
     float minCost = INFINITY;
     int minCostSplitBucket = -1, minCostSplitDim = -1;
-    constexpr int nBuckets = 12;
-    for (int dim = 0; dim < 3; ++dim) {
-        // Compute minimum cost bucket for splitting along dimension _dim_
-        if (centroidBounds.pMax[dim] == centroidBounds.pMin[dim])
-            continue;
-        // Compute _LightBounds_ for each bucket
-        LightBounds bucketLightBounds[nBuckets];
-        for (int i = start; i < end; ++i) {
-            Vector3f pc = bvhLights[i].second.centroid();
-            int b = nBuckets * centroidBounds.offset(pc)[dim];
-            if (b == nBuckets)
-                b = nBuckets - 1;
-            DCHECK(b >= 0);
-            DCHECK(b < nBuckets);
-            bucketLightBounds[b] = Union(bucketLightBounds[b], bvhLights[i].second);
-        }
 
-        // Compute costs for splitting lights after each bucket
-        float cost[nBuckets - 1]{};
-        for (int i = 0; i < (nBuckets - 1); ++i) {
-            // Find _LightBounds_ for lights below and above bucket split
-            LightBounds b0, b1;
-            for (int j = 0; j <= i; ++j)
-                b0 = Union(b0, bucketLightBounds[j]);
-            for (int j = (i + 1); j < nBuckets; ++j)
-                b1 = Union(b1, bucketLightBounds[j]);
-
-            // Compute final light split cost for bucket
-            cost[i] = EvaluateCost(b0, bounds, dim) + EvaluateCost(b1, bounds, dim);
+    if (splittable[0] || splittable[1] || splittable[2]) {
+        // Compute _LightBounds_ for each bucket of all dimensions; the union of direction
+        // cones isn't associative, so each bucket is folded over its lights in order, as a
+        // serial build would, and large nodes only run the buckets in parallel
+        BucketBounds buckets;
+        if (end - start <= kParallelBinSize) {
+            for (int i = start; i < end; ++i) {
+                const BuildLight &light = bvhLights[i];
+                for (int dim = 0; dim < 3; ++dim) {
+                    if (!splittable[dim])
+                        continue;
+                    int k = BucketOf(centroidBounds, light.centroid, dim);
+                    buckets.lb[dim][k] = Union(buckets.lb[dim][k], light.lb);
+                }
+            }
+        } else {
+            std::vector<uint8_t> bucketIndex[3];
+            for (int dim = 0; dim < 3; ++dim) {
+                if (splittable[dim])
+                    bucketIndex[dim].resize(end - start);
+            }
+            tbb::parallel_for(tbb::blocked_range<int>(start, end, kBinChunkSize),
+                [&](tbb::blocked_range<int> const &r) {
+                    for (int i = r.begin(); i < r.end(); ++i) {
+                        for (int dim = 0; dim < 3; ++dim) {
+                            if (splittable[dim])
+                                bucketIndex[dim][i - start] = BucketOf(centroidBounds, bvhLights[i].centroid, dim);
+                        }
+                    }
+                });
+            tbb::parallel_for(0, 3 * nBuckets, [&](int t) {
+                int dim = t / nBuckets, k = t % nBuckets;
+                if (!splittable[dim])
+                    return;
+                LightBounds lb;
+                for (int i = start; i < end; ++i) {
+                    if (bucketIndex[dim][i - start] == k)
+                        lb = Union(lb, bvhLights[i].lb);
+                }
+                buckets.lb[dim][k] = lb;
+            });
         }
 
-        // Find light split that minimizes SAH metric
-        for (int i = 1; i < (nBuckets - 1); ++i) {
-            if (cost[i] > 0 && cost[i] < minCost) {
-                minCost = cost[i];
-                minCostSplitBucket = i;
-                minCostSplitDim = dim;
+        for (int dim = 0; dim < 3; ++dim) {
+            if (!splittable[dim])
+                continue;
+            const LightBounds *bucketLightBounds = buckets.lb[dim];
+
+            // Sweep the prefix unions once instead of per candidate split; the union of
+            // direction cones isn't associative, so the suffixes are still folded front
+            // to back, as a serial build would, to keep the same tree
+            LightBounds below[nBuckets], above[nBuckets];
+            below[0] = bucketLightBounds[0];
+            for (int i = 1; i < nBuckets; ++i)
+                below[i] = Union(below[i - 1], bucketLightBounds[i]);
+            for (int i = 2; i < nBuckets; ++i) {
+                for (int j = i; j < nBuckets; ++j)
+                    above[i] = Union(above[i], bucketLightBounds[j]);
+            }
+
+            // Find light split that minimizes SAH metric
+            for (int i = 1; i < (nBuckets - 1); ++i) {
+                float cost = EvaluateCost(below[i], bounds, dim) + EvaluateCost(above[i + 1], bounds, dim);
+                if (cost > 0 && cost < minCost) {
+                    minCost = cost;
+                    minCostSplitBucket = i;
+                    minCostSplitDim = dim;
+                }
             }
         }
     }
@@ -103,14 +284,8 @@ std::pair<int, LightBounds> LightTreeSampler::buildTree(
     else {
         const auto *pmid = std::partition(
             &bvhLights[start], &bvhLights[end - 1] + 1,
-            [=](const std::pair<int, LightBounds> &l) {
-                int b = nBuckets *
-                        centroidBounds.offset(l.second.centroid())[minCostSplitDim];
-                if (b == nBuckets)
-                    b = nBuckets - 1;
-                DCHECK(b >= 0);
-                DCHECK(b < nBuckets);
-                return b <= minCostSplitBucket;
+            [=](const BuildLight &l) {
+                return BucketOf(centroidBounds, l.centroid, minCostSplitDim) <= minCostSplitBucket;
             });
         mid = pmid - &bvhLights[0];
         if (mid == start || mid == end)
@@ -118,21 +293,25 @@ std::pair<int, LightBounds> LightTreeSampler::buildTree(
         DCHECK(mid > start && mid < end);
     }
 
-    // Allocate interior _LightBVHNode_ and recursively initialize children
-    int nodeIndex = nodes.size();
-    nodes.push_back(LightTreeNode());
+    // Children take the slots right after this node and after the 2k-1 nodes of the first child
     DCHECK(depth < 64);
-    std::pair<int, LightBounds> child0 =
-        buildTree(bvhLights, start, mid, bitTrail, depth + 1);
-    DCHECK(nodeIndex + 1 == child0.first);
-    std::pair<int, LightBounds> child1 =
-        buildTree(bvhLights, mid, end, bitTrail | (1u << depth), depth + 1);
-
-    // Initialize interior node and return node index and bounds
-    LightBounds lb = Union(child0.second, child1.second);
+    int child1Index = nodeIndex + 2 * (mid - start);
+    std::pair<LightBounds, float> child0, child1;
+    if (end - start > kTaskSize) {
+        tbb::task_group tg;
+        tg.run([&] { child0 = buildTree(bvhLights, start, mid, nodeIndex + 1, bitTrail, depth + 1); });
+        child1 = buildTree(bvhLights, mid, end, child1Index, bitTrail | (1u << depth), depth + 1);
+        tg.wait();
+    } else {
+        child0 = buildTree(bvhLights, start, mid, nodeIndex + 1, bitTrail, depth + 1);
+        child1 = buildTree(bvhLights, mid, end, child1Index, bitTrail | (1u << depth), depth + 1);
+    }
+
+    // Initialize interior node and return its bounds
+    LightBounds lb = Union(child0.first, child1.first);
     CompactLightBounds cb(lb, rootBounds);
-    nodes[nodeIndex] = LightTreeNode::MakeInterior(child1.first, cb);
-    return {nodeIndex, lb};
+    nodes[nodeIndex] = LightTreeNode::MakeInterior(child1Index, cb);
+    return {lb, child0.second + child1.second + EvaluateMeasure(lb)};
 }
 
-}
\ No newline at end of file
+}
@@ -228,6 +228,11 @@ struct LightTreeSampler {
 
     LightTreeSampler(std::vector<GenericLight> &lights);
 
+    // refit the bounds of the existing tree after lights moved or changed intensity,
+    // returns false if the count, type or shape of the lights changed or the refitted
+    // tree got too loose, the sampler must be rebuilt then
+    bool refit(std::vector<GenericLight> &lights);
+
     inline void upload(CUdeviceptr &lightBitTrailsPtr, CUdeviceptr &lightTreeNodesPtr) 
     {
         {
@@ -345,11 +350,21 @@ struct LightTreeSampler {
 
 #ifndef __CUDACC_RTC__
 
-    std::pair<int, LightBounds> buildTree(std::vector<std::pair<int, LightBounds>> &bvhLights,
-                                          int start, int end, uint32_t bitTrail, int depth);
+    struct BuildLight {
+        int index;
+        LightBounds lb;
+        Vector3f centroid;
+    };
+
+    // a subtree over n lights always takes 2n-1 nodes, so both children know their
+    // slots up front and can be built concurrently; returns bounds and summed cost
+    std::pair<LightBounds, float> buildTree(std::vector<BuildLight> &lights, int start, int end,
+                                            int nodeIndex, uint32_t bitTrail, int depth);
+    std::pair<LightBounds, float> refitTree(std::vector<LightBounds> const &lightBounds,
+                                            int nodeIndex, int nodeCount);
 #endif
 
-    float EvaluateCost(const LightBounds &b, const Bounds3f &bounds, int dim) const {
+    float EvaluateMeasure(const LightBounds &b) const {
         // Evaluate direction bounds measure for _LightBounds_
         float theta_o = acosf(b.cosTheta_o);
         float theta_e = acosf(b.cosTheta_e);
@@ -360,15 +375,21 @@ struct LightTreeSampler {
                             (2 * theta_w * sinTheta_o - cosf(theta_o - 2 * theta_w) -
                              2 * theta_o * sinTheta_o + b.cosTheta_o);
 
-        float Kr = MaxComponentValue(bounds.diagonal()) / bounds.diagonal()[dim];
+        return b.phi * M_omega * b.bounds.area();
+    }
 
-        return b.phi * M_omega * Kr * b.bounds.area();
+    float EvaluateCost(const LightBounds &b, const Bounds3f &bounds, int dim) const {
+        float Kr = MaxComponentValue(bounds.diagonal()) / bounds.diagonal()[dim];
+        return EvaluateMeasure(b) * Kr;
     }
 
 // BVHLightSampler Private Members
 #ifndef __CUDACC_RTC__    
     std::vector<uint32_t> lightBitTrails{};
     std::vector<LightTreeNode>     nodes{};
+    std::vector<uint16_t> lightKinds{};  // type and shape of each light at build time, checked by refit
+    uint32_t leafCount = 0;
+    float relativeCost = 0;  // summed interior measure over the root measure, guards refit
 #else 
     uint32_t *lightBitTrails;
     LightTreeNode     *nodes; 
@@ -0,0 +1,103 @@
+// CPU-only timing of the light tree build and refit, no CUDA device is touched,
+// usage: zeno_lighttree_bench [triangle count] [repeat]
+#include "LightTree.h"
+#include "optixPathTracer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+static std::vector<GenericLight> makeTriangleLights(size_t count, unsigned seed) {
+    std::vector<GenericLight> lights(count);
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> pos(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> jitter(-0.5f, 0.5f);
+
+    for (auto &light : lights) {
+        light.type = zeno::LightType::Diffuse;
+        light.shape = zeno::LightShape::TriangleMesh;
+        light.color = make_float3(1.0f);
+        light.intensity = 1.0f;
+
+        auto &tri = light.triangle;
+        float3 c = make_float3(pos(rng), pos(rng), pos(rng));
+        tri.p0 = c + make_float3(jitter(rng), jitter(rng), jitter(rng));
+        tri.p1 = c + make_float3(jitter(rng), jitter(rng), jitter(rng));
+        tri.p2 = c + make_float3(jitter(rng), jitter(rng), jitter(rng));
+        tri.faceNormal = normalize(cross(tri.p1 - tri.p0, tri.p2 - tri.p0));
+        tri.area = tri.Area();
+    }
+    return lights;
+}
+
+template <class Func>
+static double timeMs(Func &&func) {
+    auto t0 = std::chrono::steady_clock::now();
+    func();
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(t1 - t0).count();
+}
+
+int main(int argc, char **argv) {
+    size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+    int repeat = argc > 2 ? std::atoi(argv[2]) : 5;
+
+    auto lights = makeTriangleLights(count, 42);
+    printf("lights: %zu, repeat: %d\n", count, repeat);
+
+    double buildMs = 0;
+    for (int r = 0; r < repeat; r++) {
+        buildMs += timeMs([&] { pbrt::LightTreeSampler sampler(lights); });
+    }
+    printf("build: %.3f ms\n", buildMs / repeat);
+
+    pbrt::LightTreeSampler sampler(lights);
+    double refitMs = 0;
+    int refitted = 0;
+    for (int r = 0; r < repeat; r++) {
+        // small animation step: drift every triangle and pulse the intensity
+        float3 offset = make_float3(0.01f * (r + 1), 0.0f, -0.01f * (r + 1));
+        for (auto &light : lights) {
+            light.triangle.p0 += offset;
+            light.triangle.p1 += offset;
+            light.triangle.p2 += offset;
+            light.intensity = 1.0f + 0.1f * r;
+        }
+        refitMs += timeMs([&] { refitted += sampler.refit(lights); });
+    }
+    printf("refit: %.3f ms (%d/%d accepted)\n", refitMs / repeat, refitted, repeat);
+
+    // sanity: the refitted sampler must still hand out lights, with the same pmf
+    // as walking down to them through their bit trails
+    int picked = 0;
+    float maxError = 0;
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> u01(0.0f, 1.0f);
+    std::uniform_real_distribution<float> pos(-120.0f, 120.0f);
+    for (int i = 0; i < 1000; i++) {
+        Vector3f p(pos(rng), pos(rng), pos(rng));
+        auto sel = sampler.sample(u01(rng), p, Vector3f(0.0f, 0.0f, 0.0f));
+        if (sel.prob > 0) {
+            picked++;
+            float pmf = sampler.PMF(p, Vector3f(0.0f, 0.0f, 0.0f), sel.lightIdx);
+            maxError = std::max(maxError, std::abs(pmf - sel.prob) / sel.prob);
+        }
+    }
+    printf("samples with nonzero pmf: %d/1000, max pmf mismatch: %g\n", picked, maxError);
+
+    // a light changing shape at the same count must not be refitted
+    bool rejected = true;
+    if (!lights.empty()) {
+        lights[0].shape = zeno::LightShape::Sphere;
+        lights[0].sphere.center = make_float3(0.0f);
+        lights[0].sphere.radius = 1.0f;
+        lights[0].sphere.area = 4.0f * M_PIf;
+        rejected = !sampler.refit(lights);
+    }
+    printf("refit after a shape change: %s\n", rejected ? "rejected" : "ACCEPTED");
+    return maxError > 1e-4f || !rejected ? 1 : 0;
+}
@@ -502,6 +502,10 @@ struct LightsWrapper {
 
 } lightsWrapper;
 
+// outlives lightsWrapper.reset(), so edits that only move lights or change their
+// intensity can refit the existing tree instead of building a new one
+static std::unique_ptr<pbrt::LightTreeSampler> g_lightTree;
+
 std::map<std::string, int> g_mtlidlut; // MAT_COUNT
 
 struct InstData
@@ -1558,6 +1562,7 @@ static void cleanupState( PathTracerState& state )
 
     cleanupSpheresGPU();
     lightsWrapper.reset();
+    g_lightTree.reset();
     
     for (auto& ele : list_volume) {
         cleanupVolume(*ele);
@@ -2555,7 +2560,9 @@ void buildLightTree() {
                 cudaMemcpyHostToDevice
                 ) );
 
-    auto lsampler = pbrt::LightTreeSampler(lightsWrapper.g_lights);
+    if (!g_lightTree || !g_lightTree->refit(lightsWrapper.g_lights))
+        g_lightTree = std::make_unique<pbrt::LightTreeSampler>(lightsWrapper.g_lights);
+    auto &lsampler = *g_lightTree;
 
     raii<CUdeviceptr>& lightBitTrailsPtr = lightsWrapper.lightBitTrailsPtr;
     raii<CUdeviceptr>& lightTreeNodesPtr = lightsWrapper.lightTreeNodesPtr;